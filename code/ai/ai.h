@@ -553,6 +553,10 @@ void ai_object_init(object * obj, int ai_index);
 // Called once a frame
 void ai_process( object * obj, int ai_index, float frametime );
 
+// builds the turret target lists of all ships on the worker threads, used with -ai_threads
+void ai_turret_prefetch_targets(float frametime);
+void ai_turret_prefetch_clear();
+
 int get_wingnum(int objnum);
 
 void set_wingnum(int objnum, int wingnum);
@@ -53,6 +53,7 @@
 #include "object/object.h"
 #include "object/objectdock.h"
 #include "object/objectshield.h"
+#include "object/objectspatial.h"
 #include "object/waypoint.h"
 #include "parse/parselo.h"
 #include "physics/physics.h"
@@ -2041,7 +2042,7 @@ int get_nearest_objnum(int objnum, int enemy_team_mask, int enemy_wing, float ra
 {
 	object	*danger_weapon_objp;
 	ai_info	*aip;
-	ship_obj	*so;
+	SCP_vector<int> candidates;
 
 	// initialize eno struct
 	eval_nearest_objnum eno;
@@ -2055,9 +2056,12 @@ int get_nearest_objnum(int objnum, int enemy_team_mask, int enemy_wing, float ra
 	eno.nearest_objnum = -1;
 	eno.check_danger_weapon_objnum = 0;
 
-	// go through the list of all ships and evaluate as potential targets
-	for ( so = GET_FIRST(&Ship_obj_list); so != END_OF_LIST(&Ship_obj_list); so = GET_NEXT(so) ) {
-		eno.trial_objp = &Objects[so->objnum];
+	// go through all ships which could be in range and evaluate them as potential targets
+	// fighters and bombers are picked at up to twice the range, see evaluate_object_as_nearest_objnum()
+	obj_spatial_query_ships(&Objects[objnum].pos, range * 2.0f, enemy_team_mask, candidates);
+
+	for (auto candidate : candidates) {
+		eno.trial_objp = &Objects[candidate];
 		evaluate_object_as_nearest_objnum(&eno);
 	}
 
@@ -2106,15 +2110,17 @@ int find_nearby_threat(int objnum, int enemy_team_mask, float range, int *count)
 	int		nearest_objnum;
 	float		nearest_dist;
 	object	*objp;
-	ship_obj	*so;
+	SCP_vector<int> candidates;
 
 	nearest_objnum = -1;
 	nearest_dist = range;
 
 	*count = 0;
 
-	for ( so = GET_FIRST(&Ship_obj_list); so != END_OF_LIST(&Ship_obj_list); so = GET_NEXT(so) ) {
-		objp = &Objects[so->objnum];
+	obj_spatial_query_ships(&Objects[objnum].pos, range, enemy_team_mask, candidates);
+
+	for (auto candidate : candidates) {
+		objp = &Objects[candidate];
 
 		if ( OBJ_INDEX(objp) != objnum ) {
 			if (Ships[objp->instance].flags[Ship::Ship_Flags::Dying])
@@ -4127,11 +4133,13 @@ void update_min_max(float val, float *min, float *max)
 int get_enemy_team_range(object *my_objp, float range, int enemy_team_mask, vec3d *min_vec, vec3d *max_vec)
 {
 	object	*objp;
-	ship_obj	*so;
+	SCP_vector<int> candidates;
 	int		count = 0;
 
-    for (so = GET_FIRST(&Ship_obj_list); so != END_OF_LIST(&Ship_obj_list); so = GET_NEXT(so)) {
-        objp = &Objects[so->objnum];
+	obj_spatial_query_ships(&my_objp->pos, range, enemy_team_mask, candidates);
+
+    for (auto candidate : candidates) {
+        objp = &Objects[candidate];
         if (iff_matches_mask(Ships[objp->instance].team, enemy_team_mask)) {
             ship_info* sip = &Ship_info[Ships[objp->instance].ship_info_index];
             if (sip->is_fighter_bomber() || sip->flags[Ship::Info_Flags::Cruiser] || sip->flags[Ship::Info_Flags::Capital] || sip->flags[Ship::Info_Flags::Supercap] || sip->flags[Ship::Info_Flags::Drydock] || sip->flags[Ship::Info_Flags::Corvette] || sip->flags[Ship::Info_Flags::Awacs] || sip->flags[Ship::Info_Flags::Gas_miner])
@@ -5775,13 +5783,15 @@ int ai_fire_primary_weapon(object *objp)
 // exit:		number of ships within threshold units of pos
 int num_nearby_fighters(int enemy_team_mask, vec3d *pos, float threshold)
 {
-	ship_obj	*so;
+	SCP_vector<int> candidates;
 	object	*ship_objp;
 	int		count = 0;
 
-	for ( so = GET_FIRST(&Ship_obj_list); so != END_OF_LIST(&Ship_obj_list); so = GET_NEXT(so) ) {
+	obj_spatial_query_ships(pos, threshold, enemy_team_mask, candidates);
 
-		ship_objp = &Objects[so->objnum];
+	for (auto candidate : candidates) {
+
+		ship_objp = &Objects[candidate];
 
 		if (iff_matches_mask(Ships[ship_objp->instance].team, enemy_team_mask)) {
 			if (Ship_info[Ships[ship_objp->instance].ship_info_index].is_fighter_bomber()) {
@@ -9690,13 +9700,16 @@ void ai_guard_find_nearby_ship(object *guarding_objp, object *guarded_objp)
 {
 	ship *guarding_shipp = &Ships[guarding_objp->instance];
 	ai_info	*guarding_aip = &Ai_info[guarding_shipp->ai_index];
-	ship_obj *so;
+	SCP_vector<int> candidates;
 	object *enemy_objp;
 	float dist;
 
-	for (so = GET_FIRST(&Ship_obj_list); so != END_OF_LIST(&Ship_obj_list); so = GET_NEXT(so))
+	float max_dist = MAX((MAX_GUARD_DIST + guarded_objp->radius)*3, 3000.0f);
+	obj_spatial_query_ships(&guarded_objp->pos, max_dist, iff_get_attackee_mask(guarding_shipp->team), candidates);
+
+	for (auto candidate : candidates)
 	{
-		enemy_objp = &Objects[so->objnum];
+		enemy_objp = &Objects[candidate];
 
 		if (enemy_objp->instance < 0)
 		{
@@ -11157,6 +11170,9 @@ void process_subobjects(int objnum)
 	//Look for enemies. If none are present, we don't have to move turrets
 	int enemies_present = -1;
 
+	// objects may have moved since the turrets of this ship last looked for targets
+	turret_candidates_reset();
+
 	model_subsystem	*psub;
 	for ( pss = GET_FIRST(&shipp->subsys_list); pss !=END_OF_LIST(&shipp->subsys_list); pss = GET_NEXT(pss) ) {
 		psub = pss->system_info;
@@ -31,4 +31,7 @@ int check_ok_to_fire(int objnum, int target_objnum, weapon_info *wip);
 //Does all the stuff needed to aim and fire a turret.
 void ai_fire_from_turret(ship *shipp, ship_subsys *ss, int parent_objnum);
 
+//Drops the targets cached for the turrets of the last ship, call before processing the turrets of a ship.
+void turret_candidates_reset();
+
 #endif
@@ -18,6 +18,8 @@
 #include "render/3d.h"
 #include "ship/ship.h"
 #include "ship/shipfx.h"
+#include "tracing/tracing.h"
+#include "utils/threading.h"
 #include "weapon/beam.h"
 #include "weapon/flak.h"
 #include "weapon/muzzleflash.h"
@@ -526,9 +528,7 @@ void evaluate_obj_as_target(object *objp, eval_enemy_obj_struct *eeo)
 		return;
 	}
 
-	if ( !valid_turret_enemy(objp, turret_parent_obj) ) {
-		return;
-	}
+	// valid_turret_enemy() was already checked when the object was added to the turret candidates
 
 #ifndef NDEBUG
 	if (!Player_attacking_enabled && (objp == Player_obj)) {
@@ -798,6 +798,424 @@ int is_target_beam_valid(ship_weapon *swp, object *objp)
 	return 1;
 }
 
+// vm_vec_mag_quick() can underestimate a distance by almost 10%, range checks against the exact distance are widened
+// by this much so they never reject anything evaluate_obj_as_target() would accept
+#define TURRET_QUICK_DIST_SCALE	(1.125f)
+
+/**
+ * Objects the turrets of one ship may pick as targets
+ *
+ * Everything evaluate_obj_as_target() checks which does not depend on the turret itself is done once when the list is
+ * built, the turrets of the ship only score the remaining objects. Positions and radii are kept in separate arrays so
+ * the per-turret range check is a plain loop over floats.
+ */
+typedef struct turret_candidate_list {
+	SCP_vector<int>		objnums;
+	SCP_vector<float>	pos_x;
+	SCP_vector<float>	pos_y;
+	SCP_vector<float>	pos_z;
+	SCP_vector<float>	radius;
+	SCP_vector<int>		skip_flags;			// EEOF_* flags of turrets which have to ignore the object
+	SCP_vector<ubyte>	range_limited;		// object is only a target within the weapon range of the turret
+
+	void clear()
+	{
+		objnums.clear();
+		pos_x.clear();
+		pos_y.clear();
+		pos_z.clear();
+		radius.clear();
+		skip_flags.clear();
+		range_limited.clear();
+	}
+
+	void add(object *objp, int flags, bool limited)
+	{
+		objnums.push_back(OBJ_INDEX(objp));
+		pos_x.push_back(objp->pos.xyz.x);
+		pos_y.push_back(objp->pos.xyz.y);
+		pos_z.push_back(objp->pos.xyz.z);
+		radius.push_back(objp->radius);
+		skip_flags.push_back(flags);
+		range_limited.push_back(limited ? 1 : 0);
+	}
+} turret_candidate_list;
+
+typedef struct turret_candidates {
+	int		parent_objnum = -1;
+	int		parent_signature = 0;
+
+	turret_candidate_list	all;			// obj_used_list order, for turrets with target priorities
+	turret_candidate_list	ships;			// Ship_obj_list order
+	turret_candidate_list	bombs;			// Missile_obj_list order
+	turret_candidate_list	asteroids;		// Asteroid_obj_list order
+} turret_candidates;
+
+static turret_candidates Turret_candidates;
+
+// the candidates of the ship whose turrets are being processed, NULL after turret_candidates_reset()
+static turret_candidates *Turret_candidates_current = NULL;
+
+// objects of obj_used_list the turrets of a ship might pick, gathered on the worker threads at the start of the frame
+// with -ai_threads, see ai_turret_prefetch_targets()
+typedef struct turret_prefetched_candidates {
+	int		parent_signature = 0;
+	SCP_vector<int>		objnums;
+	SCP_vector<int>		signatures;
+} turret_prefetched_candidates;
+
+static SCP_vector<turret_prefetched_candidates> Turret_candidates_prefetched;
+static SCP_vector<int> Turret_prefetched_index;		// by objnum, -1 if there are no prefetched candidates
+
+// scratch space for turret_candidates_in_range()
+static SCP_vector<float> Turret_candidate_dist_sq;
+static SCP_vector<int> Turret_candidate_indices;
+
+/**
+ * Decides whether an object belongs in the candidate list of a turret parent
+ *
+ * @param objp				Object to test
+ * @param turret_parent		Object of the ship the turrets sit on
+ * @param weapon_system_ok	Whether the weapons subsystem of the parent is working
+ * @param max_dist			Objects of which the exact distance to the parent center is beyond this plus their radius can be skipped
+ * @param[out] flags		EEOF_* flags of the turrets which have to ignore the object
+ * @param[out] limited		Whether the object is only a target within the weapon range of a turret
+ *
+ * @return true if a turret of the parent might pick the object
+ */
+static bool turret_candidate_filter(object *objp, object *turret_parent, bool weapon_system_ok, float max_dist, int *flags, bool *limited)
+{
+	*flags = 0;
+	*limited = false;
+
+	// Don't look for bombs when weapon system is not ok
+	if (objp->type == OBJ_WEAPON && !weapon_system_ok) {
+		return false;
+	}
+
+	if ( !valid_turret_enemy(objp, turret_parent) ) {
+		return false;
+	}
+
+	if (objp->type == OBJ_SHIP) {
+		if (Ship_info[Ships[objp->instance].ship_info_index].is_big_or_huge()) {
+			*flags |= EEOF_SMALL_ONLY;
+		} else {
+			*flags |= EEOF_BIG_ONLY;
+		}
+
+		if (objp->flags[Object::Object_Flags::Beam_protected])
+			*flags |= EEOF_BEAM;
+		if (objp->flags[Object::Object_Flags::Flak_protected])
+			*flags |= EEOF_FLAK;
+		if (objp->flags[Object::Object_Flags::Laser_protected])
+			*flags |= EEOF_LASER;
+		if (objp->flags[Object::Object_Flags::Missile_protected])
+			*flags |= EEOF_MISSILE;
+
+		// stealth ships may draw a random number before the range check, keep them so the random sequence stays the same
+		*limited = !is_object_stealth_ship(objp);
+	} else if (objp->type == OBJ_WEAPON) {
+		*limited = Ai_info[Ships[turret_parent->instance].ai_index].ai_profile_flags[AI::Profile_Flags::Prevent_targeting_bombs_beyond_range];
+	} else if (objp->type == OBJ_ASTEROID) {
+		// only asteroids about to hit the parent are targets
+		return asteroid_collide_objnum(objp) == OBJ_INDEX(turret_parent);
+	}
+
+	if (*limited && vm_vec_dist(&objp->pos, &turret_parent->pos) >= max_dist + objp->radius * TURRET_QUICK_DIST_SCALE) {
+		return false;
+	}
+
+	return true;
+}
+
+/**
+ * Decides whether an object might pass turret_candidate_filter() at any point of the frame
+ *
+ * Only the checks which can't change during the frame are done, everything else is left for turret_candidate_filter()
+ * when the candidates are used.
+ *
+ * @param objp				Object to test
+ * @param turret_parent		Object of the ship the turrets sit on
+ * @param max_dist			Like for turret_candidate_filter(), widened by how far the objects can move in the frame
+ *
+ * @return false if no turret of the parent can pick the object this frame
+ */
+static bool turret_candidate_prefilter(object *objp, object *turret_parent, float max_dist)
+{
+	if ( (objp == turret_parent) || ((objp->type != OBJ_SHIP) && (objp->type != OBJ_WEAPON) && (objp->type != OBJ_ASTEROID)) ) {
+		return false;
+	}
+
+	if (objp->type == OBJ_WEAPON) {
+		weapon_info *wip = &Weapon_info[Weapons[objp->instance].weapon_info_index];
+		ai_info *aip = &Ai_info[Ships[turret_parent->instance].ai_index];
+
+		// the weapon class part of valid_turret_enemy()
+		if (wip->subtype == WP_LASER && !(wip->wi_flags[Weapon::Info_Flags::Turret_Interceptable])) {
+			return false;
+		}
+		if ( !((wip->wi_flags[Weapon::Info_Flags::Bomb]) || (wip->wi_flags[Weapon::Info_Flags::Turret_Interceptable])) && !(aip->ai_profile_flags[AI::Profile_Flags::Allow_turrets_target_weapons_freely]) ) {
+			return false;
+		}
+
+		if (aip->ai_profile_flags[AI::Profile_Flags::Prevent_targeting_bombs_beyond_range]
+			&& vm_vec_dist(&objp->pos, &turret_parent->pos) >= max_dist + objp->radius * TURRET_QUICK_DIST_SCALE) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * The distance from the center of a ship beyond which none of its turrets reaches
+ */
+static float turret_candidates_max_dist(object *turret_parent)
+{
+	ship *shipp = &Ships[turret_parent->instance];
+
+	float max_range = 0.0f;
+	for (ship_subsys *pss = GET_FIRST(&shipp->subsys_list); pss != END_OF_LIST(&shipp->subsys_list); pss = GET_NEXT(pss)) {
+		if (pss->system_info->type == SUBSYSTEM_TURRET) {
+			max_range = MAX(max_range, longest_turret_weapon_range(&pss->weapons));
+		}
+	}
+
+	// the turrets sit on the hull, allow twice the radius so firing points on long barrels are covered as well
+	return max_range * TURRET_QUICK_DIST_SCALE + turret_parent->radius * 2.0f;
+}
+
+/**
+ * Builds the candidate lists for the turrets of a ship
+ *
+ * @param tc					Lists to fill
+ * @param turret_parent_objnum	Ship the turrets sit on
+ * @param prefetched			Objects of obj_used_list to check instead of walking all of it, may be NULL
+ */
+static void turret_candidates_build(turret_candidates *tc, int turret_parent_objnum, const turret_prefetched_candidates *prefetched)
+{
+	object *turret_parent = &Objects[turret_parent_objnum];
+	ship *shipp = &Ships[turret_parent->instance];
+	int flags;
+	bool limited;
+
+	tc->parent_objnum = turret_parent_objnum;
+	tc->parent_signature = turret_parent->signature;
+
+	tc->all.clear();
+	tc->ships.clear();
+	tc->bombs.clear();
+	tc->asteroids.clear();
+
+	bool weapon_system_ok = ship_get_subsystem_strength(shipp, SUBSYSTEM_WEAPONS) > 0;
+	float max_dist = turret_candidates_max_dist(turret_parent);
+
+	if (prefetched != NULL) {
+		// the same objects in the same order as the list walk below, minus the ones which can't pass the filter
+		for (size_t i = 0; i < prefetched->objnums.size(); i++) {
+			object *objp = &Objects[prefetched->objnums[i]];
+
+			if (objp->signature != prefetched->signatures[i]) {
+				continue;
+			}
+
+			if (turret_candidate_filter(objp, turret_parent, weapon_system_ok, max_dist, &flags, &limited)) {
+				tc->all.add(objp, flags, limited);
+			}
+		}
+	} else {
+		for (object *objp = GET_FIRST(&obj_used_list); objp != END_OF_LIST(&obj_used_list); objp = GET_NEXT(objp)) {
+			if (turret_candidate_filter(objp, turret_parent, weapon_system_ok, max_dist, &flags, &limited)) {
+				tc->all.add(objp, flags, limited);
+			}
+		}
+	}
+
+	for (ship_obj *so = GET_FIRST(&Ship_obj_list); so != END_OF_LIST(&Ship_obj_list); so = GET_NEXT(so)) {
+		object *objp = &Objects[so->objnum];
+		if (turret_candidate_filter(objp, turret_parent, weapon_system_ok, max_dist, &flags, &limited)) {
+			tc->ships.add(objp, flags, limited);
+		}
+	}
+
+	for (missile_obj *mo = GET_FIRST(&Missile_obj_list); mo != END_OF_LIST(&Missile_obj_list); mo = GET_NEXT(mo)) {
+		object *objp = &Objects[mo->objnum];
+		Assert(objp->type == OBJ_WEAPON);
+
+		weapon_info *wip = &Weapon_info[Weapons[objp->instance].weapon_info_index];
+		if (!(wip->wi_flags[Weapon::Info_Flags::Bomb]) && !(wip->wi_flags[Weapon::Info_Flags::Turret_Interceptable])) {
+			continue;
+		}
+
+		if (turret_candidate_filter(objp, turret_parent, weapon_system_ok, max_dist, &flags, &limited)) {
+			tc->bombs.add(objp, flags, limited);
+		}
+	}
+
+	for (asteroid_obj *ao = GET_FIRST(&Asteroid_obj_list); ao != END_OF_LIST(&Asteroid_obj_list); ao = GET_NEXT(ao)) {
+		object *objp = &Objects[ao->objnum];
+		if (turret_candidate_filter(objp, turret_parent, weapon_system_ok, max_dist, &flags, &limited)) {
+			tc->asteroids.add(objp, flags, limited);
+		}
+	}
+}
+
+void turret_candidates_reset()
+{
+	Turret_candidates_current = NULL;
+}
+
+/**
+ * Returns the candidate lists for the turrets of a ship, building them on the first call after turret_candidates_reset()
+ */
+static turret_candidates *turret_candidates_get(int turret_parent_objnum)
+{
+	turret_candidates *tc = Turret_candidates_current;
+	int signature = Objects[turret_parent_objnum].signature;
+
+	if ( (tc != NULL) && (tc->parent_objnum == turret_parent_objnum) && (tc->parent_signature == signature) ) {
+		return tc;
+	}
+
+	int index = Turret_prefetched_index.empty() ? -1 : Turret_prefetched_index[turret_parent_objnum];
+	turret_prefetched_candidates *prefetched = NULL;
+
+	if ( (index >= 0) && (Turret_candidates_prefetched[index].parent_signature == signature) ) {
+		prefetched = &Turret_candidates_prefetched[index];
+	}
+
+	tc = &Turret_candidates;
+	turret_candidates_build(tc, turret_parent_objnum, prefetched);
+
+	Turret_candidates_current = tc;
+	return tc;
+}
+
+/**
+ * Gathers the objects of obj_used_list the turrets of each ship might pick on the worker threads
+ *
+ * This only saves the walk over all of obj_used_list (which is mostly lasers) when the turret candidates of a ship are
+ * built. Only the checks of turret_candidate_prefilter() which can't change during the frame are done here, with the
+ * range widened by how far the objects can move during it. When the ship is processed the full filter runs on the
+ * current state of every gathered object, and the ship, bomb and asteroid lists are built from their object lists as
+ * usual, so turrets pick exactly the same targets as without -ai_threads. Objects only enter obj_used_list when the
+ * created list is merged, which drops the prefetched objects.
+ *
+ * @param frametime The length of the frame the lists will be used in
+ */
+void ai_turret_prefetch_targets(float frametime)
+{
+	TRACE_SCOPE(tracing::AITurretPrefetch);
+
+	SCP_vector<int> parents;
+	float max_speed = 0.0f;
+
+	for (object *objp = GET_FIRST(&obj_used_list); objp != END_OF_LIST(&obj_used_list); objp = GET_NEXT(objp)) {
+		max_speed = MAX(max_speed, vm_vec_mag(&objp->phys_info.vel));
+		max_speed = MAX(max_speed, vm_vec_mag(&objp->phys_info.max_vel));
+		max_speed = MAX(max_speed, vm_vec_mag(&objp->phys_info.afterburner_max_vel));
+		max_speed = MAX(max_speed, vm_vec_mag(&objp->phys_info.booster_max_vel));
+
+		if ( (objp->type != OBJ_SHIP) || (objp->flags[Object::Object_Flags::Should_be_dead]) ) {
+			continue;
+		}
+
+		ship *shipp = &Ships[objp->instance];
+		for (ship_subsys *pss = GET_FIRST(&shipp->subsys_list); pss != END_OF_LIST(&shipp->subsys_list); pss = GET_NEXT(pss)) {
+			if ( (pss->system_info->type == SUBSYSTEM_TURRET) && (pss->system_info->turret_num_firing_points > 0) ) {
+				parents.push_back(OBJ_INDEX(objp));
+				break;
+			}
+		}
+	}
+
+	// both the turret and the target may move
+	float slack = 2.0f * max_speed * frametime;
+
+	Turret_prefetched_index.assign(MAX_OBJECTS, -1);
+	if (Turret_candidates_prefetched.size() < parents.size()) {
+		Turret_candidates_prefetched.resize(parents.size());
+	}
+
+	for (size_t i = 0; i < parents.size(); i++) {
+		Turret_prefetched_index[parents[i]] = (int)i;
+	}
+
+	threading::parallel_for(parents.size(), 1, [&parents, slack](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			turret_prefetched_candidates *prefetched = &Turret_candidates_prefetched[i];
+			object *turret_parent = &Objects[parents[i]];
+			float max_dist = turret_candidates_max_dist(turret_parent) + slack;
+
+			prefetched->parent_signature = turret_parent->signature;
+			prefetched->objnums.clear();
+			prefetched->signatures.clear();
+
+			for (object *objp = GET_FIRST(&obj_used_list); objp != END_OF_LIST(&obj_used_list); objp = GET_NEXT(objp)) {
+				if (turret_candidate_prefilter(objp, turret_parent, max_dist)) {
+					prefetched->objnums.push_back(OBJ_INDEX(objp));
+					prefetched->signatures.push_back(objp->signature);
+				}
+			}
+		}
+	});
+}
+
+void ai_turret_prefetch_clear()
+{
+	Turret_prefetched_index.clear();
+	Turret_candidates_current = NULL;
+}
+
+/**
+ * Finds the candidates a turret has to evaluate
+ *
+ * Skips the objects the flags of the turret exclude and the ones which are certainly out of its range.
+ *
+ * @param list			Candidate list to check
+ * @param eeo			Turret to check for
+ * @param[out] indices	Indices into the list of the remaining candidates, in list order
+ */
+static void turret_candidates_in_range(const turret_candidate_list &list, const eval_enemy_obj_struct *eeo, SCP_vector<int> &indices)
+{
+	size_t count = list.objnums.size();
+	float tx = eeo->tpos->xyz.x;
+	float ty = eeo->tpos->xyz.y;
+	float tz = eeo->tpos->xyz.z;
+
+	indices.clear();
+	Turret_candidate_dist_sq.resize(count);
+
+	float *dist_sq = Turret_candidate_dist_sq.data();
+	const float *px = list.pos_x.data();
+	const float *py = list.pos_y.data();
+	const float *pz = list.pos_z.data();
+
+	for (size_t i = 0; i < count; i++) {
+		float dx = px[i] - tx;
+		float dy = py[i] - ty;
+		float dz = pz[i] - tz;
+
+		dist_sq[i] = dx*dx + dy*dy + dz*dz;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		if (list.skip_flags[i] & eeo->eeo_flags) {
+			continue;
+		}
+
+		if (list.range_limited[i]) {
+			float max_dist = (eeo->weapon_travel_dist + list.radius[i]) * TURRET_QUICK_DIST_SCALE;
+			if (dist_sq[i] >= max_dist * max_dist) {
+				continue;
+			}
+		}
+
+		indices.push_back((int)i);
+	}
+}
+
 /**
  * Given an object and an enemy team, return the index of the nearest enemy object.
  *
@@ -824,8 +1242,8 @@ int get_nearest_turret_objnum(int turret_parent_objnum, ship_subsys *turret_subs
 	ship_weapon *swp = &turret_subsys->weapons;
 
 	// list of stuff to go thru
-	ship_obj		*so;
-	missile_obj *mo;
+	turret_candidates *tc = turret_candidates_get(turret_parent_objnum);
+	SCP_vector<int> &candidates = Turret_candidate_indices;
 
 	//wip=&Weapon_info[tp->turret_weapon_type];
 	//weapon_travel_dist = MIN(wip->lifetime * wip->max_speed, wip->weapon_range);
@@ -916,9 +1334,10 @@ int get_nearest_turret_objnum(int turret_parent_objnum, ship_subsys *turret_subs
 			int n_w_classes = (int)tt->weapon_class.size();
 			
 			bool found_something;
-			object *ptr = GET_FIRST(&obj_used_list);
-			
-			while (ptr != END_OF_LIST(&obj_used_list)) {
+			turret_candidates_in_range(tc->all, &eeo, candidates);
+
+			for (auto idx : candidates) {
+				object *ptr = &Objects[tc->all.objnums[idx]];
 				found_something = false;
 
 				if(tt->obj_type > -1 && (ptr->type == tt->obj_type)) {
@@ -969,15 +1388,11 @@ int get_nearest_turret_objnum(int turret_parent_objnum, ship_subsys *turret_subs
 				if(!(found_something)) {
 					//we didnt find this object within this priority group
 					//skip to next without evaluating the object as target
-					ptr = GET_NEXT(ptr);
-
 					continue;
 				}
 
 
 				evaluate_obj_as_target(ptr, &eeo);
-
-				ptr = GET_NEXT(ptr);
 			}
 
 			//homing weapon entry...
@@ -1046,15 +1461,11 @@ int get_nearest_turret_objnum(int turret_parent_objnum, ship_subsys *turret_subs
 					//don't fire anti capital ship turrets at bombs.
 					if ( !((aip->ai_profile_flags[AI::Profile_Flags::Huge_turret_weapons_ignore_bombs]) && big_only_flag) )
 					{
-						// Missile_obj_list
-						for( mo = GET_FIRST(&Missile_obj_list); mo != END_OF_LIST(&Missile_obj_list); mo = GET_NEXT(mo) ) {
-							objp = &Objects[mo->objnum];
-							
-							Assert(objp->type == OBJ_WEAPON);
-							if ((Weapon_info[Weapons[objp->instance].weapon_info_index].wi_flags[Weapon::Info_Flags::Bomb]) || (Weapon_info[Weapons[objp->instance].weapon_info_index].wi_flags[Weapon::Info_Flags::Turret_Interceptable]))
-							{
-								evaluate_obj_as_target(objp, &eeo);
-							}
+						// Missile_obj_list, bombs and interceptable weapons only
+						turret_candidates_in_range(tc->bombs, &eeo, candidates);
+						for (auto idx : candidates) {
+							objp = &Objects[tc->bombs.objnums[idx]];
+							evaluate_obj_as_target(objp, &eeo);
 						}
 						// highest priority
 						if ( eeo.nearest_homing_bomb_objnum != -1 ) {					// highest priority is an incoming homing bomb
@@ -1068,8 +1479,9 @@ int get_nearest_turret_objnum(int turret_parent_objnum, ship_subsys *turret_subs
 				case 1:
 					//Return if a ship is found
 					// Ship_used_list
-					for ( so = GET_FIRST(&Ship_obj_list); so != END_OF_LIST(&Ship_obj_list); so = GET_NEXT(so) ) {
-						objp = &Objects[so->objnum];
+					turret_candidates_in_range(tc->ships, &eeo, candidates);
+					for (auto idx : candidates) {
+						objp = &Objects[tc->ships.objnums[idx]];
 						evaluate_obj_as_target(objp, &eeo);
 					}
 
@@ -1083,7 +1495,6 @@ int get_nearest_turret_objnum(int turret_parent_objnum, ship_subsys *turret_subs
 				case 2:
 					//Return if an asteroid is found
 					// asteroid check - taylor
-					asteroid_obj *ao;
 
 					// don't use turrets that are better for other things:
 					// - no cap ship beams
@@ -1097,8 +1508,9 @@ int get_nearest_turret_objnum(int turret_parent_objnum, ship_subsys *turret_subs
                     
 					if ( !all_turret_weapons_have_flags(swp, tmp_flagset) ) {
 						// Asteroid_obj_list
-						for ( ao = GET_FIRST(&Asteroid_obj_list); ao != END_OF_LIST(&Asteroid_obj_list); ao = GET_NEXT(ao) ) {
-							objp = &Objects[ao->objnum];
+						turret_candidates_in_range(tc->asteroids, &eeo, candidates);
+						for (auto idx : candidates) {
+							objp = &Objects[tc->asteroids.objnums[idx]];
 							evaluate_obj_as_target(objp, &eeo);
 						}
 
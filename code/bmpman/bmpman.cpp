@@ -36,6 +36,9 @@
 #include "tgautils/tgautils.h"
 #include "tracing/Monitor.h"
 #include "tracing/tracing.h"
+#include "utils/block_allocator.h"
+#include "utils/flat_hash_map.h"
+#include "utils/threading.h"
 
 #include <ctype.h>
 #include <limits.h>
@@ -86,6 +89,7 @@ void(*bm_set_components_32)(ubyte *pixel, ubyte *r, ubyte *g, ubyte *b, ubyte *a
 // --------------------------------------------------------------------------------------------------------------------
 // Declaration of protected variables (defined in cmdline.cpp).
 extern int Cmdline_cache_bitmaps;
+extern int Cmdline_bitmap_threads;
 
 // --------------------------------------------------------------------------------------------------------------------
 // Definition of public variables (declared as extern in bm_internal.h).
@@ -110,6 +114,19 @@ static int Bm_max_ram = 0;
 static int Bm_ignore_duplicates = 0;
 static int Bm_ignore_load_count = 0;
 
+// Tracks which slots of bm_bitmaps are in use so that finding a free slot or a block of slots for an animation
+// doesn't have to scan the whole array
+static block_allocator Bm_slots;
+
+// Index of the loaded bitmaps by the case insensitive hash of their filename without extension. Each hash refers to a
+// chain of slots linked through Bm_name_next which is kept sorted by slot number. Only the first frame of an animation
+// is indexed since the other frames can't be found before it anyway.
+struct bm_name_index_entry {
+	int first = -1;
+};
+static flat_hash_map<bm_name_index_entry> Bm_name_index;
+static int Bm_name_next[MAX_BITMAPS];
+
 // --------------------------------------------------------------------------------------------------------------------
 // Declaration of private functions and templates(declared as static type func(type param);)
 
@@ -236,14 +253,6 @@ static int bm_load_sub_slow(const char *real_filename, const int num_ext, const
  */
 static int bm_load_sub_fast(const char *real_filename, int *handle, int dir_type = CF_TYPE_ANY, bool animated_type = false);
 
-/**
- * Finds a block of... something
- *
- * @returns -1 if the block could not be found
- * @returns the handle of the block ?
- */
-static int find_block_of(int n);
-
 /**
  * Finds if a slot contains an animation
  */
@@ -254,6 +263,74 @@ static bool bm_is_anim(int num)
 			(bm_bitmaps[num].type == BM_TYPE_PNG && bm_bitmaps[num].info.ani.apng.is_apng == true));
 }
 
+/**
+ * Case insensitive hash of a filename without its extension, same as what strextcmp() compares
+ */
+static uint bm_hash_filename(const char *filename)
+{
+	const char *end = strrchr(filename, '.');
+	size_t len = (end != NULL) ? (size_t)(end - filename) : strlen(filename);
+	uint hash = 2166136261u;
+
+	for (size_t i = 0; i < len; i++) {
+		hash ^= (uint)(unsigned char)tolower((unsigned char)filename[i]);
+		hash *= 16777619u;
+	}
+
+	if (hash == flat_hash_map<bm_name_index_entry>::EMPTY_KEY) {
+		hash = 0;
+	}
+
+	return hash;
+}
+
+/**
+ * Adds a slot to the filename index, must be called once the filename and type of the slot are set
+ */
+static void bm_name_index_add(int n)
+{
+	auto &entry = Bm_name_index[bm_hash_filename(bm_bitmaps[n].filename)];
+	int *link = &entry.first;
+
+	while ((*link >= 0) && (*link < n)) {
+		link = &Bm_name_next[*link];
+	}
+
+	Bm_name_next[n] = *link;
+	*link = n;
+}
+
+/**
+ * Removes a slot from the filename index, must be called before the filename of the slot is changed
+ *
+ * @returns true if the slot was in the index
+ */
+static bool bm_name_index_remove(int n)
+{
+	auto hash = bm_hash_filename(bm_bitmaps[n].filename);
+	auto entry = Bm_name_index.find(hash);
+	bool found = false;
+
+	if (entry == nullptr) {
+		return false;
+	}
+
+	for (int *link = &entry->first; *link >= 0; link = &Bm_name_next[*link]) {
+		if (*link == n) {
+			*link = Bm_name_next[n];
+			Bm_name_next[n] = -1;
+			found = true;
+			break;
+		}
+	}
+
+	if (entry->first < 0) {
+		Bm_name_index.erase(hash);
+	}
+
+	return found;
+}
+
 
 // --------------------------------------------------------------------------------------------------------------------
 // Macro-defined functions
@@ -267,9 +344,23 @@ DCF(bm_frag, "Shows BmpMan fragmentation") {
 		dc_printf("\tBlue  : ANI, EFF\n\n");
 
 		dc_printf("Once done reviewing the graphic, press any key to return to the console\n");
+		dc_printf("The slot allocator statistics are printed to the console as well\n");
 		return;
 	}
 
+	size_t longest_chain = 0;
+	Bm_name_index.for_each([&longest_chain](uint, bm_name_index_entry &entry) {
+		size_t length = 0;
+		for (int n = entry.first; n >= 0; n = Bm_name_next[n]) {
+			length++;
+		}
+		longest_chain = MAX(longest_chain, length);
+	});
+
+	dc_printf("Slots in use: %d/%d\n", Bm_slots.num_used(), Bm_slots.size());
+	dc_printf("Free blocks: %d, largest free block: %d slots\n", Bm_slots.count_free_blocks(), Bm_slots.largest_free_block());
+	dc_printf("Filename index: " SIZE_T_ARG " names, longest chain " SIZE_T_ARG "\n", Bm_name_index.size(), longest_chain);
+
 	gr_clear();
 
 	int x = 0, y = 0;
@@ -493,27 +584,20 @@ int bm_create(int bpp, int w, int h, void *data, int flags) {
 
 	if (!bm_inited) bm_init();
 
-	int n = -1;
-
-	for (int i = MAX_BITMAPS - 1; i >= 0; i--) {
-		if (bm_bitmaps[i].type == BM_TYPE_NONE) {
-			n = i;
-			break;
-		}
+	// make sure that we have valid data
+	if (data == NULL) {
+		Int3();
+		return -1;
 	}
 
+	int n = Bm_slots.allocate_last();
+
 	Assert(n > -1);
 
 	// Out of bitmap slots
 	if (n == -1)
 		return -1;
 
-	// make sure that we have valid data
-	if (data == NULL) {
-		Int3();
-		return -1;
-	}
-
 	memset(&bm_bitmaps[n], 0, sizeof(bitmap_entry));
 
 	sprintf(bm_bitmaps[n].filename, "TMP%dx%d+%d", w, h, bpp);
@@ -542,6 +626,8 @@ int bm_create(int bpp, int w, int h, void *data, int flags) {
 
 	bm_bitmaps[n].load_count++;
 
+	bm_name_index_add(n);
+
 	bm_update_memory_used(n, (int)bm_bitmaps[n].mem_taken);
 
 	gr_bm_create(n);
@@ -999,7 +1085,11 @@ void bm_init() {
 		atexit(bm_close);
 	}
 
+	Bm_slots.reset(MAX_BITMAPS);
+	Bm_name_index.clear();
+
 	for (i = 0; i<MAX_BITMAPS; i++) {
+		Bm_name_next[i] = -1;
 		bm_bitmaps[i].filename[0] = '\0';
 		bm_bitmaps[i].type = BM_TYPE_NONE;
 		bm_bitmaps[i].comp_type = BM_TYPE_NONE;
@@ -1192,7 +1282,7 @@ static int bm_load_info(BM_TYPE type, int n, const char *filename, CFILE *img_cf
 }
 
 int bm_load(const char *real_filename) {
-	int i, free_slot = -1;
+	int free_slot = -1;
 	int w, h, bpp = 8;
 	int rc = 0;
 	size_t bm_size = 0;
@@ -1252,12 +1342,7 @@ int bm_load(const char *real_filename) {
 	Assert(type != BM_TYPE_NONE);
 
 	// Find an open slot
-	for (i = 0; i < MAX_BITMAPS; i++) {
-		if (bm_bitmaps[i].type == BM_TYPE_NONE) {
-			free_slot = i;
-			break;
-		}
-	}
+	free_slot = Bm_slots.allocate_first(1);
 
 	if (free_slot < 0) {
 		Assertion(free_slot < 0, "Could not find free BMPMAN slot for bitmap: %s", real_filename);
@@ -1266,8 +1351,10 @@ int bm_load(const char *real_filename) {
 
 	rc = bm_load_info(type, free_slot, filename, img_cfp, &w, &h, &bpp, &c_type, &mm_lvl, &bm_size);
 
-	if (rc != 0)
+	if (rc != 0) {
+		Bm_slots.release(free_slot, 1);
 		goto Done;
+	}
 
 	if ((bm_size <= 0) && (w) && (h) && (bpp))
 		bm_size = (w * h * (bpp >> 3));
@@ -1301,6 +1388,8 @@ int bm_load(const char *real_filename) {
 
 	bm_bitmaps[free_slot].load_count++;
 
+	bm_name_index_add(free_slot);
+
 Done:
 	if (img_cfp != NULL)
 		cfclose(img_cfp);
@@ -1691,7 +1780,12 @@ int bm_load_animation(const char *real_filename, int *nframes, int *fps, int *ke
 	}
 
 
-	n = find_block_of(anim_frames);
+	if (anim_frames < 1) {
+		Int3();
+		n = -1;
+	} else {
+		n = Bm_slots.allocate_first(anim_frames);
+	}
 
 	if (n < 0) {
 		if (img_cfp != nullptr)
@@ -1711,6 +1805,9 @@ int bm_load_animation(const char *real_filename, int *nframes, int *fps, int *ke
 
 			// bm_load_info() returns non-0 on failure
 			if (bm_load_info(eff_type, n + i, bm_bitmaps[n + i].info.ani.eff.filename, NULL, &anim_width, &anim_height, &bpp, &c_type, &mm_lvl, &img_size)) {
+				// the slots of the missing frames aren't needed anymore
+				Bm_slots.release(n + i, anim_frames - i);
+
 				// if we didn't get anything then bail out now
 				if (i == 0) {
 					Warning(LOCATION, "EFF: No frame images were found.  EFF, %s, is invalid.\n", filename);
@@ -1789,6 +1886,8 @@ int bm_load_animation(const char *real_filename, int *nframes, int *fps, int *ke
 
 	}
 
+	bm_name_index_add(n);
+
 	if (nframes != nullptr)
 		*nframes = anim_frames;
 
@@ -1841,9 +1940,13 @@ int bm_load_sub_fast(const char *real_filename, int *handle, int dir_type, bool
 	if (Bm_ignore_duplicates)
 		return 0;
 
-	int i;
+	auto entry = Bm_name_index.find(bm_hash_filename(real_filename));
 
-	for (i = 0; i < MAX_BITMAPS; i++) {
+	if (entry == nullptr)
+		return 0;
+
+	// the chain is sorted by slot so this finds the same bitmap as searching bm_bitmaps from the start
+	for (int i = entry->first; i >= 0; i = Bm_name_next[i]) {
 		if (bm_bitmaps[i].type == BM_TYPE_NONE)
 			continue;
 
@@ -2456,7 +2559,7 @@ void bm_lock_user(int handle, int bitmapnum, bitmap_entry *be, bitmap *bmp, int
 }
 
 int bm_make_render_target(int width, int height, int flags) {
-	int i, n;
+	int n;
 	int mm_lvl = 0;
 	// final w and h may be different from passed width and height
 	int w = width, h = height;
@@ -2467,19 +2570,16 @@ int bm_make_render_target(int width, int height, int flags) {
 		bm_init();
 
 	// Find an open slot (starting from the end)
-	for (n = -1, i = MAX_BITMAPS - 1; i >= 0; i--) {
-		if (bm_bitmaps[i].type == BM_TYPE_NONE) {
-			n = i;
-			break;
-		}
-	}
+	n = Bm_slots.allocate_last();
 
 	// Out of bitmap slots
 	if (n == -1)
 		return -1;
 
-	if (!gr_bm_make_render_target(n, &w, &h, &bpp, &mm_lvl, flags))
+	if (!gr_bm_make_render_target(n, &w, &h, &bpp, &mm_lvl, flags)) {
+		Bm_slots.release(n, 1);
 		return -1;
+	}
 
 	Assert(mm_lvl > 0);
 
@@ -2581,6 +2681,228 @@ void bm_page_in_start() {
 	gr_bm_page_in_start();
 }
 
+/**
+ * Image data which has been read and decoded on a worker thread but not handed to the bitmap entry yet
+ */
+typedef struct bm_decoded_image {
+	int bitmapnum;
+	ubyte *data;		// NULL if decoding failed
+	size_t size;
+	int bpp;
+	ubyte flags;
+} bm_decoded_image;
+
+/**
+ * @brief Checks if the image data of a bitmap which is paged in can be decoded on a worker thread
+ *
+ * Only DDS, PNG and TGA images qualify. JPG decoding uses global libjpeg state and the other formats are either
+ * palettized or animations which need the bitmap entries of all their frames. 16 bit TGAs are converted through
+ * bm_set_components which is set up by bm_lock(), so they are left to it as well.
+ */
+static bool bm_can_decode_async(int bitmapnum) {
+	bitmap_entry *be = &bm_bitmaps[bitmapnum];
+
+	// AABITMAPs are locked as 8 bit images which only PCX supports anyway
+	if ((be->preloaded == 0) || (be->preloaded == 2) || (be->bm.data != 0) || (be->ref_count != 0)) {
+		return false;
+	}
+
+	BM_TYPE c_type = (be->type == BM_TYPE_EFF) ? be->info.ani.eff.type : be->type;
+
+	switch (c_type) {
+	case BM_TYPE_PNG:
+		return (be->type == BM_TYPE_EFF) || !be->info.ani.apng.is_apng;
+
+	case BM_TYPE_TGA:
+		return (be->mem_taken > 0) && (be->bm.true_bpp > 16);
+
+	case BM_TYPE_DDS:
+	case BM_TYPE_DXT1:
+	case BM_TYPE_DXT3:
+	case BM_TYPE_DXT5:
+	case BM_TYPE_CUBEMAP_DDS:
+	case BM_TYPE_CUBEMAP_DXT1:
+	case BM_TYPE_CUBEMAP_DXT3:
+	case BM_TYPE_CUBEMAP_DXT5:
+		return be->mem_taken > 0;
+
+	default:
+		return false;
+	}
+}
+
+/**
+ * @brief Reads and decodes the image data of a bitmap on a worker thread
+ *
+ * This produces the same data as bm_lock_png(), bm_lock_dds() and bm_lock_tga() would when the bitmap is locked by
+ * gr_preload(), but it only reads from the bitmap entry. The result is handed to the entry by bm_install_decoded_image()
+ * on the main thread.
+ */
+static void bm_decode_image(bm_decoded_image *img) {
+	const bitmap_entry *be = &bm_bitmaps[img->bitmapnum];
+	const bitmap *bmp = &be->bm;
+	char filename[MAX_FILENAME_LEN];
+	int error;
+
+	// make sure we are using the correct filename in the case of an EFF.
+	// this will populate filename[] whether it's EFF or not
+	EFF_FILENAME_CHECK;
+
+	BM_TYPE c_type = (be->type == BM_TYPE_EFF) ? be->info.ani.eff.type : be->type;
+
+	// gr_preload() locks textures with 16 bpp which is then raised to the true bpp of the image
+	int true_bpp = MAX(bmp->true_bpp, 16);
+
+	img->data = NULL;
+	img->flags = 0;
+
+	if (c_type == BM_TYPE_PNG) {
+		// libpng expands everything to 32 bit
+		int png_bpp = 32;
+
+		img->size = (size_t)(bmp->w * bmp->h * (png_bpp >> 3));
+		img->data = (ubyte*)vm_malloc(img->size);
+		memset(img->data, 0, img->size);
+
+		error = png_read_bitmap(filename, img->data, &png_bpp, 4, be->dir_type);
+
+		if (error != PNG_ERROR_NONE) {
+			vm_free(img->data);
+			img->data = NULL;
+			return;
+		}
+
+		img->bpp = png_bpp;
+	} else if (c_type == BM_TYPE_TGA) {
+		img->size = be->mem_taken;
+		img->data = (ubyte*)vm_malloc(img->size);
+		memset(img->data, 0, img->size);
+
+		error = targa_read_bitmap(filename, img->data, NULL, (true_bpp >> 3), be->dir_type);
+
+		if (error != TARGA_ERROR_NONE) {
+			vm_free(img->data);
+			img->data = NULL;
+			return;
+		}
+
+		bitmap converted = *bmp;
+		converted.bpp = true_bpp;
+		converted.data = (ptr_u)img->data;
+		converted.flags = 0;
+
+		bm_convert_format(&converted, BMP_TEX_OTHER);
+
+		img->bpp = converted.bpp;
+		img->flags = converted.flags;
+	} else {
+		ubyte dds_bpp = 0;
+
+		img->size = be->mem_taken;
+		img->data = (ubyte*)vm_malloc(img->size);
+		memset(img->data, 0, img->size);
+
+		error = dds_read_bitmap(filename, img->data, &dds_bpp, be->dir_type);
+
+		if (error != DDS_ERROR_NONE) {
+			vm_free(img->data);
+			img->data = NULL;
+			return;
+		}
+
+#if BYTE_ORDER == BIG_ENDIAN
+		// same as in bm_lock_dds(), byte swap 16 & 32-bit uncompressed images
+		if ((be->comp_type == BM_TYPE_DDS) || (be->comp_type == BM_TYPE_CUBEMAP_DDS)) {
+			size_t i;
+
+			if (dds_bpp == 32) {
+				for (i = 0; i < img->size; i += 4) {
+					unsigned int *swap_tmp = (unsigned int *)(img->data + i);
+					*swap_tmp = INTEL_INT(*swap_tmp);
+				}
+			} else if (dds_bpp == 16) {
+				for (i = 0; i < img->size; i += 2) {
+					unsigned short *swap_tmp = (unsigned short *)(img->data + i);
+					*swap_tmp = INTEL_SHORT(*swap_tmp);
+				}
+			}
+		}
+#endif
+
+		img->bpp = dds_bpp;
+	}
+}
+
+/**
+ * @brief Hands image data which was decoded on a worker thread to its bitmap entry
+ *
+ * The next bm_lock() of the bitmap will find the data already loaded and skip reading the file.
+ *
+ * @return @c false if the bitmap has been loaded in the meantime, the decoded data is freed in that case
+ */
+static bool bm_install_decoded_image(bm_decoded_image *img) {
+	bitmap_entry *be = &bm_bitmaps[img->bitmapnum];
+	bitmap *bmp = &be->bm;
+
+	if (bmp->data != 0) {
+		vm_free(img->data);
+		img->data = NULL;
+		return false;
+	}
+
+#ifdef BMPMAN_NDEBUG
+	Assert(be->data_size == 0);
+	be->data_size = img->size;
+	bm_texture_ram += img->size;
+#endif
+
+	bmp->bpp = img->bpp;
+	bmp->flags = img->flags;
+	bmp->data = (ptr_u)img->data;
+	bmp->palette = NULL;
+
+	img->data = NULL;
+	return true;
+}
+
+/**
+ * @brief Decodes the next batch of bitmaps which can be decoded on the worker threads
+ *
+ * @param[in,out] next_slot The first bitmap slot which has not been looked at yet, advanced past the batch
+ * @param[out] batch The decoded images, in bitmap slot order
+ */
+static void bm_decode_next_batch(int *next_slot, SCP_vector<bm_decoded_image> *batch) {
+	TRACE_SCOPE(tracing::PageInDecodeBitmaps);
+
+	// Limit how far the decoding runs ahead of the uploads so that not too much image data is held at the same time
+	size_t batch_size = (threading::num_workers() + 1) * 4;
+
+	batch->clear();
+
+	for (; (*next_slot < MAX_BITMAPS) && (batch->size() < batch_size); ++(*next_slot)) {
+		int i = *next_slot;
+
+		if ((bm_bitmaps[i].type == BM_TYPE_NONE) || !bm_can_decode_async(i)) {
+			continue;
+		}
+
+		bm_decoded_image img;
+		img.bitmapnum = i;
+		img.data = NULL;
+		img.size = 0;
+		img.bpp = 0;
+		img.flags = 0;
+
+		batch->push_back(img);
+	}
+
+	threading::parallel_for(batch->size(), 1, [batch](size_t begin, size_t end) {
+		for (size_t idx = begin; idx < end; ++idx) {
+			bm_decode_image(&(*batch)[idx]);
+		}
+	});
+}
+
 void bm_page_in_stop() {
 	TRACE_SCOPE(tracing::PageInStop);
 
@@ -2597,14 +2919,44 @@ void bm_page_in_stop() {
 
 	int bm_preloading = 1;
 
+	// With -bitmap_threads the image files are read and decoded on the worker threads in batches ahead of the upload
+	// loop below. The uploads still happen on this thread in slot order.
+	bool decode_async = Cmdline_bitmap_threads && (threading::num_workers() > 0) && !Is_standalone;
+	SCP_vector<bm_decoded_image> decoded;
+	size_t next_decoded = 0;
+	int next_decode_slot = 0;
+
 	for (i = 0; i < MAX_BITMAPS; i++) {
 		if ((bm_bitmaps[i].type != BM_TYPE_NONE) && (bm_bitmaps[i].type != BM_TYPE_RENDER_TARGET_DYNAMIC) && (bm_bitmaps[i].type != BM_TYPE_RENDER_TARGET_STATIC)) {
 			if (bm_bitmaps[i].preloaded) {
 				TRACE_SCOPE(tracing::PageInSingleBitmap);
+
+				ptr_u installed_data = 0;
+
+				if (decode_async && bm_preloading) {
+					if ((next_decoded == decoded.size()) && (next_decode_slot <= i)) {
+						next_decode_slot = i;
+						bm_decode_next_batch(&next_decode_slot, &decoded);
+						next_decoded = 0;
+					}
+
+					if ((next_decoded < decoded.size()) && (decoded[next_decoded].bitmapnum == i)) {
+						auto data = (ptr_u)decoded[next_decoded].data;
+
+						if ((data != 0) && bm_install_decoded_image(&decoded[next_decoded])) {
+							installed_data = data;
+						}
+						++next_decoded;
+					}
+				}
+
 				if (bm_preloading) {
 					if (!gr_preload(bm_bitmaps[i].handle, (bm_bitmaps[i].preloaded == 2))) {
 						mprintf(("Out of VRAM.  Done preloading.\n"));
 						bm_preloading = 0;
+					} else if ((installed_data != 0) && (bm_bitmaps[i].bm.data == installed_data)) {
+						// the texture was already in VRAM so the decoded data wasn't needed
+						bm_unload_fast(bm_bitmaps[i].handle);
 					}
 				} else {
 					bm_lock(bm_bitmaps[i].handle, (bm_bitmaps[i].used_flags == BMP_AABITMAP) ? 8 : 16, bm_bitmaps[i].used_flags);
@@ -2636,6 +2988,13 @@ void bm_page_in_stop() {
 		}
 	}
 
+	// Anything left over was decoded after preloading had to be stopped
+	for (; next_decoded < decoded.size(); ++next_decoded) {
+		if (decoded[next_decoded].data != NULL) {
+			vm_free(decoded[next_decoded].data);
+		}
+	}
+
 	nprintf(("BmpInfo", "BMPMAN: Loaded %d bitmaps that are marked as used for this level.\n", n));
 
 	int total_bitmaps = 0;
@@ -2840,6 +3199,9 @@ int bm_release(int handle, int clear_render_targets) {
 	if (bm_is_anim(n) == true) {
 		int i, first = be->info.ani.first_frame, total = bm_bitmaps[first].info.ani.num_frames;
 
+		bm_name_index_remove(first);
+		Bm_slots.release(first, total);
+
 		for (i = 0; i < total; i++) {
 			bm_free_data(first + i, true);		// clears flags, bbp, data, etc
 
@@ -2864,6 +3226,9 @@ int bm_release(int handle, int clear_render_targets) {
 			bm_bitmaps[first + i].handle = -1;
 		}
 	} else {
+		bm_name_index_remove(n);
+		Bm_slots.release(n, 1);
+
 		bm_free_data(n, true);		// clears flags, bbp, data, etc
 
 		memset(&bm_bitmaps[n], 0, sizeof(bitmap_entry));
@@ -2908,7 +3273,14 @@ int bm_reload(int bitmap_handle, const char* filename) {
 		return -1;
 	}
 
+	// frames of an animation other than the first one aren't in the index
+	bool indexed = bm_name_index_remove(bitmapnum);
+
 	strcpy_s(bm_bitmaps[bitmapnum].filename, filename);
+
+	if (indexed)
+		bm_name_index_add(bitmapnum);
+
 	return bitmap_handle;
 }
 
@@ -3235,29 +3607,3 @@ void bm_update_memory_used(int n, size_t size)
 	bm_texture_ram += size;
 #endif
 }
-
-int find_block_of(int n)
-{
-	int i, cnt = 0, nstart = 0;
-
-	if (n < 1) {
-		Int3();
-		return -1;
-	}
-
-	for (i = 0; i < MAX_BITMAPS; i++) {
-		if (bm_bitmaps[i].type == BM_TYPE_NONE) {
-			if (cnt == 0)
-				nstart = i;
-
-			cnt++;
-		} else {
-			cnt = 0;
-		}
-
-		if (cnt == n)
-			return nstart;
-	}
-
-	return -1;
-}
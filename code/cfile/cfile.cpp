@@ -31,10 +31,13 @@
 #include "cfile/cfile.h"
 #include "cfile/cfilearchive.h"
 #include "cfile/cfilesystem.h"
+#include "cmdline/cmdline.h"
 #include "osapi/osapi.h"
 #include "parse/encrypt.h"
+#include "utils/threading.h"
 
 #include <limits>
+#include <mutex>
 
 char Cfile_root_dir[CFILE_ROOT_DIRECTORY_LEN] = "";
 char Cfile_user_dir[CFILE_ROOT_DIRECTORY_LEN] = "";
@@ -98,17 +101,38 @@ static int Cfile_stack_pos = 0;
 
 static char Cfile_stack[CFILE_STACK_MAX][CFILE_ROOT_DIRECTORY_LEN];
 
-Cfile_block Cfile_block_list[MAX_CFILE_BLOCKS];
-static CFILE Cfile_list[MAX_CFILE_BLOCKS];
+// deques so that adding blocks doesn't move the existing ones
+SCP_deque<Cfile_block> Cfile_block_list;
+static SCP_deque<CFILE> Cfile_list;
 
 static const char *Cfile_cdrom_dir = NULL;
 
+// Pack files which have been memory mapped for reading the files inside them (-mmap_vps). They stay mapped until
+// cfile_close() so that opening a packed file doesn't need any system calls.
+typedef struct cf_mapped_pack {
+	void		*data;			// NULL if the pack file couldn't be mapped
+	size_t		length;
+#ifdef _WIN32
+	HANDLE		hInFile;
+	HANDLE		hMapFile;
+#endif
+} cf_mapped_pack;
+
+static SCP_unordered_map<SCP_string, cf_mapped_pack> Cfile_mapped_packs;
+
+// Files may be opened and read on worker threads (see utils/threading.h). Getting and releasing a block and mapping a
+// pack file is serialized by this mutex. The block lists are only grown while no worker thread has a file open since
+// growing a deque isn't safe while other threads are indexing into it.
+static std::mutex Cfile_block_mutex;
+static int Cfile_worker_blocks = 0;
+
 //
 // Function prototypes for internally-called functions
 //
 static int cfget_cfile_block();
 static CFILE *cf_open_fill_cfblock(const char* source, int line, FILE * fp, int type);
 static CFILE *cf_open_packed_cfblock(const char* source, int line, FILE *fp, int type, size_t offset, size_t size);
+static CFILE *cf_open_mapped_packed_cfblock(const char* source, int line, const ubyte *pack_data, int type, size_t offset, size_t size, bool mapped);
 
 #if defined _WIN32
 static CFILE *cf_open_mapped_fill_cfblock(const char* source, int line, HANDLE hFile, int type);
@@ -120,7 +144,7 @@ static void cf_chksum_long_init();
 
 static void dump_opened_files()
 {
-	for (int i = 0; i < MAX_CFILE_BLOCKS; i++) {
+	for (int i = 0; i < (int)Cfile_block_list.size(); i++) {
 		auto cb = &Cfile_block_list[i];
 		if (cb->type != CFILE_BLOCK_UNUSED) {
 			mprintf(("    %s:%d\n", cb->source_file, cb->line_num));
@@ -128,6 +152,94 @@ static void dump_opened_files()
 	}
 }
 
+// Returns the mapped data of a pack file, mapping it if this is the first file read from it. Returns NULL if the pack
+// file can't be mapped in which case it should be read normally.
+static const ubyte *cf_get_mapped_pack(const char *pack_filename)
+{
+	std::lock_guard<std::mutex> guard(Cfile_block_mutex);
+
+	auto iter = Cfile_mapped_packs.find(pack_filename);
+
+	if (iter != Cfile_mapped_packs.end()) {
+		return (const ubyte *)iter->second.data;
+	}
+
+	cf_mapped_pack pack;
+	memset(&pack, 0, sizeof(pack));
+
+#if defined _WIN32
+	pack.hInFile = CreateFile(pack_filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+
+	if (pack.hInFile != INVALID_HANDLE_VALUE) {
+		LARGE_INTEGER file_size;
+
+		if (GetFileSizeEx(pack.hInFile, &file_size)) {
+			pack.length = (size_t)file_size.QuadPart;
+		}
+
+		pack.hMapFile = CreateFileMapping(pack.hInFile, NULL, PAGE_READONLY, 0, 0, NULL);
+
+		if (pack.hMapFile != NULL) {
+			pack.data = MapViewOfFile(pack.hMapFile, FILE_MAP_READ, 0, 0, 0);
+
+			if (pack.data == NULL) {
+				CloseHandle(pack.hMapFile);
+			}
+		}
+
+		if (pack.data == NULL) {
+			CloseHandle(pack.hInFile);
+		}
+	}
+#elif defined SCP_UNIX
+	FILE *fp = fopen(pack_filename, "rb");
+
+	if (fp) {
+		pack.length = filelength(fileno(fp));
+
+		if (pack.length > 0) {
+			pack.data = mmap(NULL, pack.length, PROT_READ, MAP_SHARED, fileno(fp), 0);
+
+			if (pack.data == MAP_FAILED) {
+				pack.data = NULL;
+			}
+		}
+
+		// the mapping stays valid after the file has been closed
+		fclose(fp);
+	}
+#endif
+
+	if (pack.data == NULL) {
+		mprintf(("CFILE: Unable to memory map pack file '%s', reading it normally.\n", pack_filename));
+	}
+
+	Cfile_mapped_packs.insert(std::make_pair(SCP_string(pack_filename), pack));
+
+	return (const ubyte *)pack.data;
+}
+
+static void cf_unmap_packs()
+{
+	for (auto &mapped : Cfile_mapped_packs) {
+		cf_mapped_pack *pack = &mapped.second;
+
+		if (pack->data == NULL) {
+			continue;
+		}
+
+#if defined _WIN32
+		UnmapViewOfFile(pack->data);
+		CloseHandle(pack->hMapFile);
+		CloseHandle(pack->hInFile);
+#elif defined SCP_UNIX
+		munmap(pack->data, pack->length);
+#endif
+	}
+
+	Cfile_mapped_packs.clear();
+}
+
 void cfile_close()
 {
 	mprintf(("Still opened files:\n"));
@@ -135,6 +247,8 @@ void cfile_close()
 
 	cf_free_secondary_filelist();
 
+	cf_unmap_packs();
+
 	cfile_inited = 0;
 }
 
@@ -231,7 +345,10 @@ int cfile_init(const char *exe_dir, const char *cdrom_dir)
 	snprintf(Cfile_user_dir_legacy, CFILE_ROOT_DIRECTORY_LEN-1, "%s/%s/", getenv("HOME"), Osreg_user_dir_legacy);
 #endif
 
-	for (i = 0; i < MAX_CFILE_BLOCKS; i++) {
+	Cfile_block_list.resize(MAX_CFILE_BLOCKS);
+	Cfile_list.resize(MAX_CFILE_BLOCKS);
+
+	for (i = 0; i < Cfile_block_list.size(); i++) {
 		Cfile_block_list[i].type = CFILE_BLOCK_UNUSED;
 	}
 
@@ -771,8 +888,14 @@ CFILE *_cfopen(const char* source, int line, const char *file_path, const char *
 		
 		if ( type & CFILE_MEMORY_MAPPED ) {
 		
-			// Can't open memory mapped files out of pack files
-			if ( offset == 0 )	{
+			// Can only open memory mapped files out of pack files if the pack files are mapped
+			if ( offset && Cmdline_mmap_vps ) {
+				const ubyte *pack_data = cf_get_mapped_pack(longname);
+
+				if ( pack_data ) {
+					return cf_open_mapped_packed_cfblock(source, line, pack_data, dir_type, offset, size, true);
+				}
+			} else if ( offset == 0 )	{
 #if defined _WIN32
 				HANDLE hFile;
 
@@ -791,6 +914,14 @@ CFILE *_cfopen(const char* source, int line, const char *file_path, const char *
 
 		} else {
 
+			if ( offset && Cmdline_mmap_vps ) {
+				const ubyte *pack_data = cf_get_mapped_pack(longname);
+
+				if ( pack_data ) {
+					return cf_open_mapped_packed_cfblock(source, line, pack_data, dir_type, offset, size, false);
+				}
+			}
+
 			FILE *fp = fopen( longname, "rb" );
 
 			if ( fp )	{
@@ -836,6 +967,14 @@ CFILE *_cfopen_special(const char* source, int line, const char *file_path, cons
 		return NULL;
 	}
 
+	if ( offset && Cmdline_mmap_vps ) {
+		const ubyte *pack_data = cf_get_mapped_pack(file_path);
+
+		if ( pack_data ) {
+			return cf_open_mapped_packed_cfblock(source, line, pack_data, dir_type, offset, size, false);
+		}
+	}
+
 	// "file_path" should already be a fully qualified path, so just try to open it
 	FILE *fp = fopen( file_path, "rb" );
 
@@ -883,17 +1022,44 @@ static int cfget_cfile_block()
 {	
 	int i;
 	Cfile_block *cb;
+	bool worker_thread = !threading::is_main_thread();
+
+	std::lock_guard<std::mutex> guard(Cfile_block_mutex);
 
-	for ( i = 0; i < MAX_CFILE_BLOCKS; i++ ) {
+	for ( i = 0; i < (int)Cfile_block_list.size(); i++ ) {
 		cb = &Cfile_block_list[i];
 		if ( cb->type == CFILE_BLOCK_UNUSED ) {
 			cb->data = NULL;
 			cb->fp = NULL;
+			cb->pack_data = NULL;
 			cb->type = CFILE_BLOCK_USED;
+			cb->worker_thread = worker_thread;
+			if ( worker_thread ) {
+				Cfile_worker_blocks++;
+			}
 			return i;
 		}
 	}
 
+	if ( worker_thread ) {
+		// the caller has to deal with this, we can't grow the lists or stop the game from a worker thread
+		return -1;
+	}
+
+	if ( Cmdline_mmap_vps && (Cfile_worker_blocks == 0) ) {
+		// no file handles are needed for files from mapped pack files so there is no reason to limit the number of blocks
+		Cfile_block_list.emplace_back();
+		Cfile_list.emplace_back();
+
+		cb = &Cfile_block_list.back();
+		cb->data = NULL;
+		cb->fp = NULL;
+		cb->pack_data = NULL;
+		cb->type = CFILE_BLOCK_USED;
+		cb->worker_thread = false;
+		return (int)Cfile_block_list.size() - 1;
+	}
+
 	// If we've reached this point, a free Cfile_block could not be found
 	nprintf(("Warning","A free Cfile_block could not be found.\n"));
 
@@ -918,11 +1084,13 @@ int cfclose( CFILE * cfile )
 
 	Assert(cfile != NULL);
 	Cfile_block *cb;
-	Assert(cfile->id >= 0 && cfile->id < MAX_CFILE_BLOCKS);
+	Assert(cfile->id >= 0 && cfile->id < (int)Cfile_block_list.size());
 	cb = &Cfile_block_list[cfile->id];	
 
 	result = 0;
-	if ( cb->data ) {
+	if ( cb->pack_data ) {
+		// the pack file stays mapped until cfile_close()
+	} else if ( cb->data ) {
 		// close memory mapped file
 #if defined _WIN32
 		result = UnmapViewOfFile((void*)cb->data);
@@ -948,6 +1116,11 @@ int cfclose( CFILE * cfile )
 		// VP  do nothing
 	}
 
+	std::lock_guard<std::mutex> guard(Cfile_block_mutex);
+
+	if ( cb->worker_thread ) {
+		Cfile_worker_blocks--;
+	}
 	cb->type = CFILE_BLOCK_UNUSED;
 	return result;
 }
@@ -959,7 +1132,7 @@ int cf_is_valid(CFILE *cfile)
 		return 0;
 
 	//Does it have a valid ID?
-	if(cfile->id < 0 || cfile->id >= MAX_CFILE_BLOCKS)
+	if(cfile->id < 0 || cfile->id >= (int)Cfile_block_list.size())
 		return 0;
 
 	//Is it used?
@@ -1053,6 +1226,45 @@ static CFILE *cf_open_packed_cfblock(const char* source, int line, FILE *fp, int
 
 
 
+// cf_open_mapped_packed_cfblock() will fill up a Cfile_block element in the Cfile_block_list[] array
+// for the case of a file being opened by cf_open() from a memory mapped pack file. If mapped is set then
+// the file can be accessed through cf_returndata() like any other memory mapped file.
+//
+// returns:   success ==> ptr to CFILE structure.  
+//            error   ==> NULL
+//
+static CFILE *cf_open_mapped_packed_cfblock(const char* source, int line, const ubyte *pack_data, int type, size_t offset, size_t size, bool mapped)
+{
+	int cfile_block_index;
+
+	cfile_block_index = cfget_cfile_block();
+	if ( cfile_block_index == -1 ) {
+		return NULL;
+	} else {
+		CFILE *cfp;
+		Cfile_block *cfbp;
+		cfbp = &Cfile_block_list[cfile_block_index];
+
+		cfp = &Cfile_list[cfile_block_index];
+		cfp->id = cfile_block_index;
+		cfp->version = 0;
+		cfbp->data = mapped ? (void*)(pack_data + offset) : NULL;
+		cfbp->fp = NULL;
+		cfbp->pack_data = pack_data;
+		cfbp->dir_type = type;
+		cfbp->max_read_len = 0;
+
+		cfbp->source_file = source;
+		cfbp->line_num = line;
+
+		cf_init_lowlevel_read_code(cfp, offset, size, 0 );
+
+		return cfp;
+	}
+}
+
+
+
 // cf_open_mapped_fill_cfblock() will fill up a Cfile_block element in the Cfile_block_list[] array
 // for the case of a file being opened by cf_open_mapped();
 //
@@ -1131,7 +1343,7 @@ void *cf_returndata(CFILE *cfile)
 {
 	Assert(cfile != NULL);
 	Cfile_block *cb;
-	Assert(cfile->id >= 0 && cfile->id < MAX_CFILE_BLOCKS);
+	Assert(cfile->id >= 0 && cfile->id < (int)Cfile_block_list.size());
 	cb = &Cfile_block_list[cfile->id];	
 	Assert(cb->data != NULL);
 	return cb->data;
@@ -1153,7 +1365,7 @@ void cf_set_version( CFILE * cfile, int version )
 void cf_set_max_read_len( CFILE * cfile, size_t len )
 {
 	Assert( cfile != NULL );
-	Assert( (cfile->id >= 0) && (cfile->id < MAX_CFILE_BLOCKS) );
+	Assert( (cfile->id >= 0) && (cfile->id < (int)Cfile_block_list.size()) );
 
 	Cfile_block *cb = &Cfile_block_list[cfile->id];
 
@@ -1414,13 +1626,13 @@ int cfilelength( CFILE * cfile )
 {
 	Assert(cfile != NULL);
 	Cfile_block *cb;
-	Assert(cfile->id >= 0 && cfile->id < MAX_CFILE_BLOCKS);
+	Assert(cfile->id >= 0 && cfile->id < (int)Cfile_block_list.size());
 	cb = &Cfile_block_list[cfile->id];	
 
 	// TODO: return length of memory mapped file
-	Assert( !cb->data );
+	Assert( !cb->data || cb->pack_data );
 
-	Assert(cb->fp != NULL);
+	Assert( (cb->fp != NULL) || (cb->pack_data != NULL) );
 
 	// cb->size gets set at cfopen
 	
@@ -1920,7 +2132,7 @@ int cflush(CFILE *cfile)
 {
 	Assert(cfile != NULL);
 	Cfile_block *cb;
-	Assert(cfile->id >= 0 && cfile->id < MAX_CFILE_BLOCKS);
+	Assert(cfile->id >= 0 && cfile->id < (int)Cfile_block_list.size());
 	cb = &Cfile_block_list[cfile->id];	
 
 	// not supported for memory mapped files
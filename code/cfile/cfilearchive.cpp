@@ -39,7 +39,7 @@ void cf_init_lowlevel_read_code( CFILE * cfile, size_t lib_offset, size_t size,
 	Assert(cfile != NULL);
 
 	Cfile_block *cb;
-	Assert(cfile->id >= 0 && cfile->id < MAX_CFILE_BLOCKS);
+	Assert(cfile->id >= 0 && cfile->id < (int)Cfile_block_list.size());
 	cb = &Cfile_block_list[cfile->id];	
 
 	cb->lib_offset = lib_offset;
@@ -71,22 +71,24 @@ int cfeof(CFILE *cfile)
 	Assert(cfile != NULL);
 
 	Cfile_block *cb;
-	Assert(cfile->id >= 0 && cfile->id < MAX_CFILE_BLOCKS);
+	Assert(cfile->id >= 0 && cfile->id < (int)Cfile_block_list.size());
 	cb = &Cfile_block_list[cfile->id];	
 
 	int result;
 
 	result = 0;
 
-	// cfeof() not supported for memory-mapped files
-	Assert( !cb->data );
+	if ( !cb->pack_data ) {
+		// cfeof() not supported for memory-mapped files
+		Assert( !cb->data );
 
-	Assert(cb->fp != NULL);
+		Assert(cb->fp != NULL);
 
-	#if defined(CHECK_POSITION) && !defined(NDEBUG)
-	auto raw_position = ftell(cb->fp) - cb->lib_offset;
-	Assert(raw_position == cb->raw_position);
-	#endif
+		#if defined(CHECK_POSITION) && !defined(NDEBUG)
+		auto raw_position = ftell(cb->fp) - cb->lib_offset;
+		Assert(raw_position == cb->raw_position);
+		#endif
+	}
 		
 	if (cb->raw_position >= cb->size ) {
 		result = 1;
@@ -106,18 +108,20 @@ int cftell( CFILE * cfile )
 {
 	Assert(cfile != NULL);
 	Cfile_block *cb;
-	Assert(cfile->id >= 0 && cfile->id < MAX_CFILE_BLOCKS);
+	Assert(cfile->id >= 0 && cfile->id < (int)Cfile_block_list.size());
 	cb = &Cfile_block_list[cfile->id];	
 
-	// Doesn't work for memory mapped files
-	Assert( !cb->data );
+	if ( !cb->pack_data ) {
+		// Doesn't work for memory mapped files
+		Assert( !cb->data );
 
-	Assert(cb->fp != NULL);
+		Assert(cb->fp != NULL);
 
-	#if defined(CHECK_POSITION) && !defined(NDEBUG)
-	auto raw_position = ftell(cb->fp) - cb->lib_offset;
-	Assert(raw_position == cb->raw_position);
-	#endif
+		#if defined(CHECK_POSITION) && !defined(NDEBUG)
+		auto raw_position = ftell(cb->fp) - cb->lib_offset;
+		Assert(raw_position == cb->raw_position);
+		#endif
+	}
 
 	// The rest of the code still uses ints, do an overflow check to detect cases where this fails
 	Assertion(cb->raw_position <= static_cast<size_t>(std::numeric_limits<int>::max()),
@@ -136,13 +140,15 @@ int cfseek( CFILE *cfile, int offset, int where )
 
 	Assert(cfile != NULL);
 	Cfile_block *cb;
-	Assert(cfile->id >= 0 && cfile->id < MAX_CFILE_BLOCKS);
+	Assert(cfile->id >= 0 && cfile->id < (int)Cfile_block_list.size());
 	cb = &Cfile_block_list[cfile->id];	
 
 
-	// TODO: seek to offset in memory mapped file
-	Assert( !cb->data );
-	Assert( cb->fp != NULL );
+	if ( !cb->pack_data ) {
+		// TODO: seek to offset in memory mapped file
+		Assert( !cb->data );
+		Assert( cb->fp != NULL );
+	}
 	
 	size_t goal_position;
 
@@ -166,6 +172,12 @@ int cfseek( CFILE *cfile, int offset, int where )
 	// Make sure we don't seek beyond the end of the file
 	CAP(goal_position, cb->lib_offset, cb->lib_offset + cb->size);
 
+	if ( cb->pack_data ) {
+		// just a matter of moving the read position for files in a memory mapped pack file
+		cb->raw_position = goal_position - cb->lib_offset;
+		return 0;
+	}
+
 	int result = fseek(cb->fp, (long)goal_position, SEEK_SET );
 	Assertion(goal_position >= cb->lib_offset, "Invalid offset values detected while seeking! Goal was " SIZE_T_ARG ", lib_offset is " SIZE_T_ARG ".", goal_position, cb->lib_offset);
 	cb->raw_position = goal_position - cb->lib_offset;
@@ -198,7 +210,7 @@ int cfread(void *buf, int elsize, int nelem, CFILE *cfile)
 	Cfile_block *cb = &Cfile_block_list[cfile->id];	
 
 	// cfread() not supported for memory-mapped files
-	if(cb->data != NULL)
+	if(cb->data != NULL && cb->pack_data == NULL)
 	{
 		Warning(LOCATION, "Writing is not supported for mem-mapped files");
 		return 0;
@@ -222,6 +234,14 @@ int cfread(void *buf, int elsize, int nelem, CFILE *cfile)
 		}
 	}
 
+	if ( cb->pack_data ) {
+		// the file is in a memory mapped pack file so this is just a copy
+		memcpy( buf, cb->pack_data + cb->lib_offset + cb->raw_position, size );
+		cb->raw_position += size;
+
+		return (int)(size / elsize);
+	}
+
 	size_t bytes_read = fread( buf, 1, size, cb->fp );
 	if ( bytes_read > 0 )	{
 		cb->raw_position += bytes_read;
@@ -247,6 +267,24 @@ int cfread_lua_number(double *buf, CFILE *cfile)
 
 	Cfile_block *cb = &Cfile_block_list[cfile->id];	
 
+	if ( cb->pack_data ) {
+		// scan a copy of the next few bytes, that's plenty for any number
+		char number_buf[64];
+		size_t len = MIN(sizeof(number_buf) - 1, cb->size - cb->raw_position);
+
+		memcpy( number_buf, cb->pack_data + cb->lib_offset + cb->raw_position, len );
+		number_buf[len] = '\0';
+
+		int chars_read = 0;
+		int items_read = sscanf(number_buf, LUA_NUMBER_SCAN "%n", buf, &chars_read);
+
+		if ( items_read == 1 ) {
+			cb->raw_position += chars_read;
+		}
+
+		return items_read;
+	}
+
 	// cfread() not supported for memory-mapped files
 	if(cb->data != NULL)
 	{
@@ -34,6 +34,7 @@ typedef struct Cfile_block {
 //	int		fd;				// file descriptor
 	size_t	data_length;	// length of data for mmap
 #endif
+	const ubyte	*pack_data;	// Start of the memory mapped pack file this file is read from. NULL if not read from a mapped pack file.
 	size_t	lib_offset;
 	size_t	raw_position;
 	size_t	size;				// for packed files
@@ -42,10 +43,14 @@ typedef struct Cfile_block {
 	
 	const char* source_file;
 	int line_num;
+
+	bool	worker_thread;	// true if the file was opened on a worker thread
 } Cfile_block;
 
+// The number of blocks which can be in use at the same time. When pack files are memory mapped (-mmap_vps) more blocks
+// are added as necessary since files read from a mapped pack file don't use any OS file handles.
 #define MAX_CFILE_BLOCKS	64
-extern Cfile_block Cfile_block_list[MAX_CFILE_BLOCKS];
+extern SCP_deque<Cfile_block> Cfile_block_list;
 
 // Called once to setup the low-level reading code.
 void cf_init_lowlevel_read_code( CFILE * cfile, size_t lib_offset, size_t size, size_t pos );
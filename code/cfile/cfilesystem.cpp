@@ -21,6 +21,8 @@
 #include <direct.h>
 #include <windows.h>
 #include <winbase.h>		/* needed for memory mapping of file functions */
+#include <sys/types.h>
+#include <sys/stat.h>
 #endif
 
 #ifdef SCP_UNIX
@@ -40,6 +42,7 @@
 #include "localization/localize.h"
 #include "osapi/osapi.h"
 #include "parse/parselo.h"
+#include "utils/flat_hash_map.h"
 
 #define CF_ROOTTYPE_PATH 0
 #define CF_ROOTTYPE_PACK 1
@@ -86,6 +89,7 @@ typedef struct cf_file {
 	int		size;								// How big it is in bytes
 	int		pack_offset;						// For pack files, where it is at.   0 if not in a pack file.  This can be used to tell if in a pack file.
 	char*	real_name;							// For real files, the full path
+	int		hash_next;							// Next file in File_index with the same name hash, -1 if none
 } cf_file;
 
 #define CF_NUM_FILES_PER_BLOCK   512
@@ -98,6 +102,15 @@ typedef struct cf_file_block {
 static uint Num_files = 0;
 static cf_file_block  *File_blocks[CF_MAX_FILE_BLOCKS];
 
+// Files are indexed by a case insensitive hash of their name without the extension. Each entry is a list of files
+// linked through cf_file::hash_next which is sorted by file index, and therefore by precedence.
+typedef struct cf_file_index_entry {
+	int		first = -1;
+	int		last = -1;
+} cf_file_index_entry;
+
+static flat_hash_map<cf_file_index_entry> File_index;
+
 // Return a pointer to to file 'index'.
 cf_file *cf_get_file(int index)
 {
@@ -157,6 +170,99 @@ cf_root *cf_create_root()
 	return &Root_blocks[block]->roots[offset];
 }
 
+// Length of a filename without its extension
+static size_t cf_filename_base_length(const char *filename)
+{
+	const char *ext = strrchr(filename, '.');
+
+	return ext ? (size_t)(ext - filename) : strlen(filename);
+}
+
+// Case insensitive hash of the first len characters of a filename
+static uint cf_hash_filename(const char *filename, size_t len)
+{
+	uint hash = 2166136261u;
+
+	for (size_t i = 0; i < len; i++) {
+		hash ^= (uint)(unsigned char)tolower((unsigned char)filename[i]);
+		hash *= 16777619u;
+	}
+
+	if (hash == flat_hash_map<cf_file_index_entry>::EMPTY_KEY) {
+		hash = 0;
+	}
+
+	return hash;
+}
+
+// Builds File_index from the current file list
+static void cf_build_file_index()
+{
+	File_index.clear();
+	File_index.reserve(Num_files);
+
+	for (uint ui = 0; ui < Num_files; ui++) {
+		cf_file *f = cf_get_file(ui);
+
+		f->hash_next = -1;
+
+		auto &entry = File_index[cf_hash_filename(f->name_ext, cf_filename_base_length(f->name_ext))];
+
+		if (entry.first < 0) {
+			entry.first = (int)ui;
+		} else {
+			cf_get_file(entry.last)->hash_next = (int)ui;
+		}
+
+		entry.last = (int)ui;
+	}
+}
+
+// Returns the index of the first file with the given name & extension in the given path, or -1 if there is none
+static int cf_find_indexed_file(const char *filespec, int pathtype)
+{
+	auto entry = File_index.find(cf_hash_filename(filespec, cf_filename_base_length(filespec)));
+
+	if (entry == nullptr) {
+		return -1;
+	}
+
+	for (int index = entry->first; index >= 0; index = cf_get_file(index)->hash_next) {
+		cf_file *f = cf_get_file(index);
+
+		// only search paths we're supposed to...
+		if ( (pathtype != CF_TYPE_ANY) && (pathtype != f->pathtype_index) )
+			continue;
+
+		if ( !stricmp(filespec, f->name_ext) )
+			return index;
+	}
+
+	return -1;
+}
+
+// Fills in the output parameters of cf_find_file_location() for a file from the file list
+static void cf_get_file_location(cf_file *f, int max_out, char *pack_filename, size_t *size, size_t *offset)
+{
+	if (size)
+		*size = f->size;
+
+	if (offset)
+		*offset = (size_t)f->pack_offset;
+
+	if (pack_filename) {
+		if (f->pack_offset < 1) {
+			// This is a real file, return the actual file path
+			strncpy( pack_filename, f->real_name, max_out );
+		} else {
+			// File is in a pack file
+			cf_root *r = cf_get_root(f->root_index);
+
+			strncpy( pack_filename, r->path, max_out );
+		}
+	}
+}
+
 // return the # of packfiles which exist
 int cf_get_packfile_count(cf_root *root)
 {
@@ -730,6 +836,305 @@ typedef struct VP_FILE {
 	_fs_time_t write_time;
 } VP_FILE;
 
+// Persistent cache of the files found in pack files, so that unchanged pack files don't have to be read on every start
+#define CF_PACK_INDEX_CACHE_ID			"VPIX"
+#define CF_PACK_INDEX_CACHE_VERSION		1
+#define CF_PACK_INDEX_CACHE_FILENAME	"vp_index.bin"
+
+// The cache file consists of a header followed by a record for every pack file which is directly followed by the
+// records of its files. All records have a fixed size and contain no pointers.
+typedef struct cf_pack_index_header {
+	char	id[4];
+	int		version;
+	uint	pathtypes_checksum;		// which path type a file belongs to depends on Pathtypes
+	int		num_packs;
+} cf_pack_index_header;
+
+typedef struct cf_pack_index_pack {
+	char			path[CF_MAX_PATHNAME_LENGTH];
+	std::int64_t	size;
+	std::int64_t	write_time;
+	int				num_files;
+	int				reserved;
+} cf_pack_index_pack;
+
+typedef struct cf_pack_index_file {
+	char		name_ext[CF_MAX_FILENAME_LENGTH];
+	int			pathtype_index;
+	_fs_time_t	write_time;
+	int			size;
+	int			pack_offset;
+} cf_pack_index_file;
+
+typedef struct cf_pack_index_entry {
+	std::int64_t	size = 0;
+	std::int64_t	write_time = 0;
+	bool			used = false;		// if this pack file is one of the current roots
+
+	SCP_vector<cf_pack_index_file>	files;
+} cf_pack_index_entry;
+
+static SCP_unordered_map<SCP_string, cf_pack_index_entry> Pack_index_cache;
+static bool Pack_index_cache_dirty = false;
+
+// -- from cfile.cpp --
+extern void cf_create_directory( int dir_type );
+
+static bool cf_get_file_stats(const char *path, std::int64_t *size, std::int64_t *write_time)
+{
+	struct stat buf;
+
+	if (stat(path, &buf) != 0) {
+		return false;
+	}
+
+	*size = (std::int64_t)buf.st_size;
+	*write_time = (std::int64_t)buf.st_mtime;
+
+	return true;
+}
+
+static uint cf_pack_index_pathtypes_checksum()
+{
+	uint checksum = 0;
+
+	// CF_TYPE_INVALID has neither a path nor extensions
+	for (int i = CF_TYPE_ROOT; i < CF_MAX_PATH_TYPES; i++) {
+		// pack files are searched case insensitively so a case insensitive hash is good enough
+		checksum = (checksum * 31) + cf_hash_filename(Pathtypes[i].path, strlen(Pathtypes[i].path));
+		checksum = (checksum * 31) + cf_hash_filename(Pathtypes[i].extensions, strlen(Pathtypes[i].extensions));
+	}
+
+	return checksum;
+}
+
+static void cf_load_pack_index_cache()
+{
+	Pack_index_cache.clear();
+	Pack_index_cache_dirty = false;
+
+	if (Cmdline_novpcache) {
+		return;
+	}
+
+	SCP_string cache_filename;
+	cf_create_default_path_string(cache_filename, CF_TYPE_CACHE, CF_PACK_INDEX_CACHE_FILENAME);
+
+	FILE *fp = fopen(cache_filename.c_str(), "rb");
+
+	if (!fp) {
+		return;
+	}
+
+	// the cache is small enough to be read in one go
+	int length = filelength(fileno(fp));
+	SCP_vector<ubyte> data(length > 0 ? (size_t)length : 0);
+
+	bool read_ok = !data.empty() && (fread(&data[0], 1, data.size(), fp) == data.size());
+
+	fclose(fp);
+
+	if (!read_ok || data.size() < sizeof(cf_pack_index_header)) {
+		return;
+	}
+
+	cf_pack_index_header header;
+	memcpy(&header, &data[0], sizeof(header));
+
+	if ( memcmp(header.id, CF_PACK_INDEX_CACHE_ID, sizeof(header.id)) || (header.version != CF_PACK_INDEX_CACHE_VERSION)
+		|| (header.pathtypes_checksum != cf_pack_index_pathtypes_checksum()) ) {
+		mprintf(("VP index cache is outdated, rebuilding it.\n"));
+		return;
+	}
+
+	size_t pos = sizeof(header);
+
+	for (int i = 0; i < header.num_packs; i++) {
+		cf_pack_index_pack pack;
+
+		if (data.size() - pos < sizeof(pack)) {
+			break;
+		}
+
+		memcpy(&pack, &data[pos], sizeof(pack));
+		pos += sizeof(pack);
+
+		if ( (pack.num_files < 0) || ((data.size() - pos) / sizeof(cf_pack_index_file) < (size_t)pack.num_files) ) {
+			break;
+		}
+
+		pack.path[CF_MAX_PATHNAME_LENGTH - 1] = '\0';
+
+		cf_pack_index_entry &entry = Pack_index_cache[pack.path];
+
+		entry.size = pack.size;
+		entry.write_time = pack.write_time;
+		entry.files.resize((size_t)pack.num_files);
+
+		if (pack.num_files > 0) {
+			memcpy(&entry.files[0], &data[pos], sizeof(cf_pack_index_file) * pack.num_files);
+			pos += sizeof(cf_pack_index_file) * pack.num_files;
+		}
+
+		for (auto &file : entry.files) {
+			file.name_ext[CF_MAX_FILENAME_LENGTH - 1] = '\0';
+		}
+	}
+
+	if ( Pack_index_cache.size() != (size_t)header.num_packs ) {
+		mprintf(("VP index cache is corrupt, rebuilding it.\n"));
+		Pack_index_cache.clear();
+	}
+}
+
+static void cf_save_pack_index_cache()
+{
+	if (Cmdline_novpcache) {
+		return;
+	}
+
+	// forget about pack files which don't exist anymore
+	for (auto iter = Pack_index_cache.begin(); iter != Pack_index_cache.end();) {
+		std::int64_t size, write_time;
+
+		if ( !iter->second.used && !cf_get_file_stats(iter->first.c_str(), &size, &write_time) ) {
+			iter = Pack_index_cache.erase(iter);
+			Pack_index_cache_dirty = true;
+		} else {
+			++iter;
+		}
+	}
+
+	if (!Pack_index_cache_dirty) {
+		return;
+	}
+
+	cf_create_directory(CF_TYPE_CACHE);
+
+	SCP_string cache_filename;
+	cf_create_default_path_string(cache_filename, CF_TYPE_CACHE, CF_PACK_INDEX_CACHE_FILENAME);
+
+	FILE *fp = fopen(cache_filename.c_str(), "wb");
+
+	if (!fp) {
+		mprintf(("Unable to write VP index cache '%s'!\n", cache_filename.c_str()));
+		return;
+	}
+
+	cf_pack_index_header header;
+
+	memcpy(header.id, CF_PACK_INDEX_CACHE_ID, sizeof(header.id));
+	header.version = CF_PACK_INDEX_CACHE_VERSION;
+	header.pathtypes_checksum = cf_pack_index_pathtypes_checksum();
+	header.num_packs = (int)Pack_index_cache.size();
+
+	bool write_ok = fwrite(&header, sizeof(header), 1, fp) == 1;
+
+	for (auto &cached : Pack_index_cache) {
+		cf_pack_index_pack pack;
+
+		memset(&pack, 0, sizeof(pack));
+		strncpy(pack.path, cached.first.c_str(), CF_MAX_PATHNAME_LENGTH - 1);
+		pack.size = cached.second.size;
+		pack.write_time = cached.second.write_time;
+		pack.num_files = (int)cached.second.files.size();
+
+		write_ok = write_ok && (fwrite(&pack, sizeof(pack), 1, fp) == 1);
+
+		if (!cached.second.files.empty()) {
+			write_ok = write_ok && (fwrite(&cached.second.files[0], sizeof(cf_pack_index_file), cached.second.files.size(), fp) == cached.second.files.size());
+		}
+	}
+
+	fclose(fp);
+
+	if (!write_ok) {
+		// don't leave a truncated cache behind
+		mprintf(("Unable to write VP index cache '%s'!\n", cache_filename.c_str()));
+		remove(cache_filename.c_str());
+	}
+
+	Pack_index_cache_dirty = false;
+}
+
+// Adds the files of a pack file from the index cache. Returns false if the pack file is not in the cache or has been
+// changed since it was cached.
+static bool cf_search_cached_root_pack(int root_index)
+{
+	if (Cmdline_novpcache) {
+		return false;
+	}
+
+	cf_root *root = cf_get_root(root_index);
+
+	auto iter = Pack_index_cache.find(root->path);
+
+	if (iter == Pack_index_cache.end()) {
+		return false;
+	}
+
+	std::int64_t size, write_time;
+
+	if ( !cf_get_file_stats(root->path, &size, &write_time) || (size != iter->second.size) || (write_time != iter->second.write_time) ) {
+		return false;
+	}
+
+	iter->second.used = true;
+
+	for (auto &cached : iter->second.files) {
+		cf_file *file = cf_create_file();
+		strcpy_s( file->name_ext, cached.name_ext );
+		file->root_index = root_index;
+		file->pathtype_index = cached.pathtype_index;
+		file->write_time = (time_t)cached.write_time;
+		file->size = cached.size;
+		file->pack_offset = cached.pack_offset;			// Mark as a packed file
+	}
+
+	mprintf(( "Searching root pack '%s' ... %i files (cached)\n", root->path, (int)iter->second.files.size() ));
+
+	return true;
+}
+
+// Stores the files which have been found in a pack file in the index cache
+static void cf_cache_root_pack(int root_index, uint first_file)
+{
+	if (Cmdline_novpcache) {
+		return;
+	}
+
+	cf_root *root = cf_get_root(root_index);
+
+	std::int64_t size, write_time;
+
+	if ( !cf_get_file_stats(root->path, &size, &write_time) ) {
+		return;
+	}
+
+	cf_pack_index_entry &entry = Pack_index_cache[root->path];
+
+	entry.size = size;
+	entry.write_time = write_time;
+	entry.used = true;
+	entry.files.clear();
+
+	for (uint ui = first_file; ui < Num_files; ui++) {
+		cf_file *f = cf_get_file(ui);
+		cf_pack_index_file cached;
+
+		memset(&cached, 0, sizeof(cached));
+		strcpy_s( cached.name_ext, f->name_ext );
+		cached.pathtype_index = f->pathtype_index;
+		cached.write_time = (_fs_time_t)f->write_time;
+		cached.size = f->size;
+		cached.pack_offset = f->pack_offset;
+
+		entry.files.push_back(cached);
+	}
+
+	Pack_index_cache_dirty = true;
+}
+
 void cf_search_root_pack(int root_index)
 {
 	int num_files = 0;
@@ -737,6 +1142,12 @@ void cf_search_root_pack(int root_index)
 
 	Assert( root != NULL );
 
+	if ( cf_search_cached_root_pack(root_index) ) {
+		return;
+	}
+
+	uint first_file = Num_files;
+
 	// Open data		
 	FILE *fp = fopen( root->path, "rb" );
 	// Read the file header
@@ -833,6 +1244,8 @@ void cf_search_root_pack(int root_index)
 
 	fclose(fp);
 
+	cf_cache_root_pack(root_index, first_file);
+
 	mprintf(( "%i files\n", num_files ));
 }
 
@@ -844,6 +1257,8 @@ void cf_build_file_list()
 
 	Num_files = 0;
 
+	cf_load_pack_index_cache();
+
 	// For each root, find all files...
 	for (i=0; i<Num_roots; i++ )	{
 		cf_root	*root = cf_get_root(i);
@@ -854,6 +1269,10 @@ void cf_build_file_list()
 		}
 	}
 
+	cf_save_pack_index_cache();
+	Pack_index_cache.clear();
+
+	cf_build_file_index();
 }
 
 
@@ -915,6 +1334,8 @@ void cf_free_secondary_filelist()
 		}
 	}
 	Num_files = 0;
+
+	File_index.clear();
 }
 
 /**
@@ -1047,68 +1468,28 @@ int cf_find_file_location( const char *filespec, int pathtype, int max_out, char
 	}
 
 	// Search the pak files and CD-ROM.
-	for (ui = 0; ui < Num_files; ui++ )	{
-		cf_file *f = cf_get_file(ui);
-
-		// only search paths we're supposed to...
-		if ( (pathtype != CF_TYPE_ANY) && (pathtype != f->pathtype_index) )
-			continue;
-
-
-		if (localize) {
-			// create localized filespec
-			strncpy(longname, filespec, MAX_PATH_LEN - 1);
+	int file_index = cf_find_indexed_file(filespec, pathtype);
 
-			if ( lcl_add_dir_to_path_with_filename(longname, MAX_PATH_LEN - 1) ) {
-				if ( !stricmp(longname, f->name_ext) ) {
-					if (size)
-						*size = f->size;
-
-					if (offset)
-						*offset = (size_t)f->pack_offset;
+	if (localize) {
+		// create localized filespec
+		strncpy(longname, filespec, MAX_PATH_LEN - 1);
 
-					if (pack_filename) {
-						if (f->pack_offset < 1) {
-							// This is a real file, return the actual file path
-							strncpy( pack_filename, f->real_name, max_out );
-						} else {
-							// File is in a pack file
-							cf_root *r = cf_get_root(f->root_index);
+		if ( lcl_add_dir_to_path_with_filename(longname, MAX_PATH_LEN - 1) ) {
+			// files are indexed in order of precedence so the first match of either name wins
+			int localized_index = cf_find_indexed_file(longname, pathtype);
 
-							strncpy( pack_filename, r->path, max_out );
-						}
-					}
-
-					return 1;
-				}
+			if ( (localized_index >= 0) && ((file_index < 0) || (localized_index < file_index)) ) {
+				file_index = localized_index;
 			}
 		}
+	}
 
-		// file either not localized or localized version not found
-		if ( !stricmp(filespec, f->name_ext) ) {
-			if (size)
-				*size = f->size;
-
-			if (offset)
-				*offset = (size_t)f->pack_offset;
-
-			if (pack_filename) {
-				if (f->pack_offset < 1) {
-					// This is a real file, return the actual file path
-					strncpy( pack_filename, f->real_name, max_out );
-				} else {
-					// File is in a pack file
-					cf_root *r = cf_get_root(f->root_index);
+	if (file_index < 0)
+		return 0;
 
-					strncpy( pack_filename, r->path, max_out );
-				}
-			}
+	cf_get_file_location(cf_get_file(file_index), max_out, pack_filename, size, offset);
 
-			return 1;
-		}
-	}
-		
-	return 0;
+	return 1;
 }
 
 // -- from parselo.cpp --
@@ -1271,9 +1652,13 @@ int cf_find_file_location_ext( const char *filename, const int ext_num, const ch
 
 	file_list_index.reserve( MIN(ext_num * 4, (int)Num_files) );
 
-	// next, run though and pick out base matches
-	for (ui = 0; ui < Num_files; ui++) {
-		cf_file *f = cf_get_file(ui);
+	// next, run though the files with the same base name and pick out base matches
+	auto index_entry = File_index.find(cf_hash_filename(filespec, filespec_len));
+	int next_index = index_entry ? index_entry->first : -1;
+
+	while (next_index >= 0) {
+		cf_file *f = cf_get_file(next_index);
+		next_index = f->hash_next;
 
 		// ... only search paths that we're supposed to
 		if ( (num_search_dirs == 1) && (pathtype != f->pathtype_index) )
@@ -1328,23 +1713,7 @@ int cf_find_file_location_ext( const char *filename, const int ext_num, const ch
 
 				if ( lcl_add_dir_to_path_with_filename(longname, MAX_PATH_LEN - 1) ) {
 					if ( !stricmp(longname, f->name_ext) ) {
-						if (size)
-							*size = f->size;
-
-						if (offset)
-							*offset = f->pack_offset;
-
-						if (pack_filename) {
-							if (f->pack_offset < 1) {
-								// This is a real file, return the actual file path
-								strncpy( pack_filename, f->real_name, max_out );
-							} else {
-								// File is in a pack file
-								cf_root *r = cf_get_root(f->root_index);
-
-								strncpy( pack_filename, r->path, max_out );
-							}
-						}
+						cf_get_file_location(f, max_out, pack_filename, size, offset);
 
 						// found it, so cleanup and return
 						file_list_index.clear();
@@ -1356,23 +1725,7 @@ int cf_find_file_location_ext( const char *filename, const int ext_num, const ch
 
 			// file either not localized or localized version not found
 			if ( !stricmp(filespec, f->name_ext) ) {
-				if (size)
-					*size = f->size;
-
-				if (offset)
-					*offset = f->pack_offset;
-
-				if (pack_filename) {
-					if (f->pack_offset < 1) {
-						// This is a real file, return the actual file path
-						strncpy( pack_filename, f->real_name, max_out );
-					} else {
-						// File is in a pack file
-						cf_root *r = cf_get_root(f->root_index);
-
-						strncpy( pack_filename, r->path, max_out );
-					}
-				}
+				cf_get_file_location(f, max_out, pack_filename, size, offset);
 
 				// found it, so cleanup and return
 				file_list_index.clear();
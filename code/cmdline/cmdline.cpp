@@ -204,18 +204,28 @@ Flag exe_params[] =
 	{ "-mipmap",			"Enable mipmapping",						true,	0,					EASY_DEFAULT_MEM,	"Troubleshoot",	"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-mipmap", },
 	{ "-use_gldrawelements","Don't use glDrawRangeElements",			true,	0,					EASY_DEFAULT,		"Troubleshoot",	"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-use_gldrawelements", },
 	{ "-old_collision",		"Use old collision detection system",		true,	EASY_DEFAULT,		EASY_ALL_ON,		"Troubleshoot",	"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-old_collision", },
+	{ "-collision_grid",	"Use uniform grid collision broadphase",	true,	0,					EASY_DEFAULT,		"Troubleshoot",	"", },
 	{ "-gl_finish",			"Fix input lag on some ATI+Linux systems",	true,	0,					EASY_DEFAULT,		"Troubleshoot", "http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-gl_finish", },
 	{ "-no_batching",		"Disable batched model rendering",			true,	0,					EASY_DEFAULT,		"Troubleshoot", "", },
 	{ "-no_geo_effects",	"Disable geometry shader for effects",		true,	0,					EASY_DEFAULT,		"Troubleshoot", "", },
 	{ "-set_cpu_affinity",	"Sets processor affinity to config value",	true,	0,					EASY_DEFAULT,		"Troubleshoot", "", },
 	{ "-nograb",			"Disables mouse grabbing",					true,	0,					EASY_DEFAULT,		"Troubleshoot", "http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-nograb", },
 	{ "-noshadercache",		"Disables the shader cache",				true,	0,					EASY_DEFAULT,		"Troubleshoot", "http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-noshadercache", },
+	{ "-novpcache",			"Disables the VP index cache",				true,	0,					EASY_DEFAULT,		"Troubleshoot", "", },
+	{ "-nomodelcache",		"Disables the cooked model cache",			true,	0,					EASY_DEFAULT,		"Troubleshoot", "", },
 #ifdef WIN32
 	{ "-fix_registry",	"Use a different registry path",			true,		0,					EASY_DEFAULT,		"Troubleshoot", "", },
 #endif
 
 	{ "-ingame_join",		"Allow in-game joining",					true,	0,					EASY_DEFAULT,		"Experimental",	"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-ingame_join", },
 	{ "-voicer",			"Enable voice recognition",					true,	0,					EASY_DEFAULT,		"Experimental",	"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-voicer", },
+	{ "-collision_threads", "Use worker threads for collision checks",	true,	0,					EASY_DEFAULT,		"Experimental",	"", },
+	{ "-mmap_vps",			"Memory map VP files for reading",			true,	0,					EASY_DEFAULT,		"Experimental",	"", },
+	{ "-bitmap_threads",	"Decode level bitmaps on worker threads",	true,	0,					EASY_DEFAULT,		"Experimental",	"", },
+	{ "-ai_threads",		"Use worker threads for turret targeting",	true,	0,					EASY_DEFAULT,		"Experimental",	"", },
+	{ "-parse_threads",		"Read modular tables on worker threads",	true,	0,					EASY_DEFAULT,		"Experimental",	"", },
+	{ "-sound_threads",		"Decode level sounds on worker threads",	true,	0,					EASY_DEFAULT,		"Experimental",	"", },
+	{ "-physics_threads",	"Move weapons and debris in parallel",	true,	0,					EASY_DEFAULT,		"Experimental",	"", },
 
 	{ "-fps",				"Show frames per second on HUD",			false,	0,					EASY_DEFAULT,		"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-fps", },
 	{ "-pos",				"Show position of camera",					false,	0,					EASY_DEFAULT,		"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-pos", },
@@ -438,11 +448,21 @@ cmdline_parm no3dsound_arg("-no_3d_sound", NULL, AT_NONE);		// Cmdline_no_3d_sou
 cmdline_parm no_drawrangeelements("-use_gldrawelements", NULL, AT_NONE); // Cmdline_drawelements -- Uses glDrawElements instead of glDrawRangeElements
 cmdline_parm keyboard_layout("-keyboard_layout", "Specify keyboard layout (qwertz or azerty)", AT_STRING);
 cmdline_parm old_collision_system("-old_collision", NULL, AT_NONE); // Cmdline_old_collision_sys
+cmdline_parm collision_grid_arg("-collision_grid", NULL, AT_NONE); // Cmdline_collision_grid
+cmdline_parm collision_threads_arg("-collision_threads", NULL, AT_NONE); // Cmdline_collision_threads
+cmdline_parm mmap_vps_arg("-mmap_vps", NULL, AT_NONE); // Cmdline_mmap_vps
+cmdline_parm bitmap_threads_arg("-bitmap_threads", NULL, AT_NONE); // Cmdline_bitmap_threads
+cmdline_parm ai_threads_arg("-ai_threads", NULL, AT_NONE); // Cmdline_ai_threads
+cmdline_parm parse_threads_arg("-parse_threads", NULL, AT_NONE); // Cmdline_parse_threads
+cmdline_parm sound_threads_arg("-sound_threads", NULL, AT_NONE); // Cmdline_sound_threads
+cmdline_parm physics_threads_arg("-physics_threads", NULL, AT_NONE); // Cmdline_physics_threads
 cmdline_parm gl_finish ("-gl_finish", NULL, AT_NONE);
 cmdline_parm no_geo_sdr_effects("-no_geo_effects", NULL, AT_NONE);
 cmdline_parm set_cpu_affinity("-set_cpu_affinity", NULL, AT_NONE);
 cmdline_parm nograb_arg("-nograb", NULL, AT_NONE);
 cmdline_parm noshadercache_arg("-noshadercache", NULL, AT_NONE);
+cmdline_parm novpcache_arg("-novpcache", NULL, AT_NONE); // Cmdline_novpcache
+cmdline_parm nomodelcache_arg("-nomodelcache", NULL, AT_NONE); // Cmdline_nomodelcache
 #ifdef WIN32
 cmdline_parm fix_registry("-fix_registry", NULL, AT_NONE);
 #endif
@@ -461,6 +481,8 @@ bool Cmdline_no_geo_sdr_effects = false;
 bool Cmdline_set_cpu_affinity = false;
 bool Cmdline_nograb = false;
 bool Cmdline_noshadercache = false;
+bool Cmdline_novpcache = false;
+bool Cmdline_nomodelcache = false;
 #ifdef WIN32
 bool Cmdline_alternate_registry_path = false;
 #endif
@@ -495,6 +517,14 @@ cmdline_parm debug_window_arg("-debug_window", NULL, AT_NONE);	// Cmdline_debug_
 
 char *Cmdline_start_mission = NULL;
 int Cmdline_old_collision_sys = 0;
+int Cmdline_collision_grid = 0;
+int Cmdline_collision_threads = 0;
+int Cmdline_mmap_vps = 0;
+int Cmdline_bitmap_threads = 0;
+int Cmdline_ai_threads = 0;
+int Cmdline_parse_threads = 0;
+int Cmdline_sound_threads = 0;
+int Cmdline_physics_threads = 0;
 int Cmdline_dis_collisions = 0;
 int Cmdline_dis_weapons = 0;
 int Cmdline_noparseerrors = 0;
@@ -1710,6 +1740,16 @@ bool SetCmdlineParams()
 		Cmdline_noshadercache = true;
 	}
 
+	if (novpcache_arg.found())
+	{
+		Cmdline_novpcache = true;
+	}
+
+	if (nomodelcache_arg.found())
+	{
+		Cmdline_nomodelcache = true;
+	}
+
 	if (portable_mode.found())
 	{
 		Cmdline_portable_mode = true;
@@ -1741,6 +1781,30 @@ bool SetCmdlineParams()
 	if(old_collision_system.found())
 		Cmdline_old_collision_sys = 1;
 
+	if(collision_grid_arg.found())
+		Cmdline_collision_grid = 1;
+
+	if(collision_threads_arg.found())
+		Cmdline_collision_threads = 1;
+
+	if(mmap_vps_arg.found())
+		Cmdline_mmap_vps = 1;
+
+	if(bitmap_threads_arg.found())
+		Cmdline_bitmap_threads = 1;
+
+	if(ai_threads_arg.found())
+		Cmdline_ai_threads = 1;
+
+	if(parse_threads_arg.found())
+		Cmdline_parse_threads = 1;
+
+	if(sound_threads_arg.found())
+		Cmdline_sound_threads = 1;
+
+	if(physics_threads_arg.found())
+		Cmdline_physics_threads = 1;
+
 	if(dis_collisions.found())
 		Cmdline_dis_collisions = 1;
 
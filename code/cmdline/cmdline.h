@@ -137,6 +137,8 @@ extern bool Cmdline_no_geo_sdr_effects;
 extern bool Cmdline_set_cpu_affinity;
 extern bool Cmdline_nograb;
 extern bool Cmdline_noshadercache;
+extern bool Cmdline_novpcache;
+extern bool Cmdline_nomodelcache;
 #ifdef WIN32
 extern bool Cmdline_alternate_registry_path;
 #endif
@@ -144,6 +146,14 @@ extern bool Cmdline_alternate_registry_path;
 // Developer/Testing related
 extern char *Cmdline_start_mission;
 extern int Cmdline_old_collision_sys;
+extern int Cmdline_collision_grid;
+extern int Cmdline_collision_threads;
+extern int Cmdline_mmap_vps;
+extern int Cmdline_bitmap_threads;
+extern int Cmdline_ai_threads;
+extern int Cmdline_parse_threads;
+extern int Cmdline_sound_threads;
+extern int Cmdline_physics_threads;
 extern int Cmdline_dis_collisions;
 extern int Cmdline_dis_weapons;
 extern int Cmdline_noparseerrors;
@@ -514,14 +514,24 @@ void gamesnd_preload_common_sounds()
 		return;
 
 	Assert( Snds.size() <= INT_MAX );
+	SCP_vector<game_snd*> sounds;
 	for (SCP_vector<game_snd>::iterator gs = Snds.begin(); gs != Snds.end(); ++gs) {
 		if ( gs->filename[0] != 0 && strnicmp(gs->filename, NOX("none.wav"), 4) ) {
 			if ( gs->preload ) {
-				game_busy( NOX("** preloading common game sounds **") );	// Animate loading cursor... does nothing if loading screen not active.
-				gs->id = snd_load(&(*gs));
+				sounds.push_back(&(*gs));
 			}
 		}
 	}
+
+	// lets the worker threads decode them ahead of snd_load()
+	snd_queue_loads(sounds);
+
+	for (auto gs : sounds) {
+		game_busy( NOX("** preloading common game sounds **") );	// Animate loading cursor... does nothing if loading screen not active.
+		gs->id = snd_load(gs);
+	}
+
+	snd_queue_loads(SCP_vector<game_snd*>());
 }
 
 /**
@@ -533,14 +543,24 @@ void gamesnd_load_gameplay_sounds()
 		return;
 
 	Assert( Snds.size() <= INT_MAX );
+	SCP_vector<game_snd*> sounds;
 	for (SCP_vector<game_snd>::iterator gs = Snds.begin(); gs != Snds.end(); ++gs) {
 		if ( gs->filename[0] != 0 && strnicmp(gs->filename, NOX("none.wav"), 4) ) {
 			if ( !gs->preload ) { // don't try to load anything that's already preloaded
-				game_busy( NOX("** preloading gameplay sounds **") );		// Animate loading cursor... does nothing if loading screen not active.
-				gs->id = snd_load(&(*gs));
+				sounds.push_back(&(*gs));
 			}
 		}
 	}
+
+	// lets the worker threads decode them ahead of snd_load()
+	snd_queue_loads(sounds);
+
+	for (auto gs : sounds) {
+		game_busy( NOX("** preloading gameplay sounds **") );		// Animate loading cursor... does nothing if loading screen not active.
+		gs->id = snd_load(gs);
+	}
+
+	snd_queue_loads(SCP_vector<game_snd*>());
 }
 
 /**
@@ -566,11 +586,20 @@ void gamesnd_load_interface_sounds()
 		return;
 
 	Assert( Snds_iface.size() < INT_MAX );
+	SCP_vector<game_snd*> sounds;
 	for (SCP_vector<game_snd>::iterator si = Snds_iface.begin(); si != Snds_iface.end(); ++si) {
 		if ( si->filename[0] != 0 && strnicmp(si->filename, NOX("none.wav"), 4) ) {
-			si->id = snd_load(&(*si));
+			sounds.push_back(&(*si));
 		}
 	}
+
+	snd_queue_loads(sounds);
+
+	for (auto si : sounds) {
+		si->id = snd_load(si);
+	}
+
+	snd_queue_loads(SCP_vector<game_snd*>());
 }
 
 /**
@@ -80,7 +80,7 @@
 #define MAX_POLYGON_MODELS  300
 
 // object.h
-#define MAX_OBJECTS			3500		
+#define MAX_OBJECTS			5000		// enough for all the weapons, beams, debris and fireballs a large battle can have at once
 
 // from lighting.cpp
 #define MAX_LIGHTS 256
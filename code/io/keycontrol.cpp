@@ -1568,7 +1568,7 @@ void game_process_cheats(int k)
 			return;
 
 		ship *shipp = &Ships[Objects[objnum].instance];
-		shipp->ship_name[0] = '\0';
+		ship_rename(Objects[objnum].instance, "");
 		shipp->orders_accepted = (1<<NUM_COMM_ORDER_ITEMS)-1;
 
 		// Goober5000 - stolen from support ship creation
@@ -1578,7 +1578,7 @@ void game_process_cheats(int k)
 			sprintf(name, NOX("Volition Bravos %d"), ship_idx);
 			if ( (ship_name_lookup(name) == -1) && (ship_find_exited_ship_by_name(name) == -1) )
 			{
-				strcpy_s(shipp->ship_name, name);
+				ship_rename(Objects[objnum].instance, name);
 				break;
 			}
 
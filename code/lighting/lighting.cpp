@@ -20,6 +20,8 @@
 #include "model/modelrender.h"
 #include "render/3d.h"
 
+#include <algorithm>
+
 
 
 #define MAX_LIGHT_LEVELS 16
@@ -41,6 +43,14 @@ static int Light_in_shadow = 0;	// If true, this means we're in a shadow
 
 #define MIN_LIGHT 0.03f	// When light drops below this level, ignore it.  Must be non-zero! (1/32)
 
+// scene_lights only builds its light grid when there are at least this many point lights
+#define LIGHT_GRID_MIN_LIGHTS		32
+
+// Lights and filter spheres which cover more grid cells than this are not looked up cell by cell
+#define LIGHT_GRID_MAX_CELLS		64
+
+#define LIGHT_GRID_MIN_CELL_SIZE	50.0f
+
 
 static int Lighting_off = 0;
 
@@ -1100,6 +1110,154 @@ void scene_lights::addLight(const light *light_ptr)
 	if ( light_ptr->type == LT_DIRECTIONAL ) {
 		StaticLightIndices.push_back(AllLights.size() - 1);
 	}
+
+	LightGridValid = false;
+}
+
+static inline uint light_grid_bucket_key(int x, int y, int z)
+{
+	uint key = ((uint)x * 73856093u) ^ ((uint)y * 19349663u) ^ ((uint)z * 83492791u);
+
+	// cells which hash to the same key share a bucket, the lights in it are tested anyway
+	return (key == flat_hash_map<int>::EMPTY_KEY) ? 0 : key;
+}
+
+/**
+ * Gets the range of grid cells touched by a box, returns the number of cells
+ */
+static int light_grid_cells(const vec3d *mins, const vec3d *maxs, float cell_size, int *lo, int *hi)
+{
+	int count = 1;
+
+	for (int axis = 0; axis < 3; ++axis) {
+		lo[axis] = (int)floorf(mins->a1d[axis] / cell_size);
+		hi[axis] = (int)floorf(maxs->a1d[axis] / cell_size);
+
+		count *= MIN(hi[axis] - lo[axis] + 1, LIGHT_GRID_MAX_CELLS + 1);
+		count = MIN(count, LIGHT_GRID_MAX_CELLS + 1);
+	}
+
+	return count;
+}
+
+bool scene_lights::lightAffects(const light &l, int objnum, const vec3d *pos, float rad) const
+{
+	switch ( l.type ) {
+		case LT_POINT: {
+			// if this is a "unique" light source, it only affects one guy
+			if ( l.affected_objnum >= 0 && objnum != l.affected_objnum ) {
+				return false;
+			}
+
+			vec3d to_light;
+			float dist_squared, max_dist_squared;
+			vm_vec_sub( &to_light, &l.vec, pos );
+			dist_squared = vm_vec_mag_squared(&to_light);
+
+			max_dist_squared = l.radb+rad;
+			max_dist_squared *= max_dist_squared;
+
+			return dist_squared < max_dist_squared;
+		}
+
+		case LT_TUBE: {
+			if ( l.light_ignore_objnum == objnum ) {
+				return false;
+			}
+
+			vec3d nearest;
+			float dist_squared, max_dist_squared;
+			vm_vec_dist_squared_to_line(pos,&l.vec,&l.vec2,&nearest,&dist_squared);
+
+			max_dist_squared = l.radb+rad;
+			max_dist_squared *= max_dist_squared;
+
+			return dist_squared < max_dist_squared;
+		}
+
+		// directional lights are always set and cone lights are never filtered in
+		default:
+			return false;
+	}
+}
+
+void scene_lights::buildLightGrid()
+{
+	LightGridValid = true;
+	LightGridCellSize = 0.0f;
+	LightGridEntries.clear();
+	LightGridBuckets.clear();
+	LightGridUnbucketed.clear();
+	LightGridStamps.assign(AllLights.size(), 0);
+	LightGridQuery = 0;
+
+	size_t num_lights = 0;
+	float total_size = 0.0f;
+
+	for ( auto &l : AllLights ) {
+		if ( l.type == LT_POINT ) {
+			total_size += 2.0f * l.radb;
+			++num_lights;
+		}
+	}
+
+	if ( num_lights < LIGHT_GRID_MIN_LIGHTS ) {
+		return;
+	}
+
+	// cells as large as the average light so most lights only touch a few of them
+	LightGridCellSize = MAX(total_size / num_lights, LIGHT_GRID_MIN_CELL_SIZE);
+
+	SCP_vector<std::pair<uint, size_t>> cell_lights;
+
+	for ( size_t i = 0; i < AllLights.size(); ++i ) {
+		auto &l = AllLights[i];
+
+		// tube lights are tested against the distance to the whole line through their end points, which doesn't fit
+		// into any cell
+		if ( l.type == LT_TUBE ) {
+			LightGridUnbucketed.push_back(i);
+			continue;
+		} else if ( l.type != LT_POINT ) {
+			continue;
+		}
+
+		vec3d mins, maxs;
+		for ( int axis = 0; axis < 3; ++axis ) {
+			mins.a1d[axis] = l.vec.a1d[axis] - l.radb;
+			maxs.a1d[axis] = l.vec.a1d[axis] + l.radb;
+		}
+
+		int lo[3], hi[3];
+		if ( light_grid_cells(&mins, &maxs, LightGridCellSize, lo, hi) > LIGHT_GRID_MAX_CELLS ) {
+			LightGridUnbucketed.push_back(i);
+			continue;
+		}
+
+		for ( int x = lo[0]; x <= hi[0]; ++x ) {
+			for ( int y = lo[1]; y <= hi[1]; ++y ) {
+				for ( int z = lo[2]; z <= hi[2]; ++z ) {
+					cell_lights.emplace_back(light_grid_bucket_key(x, y, z), i);
+				}
+			}
+		}
+	}
+
+	std::sort(cell_lights.begin(), cell_lights.end());
+
+	LightGridEntries.reserve(cell_lights.size());
+	LightGridBuckets.reserve(cell_lights.size());
+
+	for ( auto &entry : cell_lights ) {
+		auto &bucket = LightGridBuckets[entry.first];
+
+		if ( bucket.count == 0 ) {
+			bucket.start = (int)LightGridEntries.size();
+		}
+
+		LightGridEntries.push_back(entry.second);
+		++bucket.count;
+	}
 }
 
 void scene_lights::setLightFilter(int objnum, const vec3d *pos, float rad)
@@ -1109,64 +1267,64 @@ void scene_lights::setLightFilter(int objnum, const vec3d *pos, float rad)
 	// clear out current filtered lights
 	FilteredLights.clear();
 
-	for ( i = 0; i < AllLights.size(); ++i ) {
-		light& l = AllLights[i];
+	if ( !LightGridValid ) {
+		buildLightGrid();
+	}
 
-		switch ( l.type ) {
-			case LT_DIRECTIONAL:
-				break;
-			case LT_POINT: {
-				// if this is a "unique" light source, it only affects one guy
-				if ( l.affected_objnum >= 0 ) {
-					if ( objnum == l.affected_objnum ) {
-						vec3d to_light;
-						float dist_squared, max_dist_squared;
-						vm_vec_sub( &to_light, &l.vec, pos );
-						dist_squared = vm_vec_mag_squared(&to_light);
+	int lo[3], hi[3];
 
-						max_dist_squared = l.radb+rad;
-						max_dist_squared *= max_dist_squared;
+	if ( LightGridCellSize > 0.0f ) {
+		vec3d mins, maxs;
 
-						if ( dist_squared < max_dist_squared )	{
-							FilteredLights.push_back(i);
+		for ( int axis = 0; axis < 3; ++axis ) {
+			mins.a1d[axis] = pos->a1d[axis] - rad;
+			maxs.a1d[axis] = pos->a1d[axis] + rad;
+		}
+
+		if ( light_grid_cells(&mins, &maxs, LightGridCellSize, lo, hi) <= LIGHT_GRID_MAX_CELLS ) {
+			// a light which overlaps the sphere shares at least one cell with it
+			if ( ++LightGridQuery == 0 ) {
+				std::fill(LightGridStamps.begin(), LightGridStamps.end(), 0);
+				LightGridQuery = 1;
+			}
+
+			for ( int x = lo[0]; x <= hi[0]; ++x ) {
+				for ( int y = lo[1]; y <= hi[1]; ++y ) {
+					for ( int z = lo[2]; z <= hi[2]; ++z ) {
+						auto bucket = LightGridBuckets.find(light_grid_bucket_key(x, y, z));
+
+						if ( bucket == nullptr ) {
+							continue;
 						}
-					}
-				} else { // otherwise check all relevant objects
-					vec3d to_light;
-					float dist_squared, max_dist_squared;
-					vm_vec_sub( &to_light, &l.vec, pos );
-					dist_squared = vm_vec_mag_squared(&to_light);
 
-					max_dist_squared = l.radb+rad;
-					max_dist_squared *= max_dist_squared;
+						for ( int j = bucket->start; j < bucket->start + bucket->count; ++j ) {
+							auto index = LightGridEntries[j];
 
-					if ( dist_squared < max_dist_squared )	{
-						FilteredLights.push_back(i);
+							if ( LightGridStamps[index] != LightGridQuery ) {
+								LightGridStamps[index] = LightGridQuery;
+								FilteredLights.push_back(index);
+							}
+						}
 					}
 				}
 			}
-			break;
-			case LT_TUBE: {
-				if ( l.light_ignore_objnum != objnum ) {
-					vec3d nearest;
-					float dist_squared, max_dist_squared;
-					vm_vec_dist_squared_to_line(pos,&l.vec,&l.vec2,&nearest,&dist_squared);
 
-					max_dist_squared = l.radb+rad;
-					max_dist_squared *= max_dist_squared;
+			FilteredLights.insert(FilteredLights.end(), LightGridUnbucketed.begin(), LightGridUnbucketed.end());
 
-					if ( dist_squared < max_dist_squared ) {
-						FilteredLights.push_back(i);
-					}
-				}
-			}
-			break;
+			// keep the lights in the order they were added, like the full scan below
+			std::sort(FilteredLights.begin(), FilteredLights.end());
 
-			case LT_CONE:
-				break;
+			FilteredLights.erase(std::remove_if(FilteredLights.begin(), FilteredLights.end(), [&](size_t index) {
+				return !lightAffects(AllLights[index], objnum, pos, rad);
+			}), FilteredLights.end());
 
-			default:
-				break;
+			return;
+		}
+	}
+
+	for ( i = 0; i < AllLights.size(); ++i ) {
+		if ( lightAffects(AllLights[i], objnum, pos, rad) ) {
+			FilteredLights.push_back(i);
 		}
 	}
 }
@@ -12,6 +12,9 @@
 #ifndef _LIGHTING_H
 #define _LIGHTING_H
 
+#include "globalincs/pstypes.h"
+#include "utils/flat_hash_map.h"
+
 // Light stuff works like this:
 // At the start of the frame, call light_reset.
 // For each light source, call light_add_??? functions.
@@ -58,6 +61,12 @@ struct light_indexing_info
 
 class scene_lights
 {
+	struct light_grid_bucket
+	{
+		int start = 0;
+		int count = 0;
+	};
+
 	SCP_vector<light> AllLights;
 	
 	SCP_vector<size_t> StaticLightIndices;
@@ -66,10 +75,23 @@ class scene_lights
 
 	SCP_vector<size_t> BufferedLights;
 
+	// Hash grid over the point lights, built by the first setLightFilter() after lights were added so that
+	// each filter only has to test the lights around the object instead of all of them
+	bool LightGridValid;
+	float LightGridCellSize;
+	SCP_vector<size_t> LightGridEntries;		// light indices sorted by bucket
+	flat_hash_map<light_grid_bucket> LightGridBuckets;
+	SCP_vector<size_t> LightGridUnbucketed;		// tube lights and lights which cover too many cells, tested by every filter
+	SCP_vector<uint> LightGridStamps;			// per light, the last filter which found it in a bucket
+	uint LightGridQuery;
+
 	size_t current_light_index;
 	size_t current_num_lights;
+
+	void buildLightGrid();
+	bool lightAffects(const light &l, int objnum, const vec3d *pos, float rad) const;
 public:
-	scene_lights()
+	scene_lights() : LightGridValid(false), LightGridCellSize(0.0f), LightGridQuery(0)
 	{
 		resetLightState();
 	}
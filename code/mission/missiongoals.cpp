@@ -371,6 +371,7 @@ void mission_init_goals()
 		Mission_goals[i].satisfied = GOAL_INCOMPLETE;
 		Mission_goals[i].flags = 0;
 		Mission_goals[i].team = 0;
+		sexp_dependencies_reset(&Mission_goals[i].dependencies);
 	}
 
 	Num_mission_events = 0;
@@ -382,6 +383,7 @@ void mission_init_goals()
 		Mission_events[i].born_on_date = 0;
 		Mission_events[i].team = -1;
 		Mission_events[i].mission_log_flags = 0;
+		sexp_dependencies_reset(&Mission_events[i].dependencies);
 	}
 
 	Mission_goal_timestamp = timestamp(GOAL_TIMESTAMP);
@@ -920,6 +922,14 @@ void mission_process_event( int event )
 		}
 	}
 
+	// a false condition which only depends on the mission log can't have become true if nothing was logged since.
+	// directives and logged events always need the evaluation for their bookkeeping.
+	if ((sindex >= 0) && (result == SEXP_FALSE) && !Mission_events[event].objective_text && !Snapshot_all_events && (Mission_events[event].mission_log_flags == 0)) {
+		if (sexp_dependencies_unchanged(&Mission_events[event].dependencies, sindex)) {
+			sindex = -1;  // bypass evaluation
+		}
+	}
+
 	if (sindex >= 0) {
 		Sexp_useful_number = 1;
 		if (Snapshot_all_events || Mission_events[event].mission_log_flags != 0) {
@@ -930,6 +940,7 @@ void mission_process_event( int event )
 			Current_event_log_argument_buffer = &Mission_events[event].event_log_argument_buffer;
 		}
 		result = eval_sexp(sindex);
+		sexp_dependencies_evaluated(&Mission_events[event].dependencies, result);
 
 		// if the directive count is a special value, deal with that first.  Mark the event as a special
 		// event, and unmark it when the directive is true again.
@@ -1064,7 +1075,12 @@ void mission_eval_goals()
 		}
 
 		if (Mission_goals[i].satisfied == GOAL_INCOMPLETE) {
+			if (sexp_dependencies_unchanged(&Mission_goals[i].dependencies, Mission_goals[i].formula)) {
+				continue;
+			}
+
 			result = eval_sexp(Mission_goals[i].formula);
+			sexp_dependencies_evaluated(&Mission_goals[i].dependencies, result);
 			if ( Sexp_nodes[Mission_goals[i].formula].value == SEXP_KNOWN_FALSE ) {
 				mission_goal_status_change( i, GOAL_FAILED );
 
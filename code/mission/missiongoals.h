@@ -14,6 +14,7 @@
 
 #include "globalincs/globals.h"
 #include "globalincs/pstypes.h"
+#include "parse/sexp.h"
 
 struct ai_goal;
 struct ai_info;
@@ -61,6 +62,7 @@ typedef struct mission_goal {
 	int	score;							// score for this goal
 	int	flags;							// MGF_
 	int	team;								// which team is this objective for.
+	sexp_dependencies dependencies;		// used to skip evaluating the formula when nothing it depends on has changed
 } mission_goal;
 
 extern mission_goal Mission_goals[MAX_GOALS];	// structure for the goals of this mission
@@ -123,6 +125,7 @@ typedef struct mission_event {
 	SCP_vector<SCP_string> event_log_argument_buffer;
 	SCP_vector<SCP_string> backup_log_buffer;
 	int	previous_result;		// result of previous evaluation of event
+	sexp_dependencies dependencies;	// used to skip evaluating the formula when nothing it depends on has changed
 
 } mission_event;
 
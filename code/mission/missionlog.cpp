@@ -21,6 +21,7 @@
 #include "network/multimsgs.h"
 #include "network/multiutil.h"
 #include "parse/parselo.h"
+#include "parse/sexp.h"
 #include "playerman/player.h"
 #include "ship/ship.h"
 
@@ -192,6 +193,9 @@ void mission_log_add_entry(int type, const char *pname, const char *sname, int i
 		return;
 	}
 
+	// formulas skipped because their log inputs were unchanged have to look again
+	sexp_mark_log_changed();
+
 	last_entry_save = last_entry;
 
 	// mark any entries as obsolete.  Part of the pruning is done based on the type (and name) passed
@@ -398,6 +402,8 @@ void mission_log_add_entry_multi( int type, const char *pname, const char *sname
 	Assert ( Game_mode & GM_MULTIPLAYER );
 	Assert ( !(Net_player->flags & NETINFO_FLAG_AM_MASTER) );
 
+	sexp_mark_log_changed();
+
 	// mark any entries as obsolete.  Part of the pruning is done based on the type (and name) passed
 	// for a new entry
 	mission_log_obsolete_entries(type, pname);
@@ -240,10 +240,34 @@ struct bsp_collision_leaf {
 	int next;
 };
 
+// Four bounding boxes in structure of arrays layout so that a ray can be tested against all of them at once
+struct bsp_collision_box4 {
+	float min[3][4];
+	float max[3][4];
+};
+
+// Two levels of the BSP node tree collapsed into one node. The children of a BSP node are stored in lanes 0 (back) and 1
+// (front) of children, their own back and front children are stored in lanes 0-1 and 2-3 of grandchildren.
+struct bsp_collision_wide_node {
+	bsp_collision_box4 children;
+	bsp_collision_box4 grandchildren;
+
+	int child_leaf[2];			// leaf list of a child, -1 if it has none
+	int grandchild_leaf[4];		// leaf list of a grandchild, -1 if it has none
+	int grandchild_node[4];		// wide node which continues below a grandchild, -1 if there is none
+
+	ubyte child_mask;			// lanes of children which hold a box
+	ubyte grandchild_mask;		// lanes of grandchildren which hold a box
+};
+
 struct bsp_collision_tree {
 	bsp_collision_node *node_list;
 	int n_nodes;
 
+	// flattened copy of node_list used for traversing the tree, the first node holds the children of the root node
+	bsp_collision_wide_node *wide_node_list;
+	int n_wide_nodes;
+
 	bsp_collision_leaf *leaf_list;
 	int n_leaves;
 
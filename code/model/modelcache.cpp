@@ -0,0 +1,245 @@
+#include "cfile/cfile.h"
+#include "cmdline/cmdline.h"
+#include "globalincs/version.h"
+#include "model/model.h"
+#include "model/modelcache.h"
+#include "parse/parselo.h"
+#include "tracing/tracing.h"
+
+namespace {
+
+// Bump this whenever model_collide_parse_bsp() builds different trees, older cache files are then ignored
+const int MODEL_CACHE_VERSION = 1;
+
+const char MODEL_CACHE_MAGIC[4] = { 'F', 'S', 'M', 'C' };
+
+// The file starts with this header, then the submodels follow in order. Everything is written in the native layout of
+// the build so loading it is nothing more than copying the arrays out of the file.
+struct model_cache_header {
+	char magic[4];
+	int cache_version;
+	int engine_version[4];
+	uint pof_checksum;
+	int pof_version;
+	int n_models;
+	int struct_sizes[5];		// sizes of the tree structures, catches builds which lay them out differently
+};
+
+// Followed by the node, wide node, leaf, point and vert lists of the tree
+struct model_cache_tree_header {
+	int n_nodes;
+	int n_wide_nodes;
+	int n_leaves;
+	int n_points;
+	int n_verts;
+};
+
+struct model_cache_reader {
+	const ubyte *p;
+	const ubyte *end;
+
+	bool read(void *dest, size_t size)
+	{
+		if ((size_t)(end - p) < size) {
+			return false;
+		}
+
+		memcpy(dest, p, size);
+		p += size;
+
+		return true;
+	}
+
+	template<typename T>
+	bool read_list(T **list, int count)
+	{
+		*list = nullptr;
+
+		if (count <= 0) {
+			return count == 0;
+		}
+
+		size_t size = sizeof(T) * count;
+		if ((size_t)(end - p) < size) {
+			return false;
+		}
+
+		*list = (T*)vm_malloc(size);
+		memcpy(*list, p, size);
+		p += size;
+
+		return true;
+	}
+};
+
+SCP_string model_cache_filename(const char *pof_filename)
+{
+	SCP_string name = pof_filename;
+	drop_extension(name);
+
+	return "model_cache-" + name + ".bin";
+}
+
+void model_cache_fill_header(model_cache_header *header, const polymodel *pm, uint pof_checksum)
+{
+	memset(header, 0, sizeof(*header));
+
+	memcpy(header->magic, MODEL_CACHE_MAGIC, sizeof(header->magic));
+	header->cache_version = MODEL_CACHE_VERSION;
+
+	header->engine_version[0] = FS_VERSION_MAJOR;
+	header->engine_version[1] = FS_VERSION_MINOR;
+	header->engine_version[2] = FS_VERSION_BUILD;
+	header->engine_version[3] = FS_VERSION_REVIS;
+
+	header->pof_checksum = pof_checksum;
+	header->pof_version = pm->version;
+	header->n_models = pm->n_models;
+
+	header->struct_sizes[0] = (int)sizeof(bsp_collision_node);
+	header->struct_sizes[1] = (int)sizeof(bsp_collision_wide_node);
+	header->struct_sizes[2] = (int)sizeof(bsp_collision_leaf);
+	header->struct_sizes[3] = (int)sizeof(vec3d);
+	header->struct_sizes[4] = (int)sizeof(model_tmap_vert);
+}
+
+// The tree doesn't keep the length of its vert list, the leaves reference all of it
+int model_cache_count_verts(const bsp_collision_tree *tree)
+{
+	int n_verts = 0;
+
+	for (int i = 0; i < tree->n_leaves; ++i) {
+		n_verts = MAX(n_verts, tree->leaf_list[i].vert_start + tree->leaf_list[i].num_verts);
+	}
+
+	return n_verts;
+}
+
+bool model_cache_read_tree(model_cache_reader *reader, bsp_collision_tree *tree)
+{
+	model_cache_tree_header tree_header;
+
+	tree->node_list = nullptr;
+	tree->wide_node_list = nullptr;
+	tree->leaf_list = nullptr;
+	tree->point_list = nullptr;
+	tree->vert_list = nullptr;
+
+	tree->n_nodes = 0;
+	tree->n_wide_nodes = 0;
+	tree->n_leaves = 0;
+	tree->n_verts = 0;
+
+	if (!reader->read(&tree_header, sizeof(tree_header))) {
+		return false;
+	}
+
+	tree->n_nodes = tree_header.n_nodes;
+	tree->n_wide_nodes = tree_header.n_wide_nodes;
+	tree->n_leaves = tree_header.n_leaves;
+	tree->n_verts = tree_header.n_points;
+
+	return reader->read_list(&tree->node_list, tree_header.n_nodes)
+		&& reader->read_list(&tree->wide_node_list, tree_header.n_wide_nodes)
+		&& reader->read_list(&tree->leaf_list, tree_header.n_leaves)
+		&& reader->read_list(&tree->point_list, tree_header.n_points)
+		&& reader->read_list(&tree->vert_list, tree_header.n_verts);
+}
+
+void model_cache_write_tree(CFILE *fp, const bsp_collision_tree *tree)
+{
+	model_cache_tree_header tree_header;
+
+	tree_header.n_nodes = (tree->node_list != nullptr) ? tree->n_nodes : 0;
+	tree_header.n_wide_nodes = (tree->wide_node_list != nullptr) ? tree->n_wide_nodes : 0;
+	tree_header.n_leaves = (tree->leaf_list != nullptr) ? tree->n_leaves : 0;
+	tree_header.n_points = (tree->point_list != nullptr) ? tree->n_verts : 0;
+	tree_header.n_verts = (tree->vert_list != nullptr) ? model_cache_count_verts(tree) : 0;
+
+	cfwrite(&tree_header, sizeof(tree_header), 1, fp);
+
+	cfwrite(tree->node_list, sizeof(bsp_collision_node), tree_header.n_nodes, fp);
+	cfwrite(tree->wide_node_list, sizeof(bsp_collision_wide_node), tree_header.n_wide_nodes, fp);
+	cfwrite(tree->leaf_list, sizeof(bsp_collision_leaf), tree_header.n_leaves, fp);
+	cfwrite(tree->point_list, sizeof(vec3d), tree_header.n_points, fp);
+	cfwrite(tree->vert_list, sizeof(model_tmap_vert), tree_header.n_verts, fp);
+}
+
+}
+
+bool model_cache_load_collision_trees(polymodel *pm, uint pof_checksum)
+{
+	if (Cmdline_nomodelcache) {
+		return false;
+	}
+
+	auto fp = cfopen(model_cache_filename(pm->filename).c_str(), "rb", CFILE_MEMORY_MAPPED, CF_TYPE_CACHE);
+	if (fp == nullptr) {
+		nprintf(("ModelCache", "No cache file for model '%s'.\n", pm->filename));
+		return false;
+	}
+
+	TRACE_SCOPE(tracing::ModelLoadCachedBSPTrees);
+
+	auto data = (const ubyte*)cf_returndata(fp);
+
+	model_cache_reader reader;
+	reader.p = data;
+	reader.end = (data != nullptr) ? data + cfilelength(fp) : nullptr;
+
+	model_cache_header header, expected;
+	model_cache_fill_header(&expected, pm, pof_checksum);
+
+	bool valid = (data != nullptr) && reader.read(&header, sizeof(header)) && !memcmp(&header, &expected, sizeof(header));
+
+	SCP_vector<int> trees;
+
+	for (int i = 0; valid && (i < pm->n_models); ++i) {
+		int tree_index = model_create_bsp_collision_tree();
+		trees.push_back(tree_index);
+
+		valid = model_cache_read_tree(&reader, model_get_bsp_collision_tree(tree_index));
+	}
+
+	cfclose(fp);
+
+	if (!valid) {
+		mprintf(("Model cache file for '%s' is outdated, rebuilding it.\n", pm->filename));
+
+		for (auto tree_index : trees) {
+			model_remove_bsp_collision_tree(tree_index);
+		}
+
+		return false;
+	}
+
+	for (int i = 0; i < pm->n_models; ++i) {
+		pm->submodel[i].collision_tree_index = trees[i];
+	}
+
+	return true;
+}
+
+void model_cache_save_collision_trees(const polymodel *pm, uint pof_checksum)
+{
+	if (Cmdline_nomodelcache) {
+		return;
+	}
+
+	auto fp = cfopen(model_cache_filename(pm->filename).c_str(), "wb", CFILE_NORMAL, CF_TYPE_CACHE);
+	if (fp == nullptr) {
+		mprintf(("Could not open model cache file for '%s'!\n", pm->filename));
+		return;
+	}
+
+	model_cache_header header;
+	model_cache_fill_header(&header, pm, pof_checksum);
+
+	cfwrite(&header, sizeof(header), 1, fp);
+
+	for (int i = 0; i < pm->n_models; ++i) {
+		model_cache_write_tree(fp, model_get_bsp_collision_tree(pm->submodel[i].collision_tree_index));
+	}
+
+	cfclose(fp);
+}
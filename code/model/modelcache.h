@@ -0,0 +1,37 @@
+#ifndef _MODELCACHE_H
+#define _MODELCACHE_H
+
+#include "globalincs/pstypes.h"
+
+class polymodel;
+
+/**
+ * Cooked model cache
+ *
+ * Converting the BSP data of every submodel into a collision tree takes a good part of the time it takes to load a
+ * model. The trees only depend on the POF and the engine, so they are stored in the cache directory after the first
+ * load and read back on later loads of the same POF.
+ *
+ * A cache file is only used if the checksum and version of the POF, the engine version and the layout of the tree
+ * structures all match the ones it was written with. Otherwise the trees are built from the BSP data again and the
+ * file is overwritten.
+ */
+
+/**
+ * @brief Loads the collision trees of all submodels from the cache
+ *
+ * @param pm The model, read_model_file() must have been run on it
+ * @param pof_checksum The checksum of the POF file
+ * @return @c true if the collision_tree_index of every submodel has been set, @c false if there is no usable cache file
+ */
+bool model_cache_load_collision_trees(polymodel *pm, uint pof_checksum);
+
+/**
+ * @brief Writes the collision trees of all submodels to the cache
+ *
+ * @param pm The model, every submodel must have a collision tree
+ * @param pof_checksum The checksum of the POF file
+ */
+void model_cache_save_collision_trees(const polymodel *pm, uint pof_checksum);
+
+#endif
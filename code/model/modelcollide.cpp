@@ -20,6 +20,12 @@
 #include "model/modelsinc.h"
 #include "tracing/tracing.h"
 #include "tracing/Monitor.h"
+#include "utils/threading.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MC_USE_SSE2
+#include <emmintrin.h>
+#endif
 
 
 
@@ -28,27 +34,31 @@
 
 // Some global variables that get set by model_collide and are used internally for
 // checking a collision rather than passing a bunch of parameters around. These are
-// not persistant between calls to model_collide
+// not persistant between calls to model_collide. They are thread local so that the
+// collision detection pass can run model_collide on the worker threads.
 
-static mc_info		*Mc;				// The mc_info passed into model_collide
+static thread_local mc_info		*Mc;				// The mc_info passed into model_collide
 	
-static polymodel	*Mc_pm;			// The polygon model we're checking
-static int			Mc_submodel;	// The current submodel we're checking
+static thread_local polymodel	*Mc_pm;			// The polygon model we're checking
+static thread_local int			Mc_submodel;	// The current submodel we're checking
 
-static polymodel_instance *Mc_pmi;
+static thread_local polymodel_instance *Mc_pmi;
 
-static matrix		Mc_orient;		// A matrix to rotate a world point into the current
+static thread_local matrix		Mc_orient;		// A matrix to rotate a world point into the current
 											// submodel's frame of reference.
-static vec3d		Mc_base;			// A point used along with Mc_orient.
+static thread_local vec3d		Mc_base;			// A point used along with Mc_orient.
 
-static vec3d		Mc_p0;			// The ray origin rotated into the current submodel's frame of reference
-static vec3d		Mc_p1;			// The ray end rotated into the current submodel's frame of reference
-static float		Mc_mag;			// The length of the ray
-static vec3d		Mc_direction;	// A vector from the ray's origin to its end, in the current submodel's frame of reference
+static thread_local vec3d		Mc_p0;			// The ray origin rotated into the current submodel's frame of reference
+static thread_local vec3d		Mc_p1;			// The ray end rotated into the current submodel's frame of reference
+static thread_local float		Mc_mag;			// The length of the ray
+static thread_local vec3d		Mc_direction;	// A vector from the ray's origin to its end, in the current submodel's frame of reference
 
+// Only used by the old collision system and when parsing the BSP data, neither of which is done on worker threads
 static vec3d 		**Mc_point_list = NULL;		// A pointer to the current submodel's vertex list
 
-static float		Mc_edge_time;
+static thread_local float		Mc_edge_time;
+
+static thread_local SCP_vector<int> Mc_bsp_stack;	// Nodes of the BSP tree which still have to be visited
 
 
 void model_collide_free_point_list()
@@ -622,27 +632,220 @@ void model_collide_bsp_poly(bsp_collision_tree *tree, int leaf_index)
 	}
 }
 
-void model_collide_bsp(bsp_collision_tree *tree, int node_index)
+// Tests the ray against the boxes in the given lanes. Returns a mask of the lanes which were hit, the hit positions are
+// only valid for those lanes. Every lane gives exactly the same result as mc_ray_boundingbox().
+static int mc_ray_boundingbox4(const bsp_collision_box4 *boxes, int lanes, vec3d hitpos[4])
+{
+#ifdef MC_USE_SSE2
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 all_set = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+	__m128 mins[3], maxs[3], p0[3], pdir[3], candidate_plane[3], maxt[3];
+	__m128 outside = zero;
+
+	for (int i = 0; i < 3; i++) {
+		mins[i] = _mm_loadu_ps(boxes->min[i]);
+		maxs[i] = _mm_loadu_ps(boxes->max[i]);
+
+		if ( Mc->flags & MC_CHECK_SPHERELINE ) {
+			// In the case of a sphere, just increase the size of the box by the radius
+			// of the sphere in all directions.
+			mins[i] = _mm_sub_ps(mins[i], _mm_set1_ps(Mc->radius));
+			maxs[i] = _mm_add_ps(maxs[i], _mm_set1_ps(Mc->radius));
+		}
+
+		p0[i] = _mm_set1_ps(Mc_p0.a1d[i]);
+		pdir[i] = _mm_set1_ps(Mc_direction.a1d[i]);
+
+		__m128 below = _mm_cmplt_ps(p0[i], mins[i]);
+		__m128 above = _mm_andnot_ps(below, _mm_cmpgt_ps(p0[i], maxs[i]));
+
+		candidate_plane[i] = _mm_or_ps(_mm_and_ps(below, mins[i]), _mm_and_ps(above, maxs[i]));
+
+		__m128 axis_outside = _mm_or_ps(below, above);
+		outside = _mm_or_ps(outside, axis_outside);
+
+		// the direction is the same for all lanes so only divide if it can be used at all
+		if ( Mc_direction.a1d[i] == 0.0f ) {
+			maxt[i] = _mm_set1_ps(-1.0f);
+		} else {
+			__m128 t = _mm_div_ps(_mm_sub_ps(candidate_plane[i], p0[i]), pdir[i]);
+			maxt[i] = _mm_or_ps(_mm_and_ps(axis_outside, t), _mm_andnot_ps(axis_outside, _mm_set1_ps(-1.0f)));
+		}
+	}
+
+	// Get largest of the maxt's for final choice of intersection, ties go to the lowest axis
+	__m128 plane1 = _mm_cmplt_ps(maxt[0], maxt[1]);
+	__m128 best = _mm_or_ps(_mm_and_ps(plane1, maxt[1]), _mm_andnot_ps(plane1, maxt[0]));
+	__m128 plane2 = _mm_cmplt_ps(best, maxt[2]);
+	best = _mm_or_ps(_mm_and_ps(plane2, maxt[2]), _mm_andnot_ps(plane2, best));
+
+	__m128 which_plane[3];
+	which_plane[0] = _mm_andnot_ps(_mm_or_ps(plane1, plane2), all_set);
+	which_plane[1] = _mm_andnot_ps(plane2, plane1);
+	which_plane[2] = plane2;
+
+	// check final candidate actually inside box
+	__m128 missed = _mm_cmplt_ps(best, zero);
+	__m128 hit[3];
+
+	for (int i = 0; i < 3; i++) {
+		__m128 h = _mm_add_ps(_mm_mul_ps(best, pdir[i]), p0[i]);
+		__m128 out = _mm_or_ps(_mm_cmplt_ps(h, mins[i]), _mm_cmpgt_ps(h, maxs[i]));
+
+		missed = _mm_or_ps(missed, _mm_andnot_ps(which_plane[i], out));
+
+		hit[i] = _mm_or_ps(_mm_and_ps(which_plane[i], candidate_plane[i]), _mm_andnot_ps(which_plane[i], h));
+
+		// ray origin inside bounding box
+		hit[i] = _mm_or_ps(_mm_and_ps(outside, hit[i]), _mm_andnot_ps(outside, p0[i]));
+	}
+
+	int result = lanes & (~_mm_movemask_ps(_mm_and_ps(outside, missed)));
+
+	if ( result ) {
+		float hit_axis[3][4];
+
+		for (int i = 0; i < 3; i++) {
+			_mm_storeu_ps(hit_axis[i], hit[i]);
+		}
+
+		for (int lane = 0; lane < 4; lane++) {
+			hitpos[lane].xyz.x = hit_axis[0][lane];
+			hitpos[lane].xyz.y = hit_axis[1][lane];
+			hitpos[lane].xyz.z = hit_axis[2][lane];
+		}
+	}
+
+	return result;
+#else
+	int result = 0;
+
+	for (int lane = 0; lane < 4; lane++) {
+		if ( !(lanes & (1<<lane)) ) {
+			continue;
+		}
+
+		vec3d min, max;
+
+		for (int i = 0; i < 3; i++) {
+			min.a1d[i] = boxes->min[i][lane];
+			max.a1d[i] = boxes->max[i][lane];
+		}
+
+		if ( mc_ray_boundingbox( &min, &max, &Mc_p0, &Mc_direction, &hitpos[lane] ) ) {
+			result |= (1<<lane);
+		}
+	}
+
+	return result;
+#endif
+}
+
+// Returns the mask of the lanes whose box is hit by the ray, including the check that the ray is long enough
+static int model_collide_bsp_boxes(const bsp_collision_box4 *boxes, int lanes)
+{
+	vec3d hitpos[4];
+	int result = mc_ray_boundingbox4(boxes, lanes, hitpos);
+
+	if ( result && !(Mc->flags & MC_CHECK_RAY) ) {
+		for (int lane = 0; lane < 4; lane++) {
+			if ( (result & (1<<lane)) && (vm_vec_dist(&hitpos[lane], &Mc_p0) > Mc_mag) ) {
+				// The ray isn't long enough to intersect the bounding box
+				result &= ~(1<<lane);
+			}
+		}
+	}
+
+	return result;
+}
+
+void model_collide_bsp(bsp_collision_tree *tree)
 {
 	if ( tree->node_list == NULL || tree->n_verts <= 0) {
 		return;
 	}
 
-	bsp_collision_node *node = &tree->node_list[node_index];
+	bsp_collision_node *node = &tree->node_list[0];
 	vec3d hitpos;
 
-	// check the bounding box of this node. if it passes, check left and right children
-	if ( mc_ray_boundingbox( &node->min, &node->max, &Mc_p0, &Mc_direction, &hitpos ) ) {
-		if ( !(Mc->flags & MC_CHECK_RAY) && (vm_vec_dist(&hitpos, &Mc_p0) > Mc_mag) ) {
-			// The ray isn't long enough to intersect the bounding box
-			return;
+	// check the bounding box of the root node. if it passes, check the rest of the tree
+	if ( !mc_ray_boundingbox( &node->min, &node->max, &Mc_p0, &Mc_direction, &hitpos ) ) {
+		return;
+	}
+
+	if ( !(Mc->flags & MC_CHECK_RAY) && (vm_vec_dist(&hitpos, &Mc_p0) > Mc_mag) ) {
+		// The ray isn't long enough to intersect the bounding box
+		return;
+	}
+
+	if ( node->leaf >= 0 ) {
+		model_collide_bsp_poly(tree, node->leaf);
+		return;
+	}
+
+	if ( tree->n_wide_nodes <= 0 ) {
+		return;
+	}
+
+	// Entries >= 0 are wide nodes, negative entries are leaf lists which are stored as -(leaf + 1). Entries are pushed
+	// in reverse order so that polygons are checked in the same order as a depth first traversal which visits the back
+	// child of a node before the front child.
+	SCP_vector<int> &stack = Mc_bsp_stack;
+	stack.clear();
+	stack.push_back(0);
+
+	while ( !stack.empty() ) {
+		int entry = stack.back();
+		stack.pop_back();
+
+		if ( entry < 0 ) {
+			model_collide_bsp_poly(tree, -entry - 1);
+			continue;
 		}
 
-		if ( node->leaf >= 0 ) {
-			model_collide_bsp_poly(tree, node->leaf);
-		} else {
-			if ( node->back >= 0 ) model_collide_bsp(tree, node->back);
-			if ( node->front >= 0 ) model_collide_bsp(tree, node->front);
+		bsp_collision_wide_node *wide = &tree->wide_node_list[entry];
+
+		int child_hits = model_collide_bsp_boxes(&wide->children, wide->child_mask);
+
+		if ( !child_hits ) {
+			continue;
+		}
+
+		// only the grandchildren of children which have been hit need to be checked
+		int grandchild_lanes = wide->grandchild_mask;
+
+		if ( !(child_hits & (1<<0)) ) {
+			grandchild_lanes &= ~((1<<0) | (1<<1));
+		}
+
+		if ( !(child_hits & (1<<1)) ) {
+			grandchild_lanes &= ~((1<<2) | (1<<3));
+		}
+
+		int grandchild_hits = grandchild_lanes ? model_collide_bsp_boxes(&wide->grandchildren, grandchild_lanes) : 0;
+
+		for (int child = 1; child >= 0; child--) {
+			if ( !(child_hits & (1<<child)) ) {
+				continue;
+			}
+
+			if ( wide->child_leaf[child] >= 0 ) {
+				stack.push_back(-wide->child_leaf[child] - 1);
+				continue;
+			}
+
+			for (int lane = child * 2 + 1; lane >= child * 2; lane--) {
+				if ( !(grandchild_hits & (1<<lane)) ) {
+					continue;
+				}
+
+				if ( wide->grandchild_leaf[lane] >= 0 ) {
+					stack.push_back(-wide->grandchild_leaf[lane] - 1);
+				} else {
+					stack.push_back(wide->grandchild_node[lane]);
+				}
+			}
 		}
 	}
 }
@@ -730,6 +933,83 @@ void model_collide_parse_bsp_flatpoly(bsp_collision_leaf *leaf, SCP_vector<model
 	}
 }
 
+static void model_collide_set_box4(bsp_collision_box4 *boxes, int lane, const bsp_collision_node *node)
+{
+	for (int i = 0; i < 3; i++) {
+		boxes->min[i][lane] = node->min.a1d[i];
+		boxes->max[i][lane] = node->max.a1d[i];
+	}
+}
+
+// Collapses the children and grandchildren of a BSP node into a wide node and returns its index
+static int model_collide_build_wide_node(SCP_vector<bsp_collision_wide_node> &wide_buffer, const SCP_vector<bsp_collision_node> &node_buffer, int node_index)
+{
+	bsp_collision_wide_node new_wide;
+
+	memset(&new_wide, 0, sizeof(new_wide));
+
+	for (int lane = 0; lane < 4; lane++) {
+		new_wide.grandchild_leaf[lane] = -1;
+		new_wide.grandchild_node[lane] = -1;
+	}
+
+	new_wide.child_leaf[0] = -1;
+	new_wide.child_leaf[1] = -1;
+
+	int wide_index = (int)wide_buffer.size();
+	wide_buffer.push_back(new_wide);
+
+	const bsp_collision_node *node = &node_buffer[node_index];
+	int children[2] = { node->back, node->front };
+
+	for (int child = 0; child < 2; child++) {
+		if ( children[child] < 0 ) {
+			continue;
+		}
+
+		const bsp_collision_node *child_node = &node_buffer[children[child]];
+
+		if ( child_node->leaf >= 0 ) {
+			model_collide_set_box4(&wide_buffer[wide_index].children, child, child_node);
+			wide_buffer[wide_index].child_mask |= (1<<child);
+			wide_buffer[wide_index].child_leaf[child] = child_node->leaf;
+			continue;
+		}
+
+		int grandchildren[2] = { child_node->back, child_node->front };
+
+		for (int grandchild = 0; grandchild < 2; grandchild++) {
+			if ( grandchildren[grandchild] < 0 ) {
+				continue;
+			}
+
+			const bsp_collision_node *grandchild_node = &node_buffer[grandchildren[grandchild]];
+			int lane = child * 2 + grandchild;
+
+			// boxes without polygons below them can't produce a hit so they are left out entirely
+			if ( grandchild_node->leaf >= 0 ) {
+				wide_buffer[wide_index].grandchild_leaf[lane] = grandchild_node->leaf;
+			} else if ( grandchild_node->back >= 0 || grandchild_node->front >= 0 ) {
+				// may reallocate the buffer so wide_buffer[wide_index] has to be looked up again afterwards
+				int next_wide = model_collide_build_wide_node(wide_buffer, node_buffer, grandchildren[grandchild]);
+				wide_buffer[wide_index].grandchild_node[lane] = next_wide;
+			} else {
+				continue;
+			}
+
+			model_collide_set_box4(&wide_buffer[wide_index].grandchildren, lane, grandchild_node);
+			wide_buffer[wide_index].grandchild_mask |= (1<<lane);
+		}
+
+		if ( wide_buffer[wide_index].grandchild_mask & (3<<(child * 2)) ) {
+			model_collide_set_box4(&wide_buffer[wide_index].children, child, child_node);
+			wide_buffer[wide_index].child_mask |= (1<<child);
+		}
+	}
+
+	return wide_index;
+}
+
 void model_collide_parse_bsp(bsp_collision_tree *tree, void *model_ptr, int version)
 {
 	TRACE_SCOPE(tracing::ModelParseBSPTree);
@@ -754,6 +1034,9 @@ void model_collide_parse_bsp(bsp_collision_tree *tree, void *model_ptr, int vers
 		tree->n_nodes = 0;
 		tree->node_list = NULL;
 
+		tree->n_wide_nodes = 0;
+		tree->wide_node_list = NULL;
+
 		tree->n_leaves = 0;
 		tree->leaf_list = NULL;
 
@@ -893,7 +1176,23 @@ void model_collide_parse_bsp(bsp_collision_tree *tree, void *model_ptr, int vers
 
 	tree->n_verts = n_verts;
 
-	// copy node info. this might be a good time to organize the nodes into a cache efficient tree layout.
+	// collapse pairs of tree levels into wide nodes which are laid out in the order they are traversed in
+	SCP_vector<bsp_collision_wide_node> wide_buffer;
+
+	if ( node_buffer[0].leaf < 0 && (node_buffer[0].back >= 0 || node_buffer[0].front >= 0) ) {
+		model_collide_build_wide_node(wide_buffer, node_buffer, 0);
+	}
+
+	tree->n_wide_nodes = (int)wide_buffer.size();
+
+	if ( wide_buffer.empty() ) {
+		tree->wide_node_list = NULL;
+	} else {
+		tree->wide_node_list = (bsp_collision_wide_node*)vm_malloc(sizeof(bsp_collision_wide_node) * wide_buffer.size());
+		memcpy(tree->wide_node_list, &wide_buffer[0], sizeof(bsp_collision_wide_node) * wide_buffer.size());
+	}
+
+	// copy node info.
 	tree->n_nodes = (int)node_buffer.size();
 	tree->node_list = (bsp_collision_node*)vm_malloc(sizeof(bsp_collision_node) * node_buffer.size());
 	memcpy(tree->node_list, &node_buffer[0], sizeof(bsp_collision_node) * node_buffer.size());
@@ -1147,9 +1446,9 @@ void mc_check_subobj( int mn )
 						}
 					}
 
-					model_collide_bsp(model_get_bsp_collision_tree(lod_sm->collision_tree_index), 0);
+					model_collide_bsp(model_get_bsp_collision_tree(lod_sm->collision_tree_index));
 				} else {
-					model_collide_bsp(model_get_bsp_collision_tree(sm->collision_tree_index), 0);
+					model_collide_bsp(model_get_bsp_collision_tree(sm->collision_tree_index));
 				}
 			}
 		}
@@ -1235,7 +1534,10 @@ int model_collide(mc_info *mc_info_obj)
 {
 	Mc = mc_info_obj;
 
-	MONITOR_INC(NumFVI,1);
+	// monitors aren't thread safe so calls from the collision detection workers are not counted
+	if (threading::is_main_thread()) {
+		MONITOR_INC(NumFVI,1);
+	}
 
 	Mc->num_hits = 0;				// How many collisions were found
 	Mc->shield_hit_tri = -1;	// Assume we won't hit any shield polygons
@@ -31,6 +31,7 @@
 #include "math/fvi.h"
 #include "math/vecmat.h"
 #include "model/model.h"
+#include "model/modelcache.h"
 #include "model/modelsinc.h"
 #include "parse/parselo.h"
 #include "render/3dinternal.h"
@@ -2856,11 +2857,16 @@ int model_load(const  char *filename, int n_subsystems, model_subsystem *subsyst
 	if ( !Cmdline_old_collision_sys ) {
 		TRACE_SCOPE(tracing::ModelParseAllBSPTrees);
 
-		for ( i = 0; i < pm->n_models; ++i ) {
-			pm->submodel[i].collision_tree_index = model_create_bsp_collision_tree();
-			bsp_collision_tree *tree = model_get_bsp_collision_tree(pm->submodel[i].collision_tree_index);
+		// Global_checksum still holds the checksum of the POF read above
+		if ( !model_cache_load_collision_trees(pm, Global_checksum) ) {
+			for ( i = 0; i < pm->n_models; ++i ) {
+				pm->submodel[i].collision_tree_index = model_create_bsp_collision_tree();
+				bsp_collision_tree *tree = model_get_bsp_collision_tree(pm->submodel[i].collision_tree_index);
+
+				model_collide_parse_bsp(tree, pm->submodel[i].bsp_data, pm->version);
+			}
 
-			model_collide_parse_bsp(tree, pm->submodel[i].bsp_data, pm->version);
+			model_cache_save_collision_trees(pm, Global_checksum);
 		}
 	}
 
@@ -5248,6 +5254,10 @@ void model_remove_bsp_collision_tree(int tree_index)
 		vm_free(Bsp_collision_tree_list[tree_index].node_list);
 	}
 
+	if ( Bsp_collision_tree_list[tree_index].wide_node_list ) {
+		vm_free(Bsp_collision_tree_list[tree_index].wide_node_list);
+	}
+
 	if ( Bsp_collision_tree_list[tree_index].leaf_list ) {
 		vm_free(Bsp_collision_tree_list[tree_index].leaf_list);
 	}
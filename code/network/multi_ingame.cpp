@@ -1043,7 +1043,7 @@ void process_ingame_ships_packet( ubyte *data, header *hinfo )
 		Objects[objnum].net_signature = net_signature;
 
 		// assign any common data
-		strcpy_s(Ships[ship_num].ship_name, ship_name);
+		ship_rename(ship_num, ship_name);
 		Ships[ship_num].flags.from_u64(sflags);
 		Ships[ship_num].team = team;
 		Ships[ship_num].wingnum = (int)wing_data;				
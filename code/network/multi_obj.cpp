@@ -85,6 +85,14 @@ bool Multi_oo_afterburn_hack = false;
 #define OO_HULL_SHIELD_TIME		600
 #define OO_SUBSYS_TIME				1000
 
+// hull/shield and subsystem info which hasn't changed since it was last sent to a player is only sent this often, in
+// case the packet it was in got lost
+#define OO_STATUS_REFRESH_TIME	2000
+
+// update priorities, see multi_oo_ship_priority()
+#define OO_PRIORITY_CONE_SCALE	4.0f			// ships in the view cone count as this much closer
+#define OO_PRIORITY_STALE_TIME	250.0f			// every this many ms an update is overdue raise its priority by the base priority
+
 // timestamp values for object update times based on client's update level.
 int Multi_oo_target_update_times[MAX_OBJ_UPDATE_LEVELS] = 
 {
@@ -151,49 +159,52 @@ int Multi_oo_rear_far_update_times[MAX_OBJ_UPDATE_LEVELS] =
 // ship index list for possibly sorting ships based upon distance, etc
 short OO_ship_index[MAX_SHIPS];
 
+// update priority of each ship for the player the ship list was last built for
+static float OO_ship_priority[MAX_SHIPS];
+
 int OO_update_index = -1;							// index into OO_update_records for displaying update record info
 
 // ---------------------------------------------------------------------------------------------------
 // OBJECT UPDATE FUNCTIONS
 //
 
-object *OO_player_obj;
 int OO_sort = 1;
 
+// How urgently a ship needs an update for a player. Close ships and ships in the view cone come first, but the longer
+// an update has been overdue the higher it climbs. Otherwise the ships at the end of the list would never get an
+// update once the datarate cap is hit every frame.
+static float multi_oo_ship_priority(net_player *pl, object *objp)
+{
+	int stamp = Ships[objp->instance].np_updates[NET_PLAYER_NUM(pl)].update_stamp;
+
+	// not due yet, multi_oo_maybe_update() won't send anything anyway
+	if((stamp != -1) && !timestamp_elapsed_safe(stamp, OO_MAX_TIMESTAMP)){
+		return -1.0f;
+	}
+
+	vec3d to_obj;
+	vm_vec_sub(&to_obj, &objp->pos, &pl->s_info.eye_pos);
+	float dist = vm_vec_mag(&to_obj);
+
+	if((dist > 0.0f) && (vm_vec_dot(&to_obj, &pl->s_info.eye_orient.vec.fvec) >= OO_VIEW_CONE_DOT * dist)){
+		dist /= OO_PRIORITY_CONE_SCALE;
+	}
+
+	float priority = 1.0f / (1.0f + dist / OO_MIDRANGE_DIST);
+
+	// ships which never got an update count as overdue as it gets
+	int overdue = (stamp == -1) ? OO_MAX_TIMESTAMP : MIN(MAX(timestamp() - stamp, 0), OO_MAX_TIMESTAMP);
+
+	return priority * (1.0f + overdue / OO_PRIORITY_STALE_TIME);
+}
+
 bool multi_oo_sort_func(const short &index1, const short &index2)
 {
-	object *obj1, *obj2;
-	float dist1, dist2;
-	float dot1, dot2;
-	vec3d v1, v2;
-	vec3d vn1, vn2;
-
-	// if the indices are bogus, or the objnums are bogus, return ">"
-	if((index1 < 0) || (index2 < 0) || (Ships[index1].objnum < 0) || (Ships[index2].objnum < 0)){
-		return false;
-	}
-
-	// get the 2 objects
-	obj1 = &Objects[Ships[index1].objnum];
-	obj2 = &Objects[Ships[index2].objnum];
-
-	// get the distance and dot product to the player obj for both
-	vm_vec_sub(&v1, &OO_player_obj->pos, &obj1->pos);
-	dist1 = vm_vec_copy_normalize(&vn1, &v1);
-	vm_vec_sub(&v2, &OO_player_obj->pos, &obj2->pos);
-	dist2 = vm_vec_copy_normalize(&vn2, &v2);
-	dot1 = vm_vec_dot(&OO_player_obj->orient.vec.fvec, &vn1);
-	dot2 = vm_vec_dot(&OO_player_obj->orient.vec.fvec, &vn2);
-
-	// objects in front take precedence
-	if((dot1 < 0.0f) && (dot2 >= 0.0f)){
-		return false;
-	} else if((dot2 < 0.0f) && (dot1 >= 0.0f)){
-		return true;
-	}
-
-	// otherwise go by distance
-	return (dist1 < dist2);
+	if(OO_ship_priority[index1] != OO_ship_priority[index2]){
+		return OO_ship_priority[index1] > OO_ship_priority[index2];
+	}
+
+	return index1 < index2;
 }
 
 // build the list of ship indices to use when updating for this player
@@ -260,8 +271,11 @@ void multi_oo_build_ship_list(net_player *pl)
 	}
 
 	// maybe sort the thing here
-	OO_player_obj = player_obj;
 	if (OO_sort) {
+		for(idx = 0; idx < ship_index; idx++){
+			OO_ship_priority[OO_ship_index[idx]] = multi_oo_ship_priority(pl, &Objects[Ships[OO_ship_index[idx]].objnum]);
+		}
+
 		std::sort(OO_ship_index, OO_ship_index + ship_index, multi_oo_sort_func);
 	}
 }
@@ -345,8 +359,72 @@ int multi_oo_pack_client_data(ubyte *data)
 	return packet_size;
 }
 
+// how a percentage gets packed
+static std::uint8_t multi_oo_percent_byte(float v)
+{
+	if(v < 0.0f){
+		v = 0.0f;
+	}
+
+	return (v * 255.0f) <= 255.0f ? (std::uint8_t)(v * 255.0f) : (std::uint8_t)255;
+}
+
+// hull value as it gets packed
+static float multi_oo_packed_hull_pct(object *objp)
+{
+	float temp = get_hull_pct(objp);
+	if ( (temp < 0.004f) && (temp > 0.0f) ) {
+		temp = 0.004f;		// 0.004 is the lowest positive value we can have before we zero out when packing
+	}
+
+	return temp;
+}
+
+// checksum of the hull and shield info multi_oo_pack_data() would send for this ship
+static ushort multi_oo_status_chksum(object *objp)
+{
+	ushort chksum = 0;
+	std::uint8_t upercent;
+
+	upercent = multi_oo_percent_byte(multi_oo_packed_hull_pct(objp));
+	chksum = cf_add_chksum_short(chksum, &upercent, sizeof(upercent));
+
+	float quad = shield_get_max_quad(objp);
+	for (int i = 0; i < objp->n_quadrants; i++) {
+		upercent = multi_oo_percent_byte(objp->shield_quadrant[i] / quad);
+		chksum = cf_add_chksum_short(chksum, &upercent, sizeof(upercent));
+	}
+
+	return chksum;
+}
+
+// checksum of the subsystem and ai info multi_oo_pack_data() would send for this ship
+static ushort multi_oo_subsys_chksum(object *objp)
+{
+	ship *shipp = &Ships[objp->instance];
+	ushort chksum = 0;
+	std::uint8_t upercent;
+
+	for ( ship_subsys *subsysp = GET_FIRST(&shipp->subsys_list); subsysp != END_OF_LIST(&shipp->subsys_list); subsysp = GET_NEXT(subsysp) ) {
+		upercent = multi_oo_percent_byte((float)subsysp->current_hits / (float)subsysp->max_hits);
+		chksum = cf_add_chksum_short(chksum, &upercent, sizeof(upercent));
+	}
+
+	ai_info *aip = &Ai_info[shipp->ai_index];
+	ushort target_signature = (aip->target_objnum != -1) ? Objects[aip->target_objnum].net_signature : 0;
+
+	chksum = cf_add_chksum_short(chksum, (ubyte*)&aip->mode, sizeof(aip->mode));
+	chksum = cf_add_chksum_short(chksum, (ubyte*)&aip->submode, sizeof(aip->submode));
+	chksum = cf_add_chksum_short(chksum, (ubyte*)&target_signature, sizeof(target_signature));
+
+	upercent = multi_oo_percent_byte(shipp->weapon_energy / Ship_info[shipp->ship_info_index].max_weapon_reserve);
+	chksum = cf_add_chksum_short(chksum, &upercent, sizeof(upercent));
+
+	return chksum;
+}
+
 // pack the appropriate info into the data
-#define PACK_PERCENT(v) { std::uint8_t upercent; if(v < 0.0f){v = 0.0f;} upercent = (v * 255.0f) <= 255.0f ? (std::uint8_t)(v * 255.0f) : (std::uint8_t)255; memcpy(data + packet_size + header_bytes, &upercent, sizeof(std::uint8_t)); packet_size++; }
+#define PACK_PERCENT(v) { std::uint8_t upercent = multi_oo_percent_byte(v); memcpy(data + packet_size + header_bytes, &upercent, sizeof(std::uint8_t)); packet_size++; }
 #define PACK_BYTE(v) { memcpy( data + packet_size + header_bytes, &v, 1 ); packet_size += 1; }
 #define PACK_SHORT(v) { std::int16_t swap = INTEL_SHORT(v); memcpy( data + packet_size + header_bytes, &swap, sizeof(std::int16_t) ); packet_size += sizeof(std::int16_t); }
 #define PACK_USHORT(v) { std::uint16_t swap = INTEL_SHORT(v); memcpy( data + packet_size + header_bytes, &swap, sizeof(std::uint16_t) ); packet_size += sizeof(std::uint16_t); }
@@ -446,10 +524,7 @@ int multi_oo_pack_data(net_player *pl, object *objp, ubyte oo_flags, ubyte *data
 	// hull info
 	if ( oo_flags & OO_HULL_NEW ){
 		// add the hull value for this guy		
-		temp = get_hull_pct(objp);
-		if ( (temp < 0.004f) && (temp > 0.0f) ) {
-			temp = 0.004f;		// 0.004 is the lowest positive value we can have before we zero out when packing
-		}
+		temp = multi_oo_packed_hull_pct(objp);
 		PACK_PERCENT(temp);				
 		multi_rate_add(NET_PLAYER_NUM(pl), "hul", 1);	
 
@@ -1193,6 +1268,35 @@ int multi_oo_maybe_update(net_player *pl, object *obj, ubyte *data)
 		}						
 	}		
 
+	// don't resend hull/shield and subsystem info the player already has, unless it's time for a refresh
+	np_update *npu = &shipp->np_updates[player_index];
+	if(oo_flags & OO_HULL_NEW){
+		ushort cur_status_chksum = multi_oo_status_chksum(obj);
+
+		if((npu->status_chksum != 0) && (npu->status_chksum == cur_status_chksum) && !timestamp_elapsed_safe(npu->status_refresh_stamp, OO_MAX_TIMESTAMP)){
+#ifndef NDEBUG
+			multi_rate_add(player_index, "skp_h", 1 + obj->n_quadrants);
+#endif
+			oo_flags &= ~(OO_HULL_NEW);
+		} else {
+			npu->status_chksum = cur_status_chksum;
+			npu->status_refresh_stamp = timestamp(OO_STATUS_REFRESH_TIME);
+		}
+	}
+	if((oo_flags & OO_SUBSYSTEMS_AND_AI_NEW) && (sip != NULL) && (shipp->ai_index >= 0)){
+		ushort cur_subsys_chksum = multi_oo_subsys_chksum(obj);
+
+		if((npu->subsys_chksum != 0) && (npu->subsys_chksum == cur_subsys_chksum) && !timestamp_elapsed_safe(npu->subsys_refresh_stamp, OO_MAX_TIMESTAMP)){
+#ifndef NDEBUG
+			multi_rate_add(player_index, "skp_s", 7 + sip->n_subsystems);
+#endif
+			oo_flags &= ~(OO_SUBSYSTEMS_AND_AI_NEW);
+		} else {
+			npu->subsys_chksum = cur_subsys_chksum;
+			npu->subsys_refresh_stamp = timestamp(OO_STATUS_REFRESH_TIME);
+		}
+	}
+
 	// get current position and orient checksums		
 	cur_pos_chksum = cf_add_chksum_short(cur_pos_chksum, (ubyte*)(&obj->pos), sizeof(vec3d));
 	cur_orient_chksum = cf_add_chksum_short(cur_orient_chksum, (ubyte*)(&obj->orient), sizeof(matrix));
@@ -1414,6 +1518,10 @@ void multi_oo_gameplay_init()
 				shipp->np_updates[idx].seq = 0;		
 				shipp->np_updates[idx].pos_chksum = 0;
 				shipp->np_updates[idx].orient_chksum = 0;
+				shipp->np_updates[idx].status_chksum = 0;
+				shipp->np_updates[idx].subsys_chksum = 0;
+				shipp->np_updates[idx].status_refresh_stamp = -1;
+				shipp->np_updates[idx].subsys_refresh_stamp = -1;
 			} 
 			
 			oo_arrive_time_count[shipp - Ships] = 0;			
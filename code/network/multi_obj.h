@@ -42,6 +42,10 @@ typedef struct np_update {
 	int		subsys_update_stamp;
 	ushort	pos_chksum;					// positional checksum
 	ushort	orient_chksum;				// orient checksum
+	ushort	status_chksum;				// checksum of the hull and shield info last sent
+	ushort	subsys_chksum;				// checksum of the subsystem and ai info last sent
+	int		status_refresh_stamp;		// when unchanged hull and shield info gets sent again anyway
+	int		subsys_refresh_stamp;		// when unchanged subsystem and ai info gets sent again anyway
 } np_update;
 
 // ---------------------------------------------------------------------------------------------------
@@ -713,6 +713,10 @@ void multi_assign_player_ship( int net_player_num, object *objp,int ship_class )
 	for(idx=0; idx<MAX_PLAYERS; idx++){
 		shipp->np_updates[idx].orient_chksum = 0;
 		shipp->np_updates[idx].pos_chksum = 0;
+		shipp->np_updates[idx].status_chksum = 0;
+		shipp->np_updates[idx].subsys_chksum = 0;
+		shipp->np_updates[idx].status_refresh_stamp = -1;
+		shipp->np_updates[idx].subsys_refresh_stamp = -1;
 		shipp->np_updates[idx].seq = 0;
 		shipp->np_updates[idx].status_update_stamp = -1;
 		shipp->np_updates[idx].subsys_update_stamp = -1;
@@ -1596,7 +1600,7 @@ void multi_create_standalone_object()
 	// make ship hidden from sensors so that this observer cannot target it.  Observers really have two ships
 	// one observer, and one "Player_ship".  Observer needs to ignore the Player_ship.
     Player_ship->flags.set(Ship::Ship_Flags::Hidden_from_sensors);
-	strcpy_s(Player_ship->ship_name, XSTR("Standalone Ship",904));
+	ship_rename(Objects[pobj_num].instance, XSTR("Standalone Ship",904));
 	Player_ai = &Ai_info[Ships[Objects[pobj_num].instance].ai_index];		
 
 }
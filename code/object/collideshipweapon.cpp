@@ -22,6 +22,7 @@
 #include "ship/ship.h"
 #include "ship/shipfx.h"
 #include "ship/shiphit.h"
+#include "utils/threading.h"
 #include "weapon/weapon.h"
 
 
@@ -123,45 +124,47 @@ void ship_weapon_do_hit_stuff(object *pship_obj, object *weapon_obj, vec3d *worl
 
 extern int Framecount;
 
-int ship_weapon_check_collision(object *ship_objp, object *weapon_objp, float time_limit = 0.0f, int *next_hit = NULL)
-{
-	mc_info mc, mc_shield, mc_hull;
-	ship	*shipp;
-	ship_info *sip;
-	weapon	*wp;
-	weapon_info	*wip;
-
-	Assert( ship_objp != NULL );
-	Assert( ship_objp->type == OBJ_SHIP );
-	Assert( ship_objp->instance >= 0 );
-
-	shipp = &Ships[ship_objp->instance];
-	sip = &Ship_info[shipp->ship_info_index];
-
-	Assert( weapon_objp != NULL );
-	Assert( weapon_objp->type == OBJ_WEAPON );
-	Assert( weapon_objp->instance >= 0 );
-
-	wp = &Weapons[weapon_objp->instance];
-	wip = &Weapon_info[wp->weapon_info_index];
+// Results of the model checks between a ship and a weapon
+typedef struct ship_weapon_model_hits {
+	int shield_collision;
+	int hull_collision;
+	mc_info mc_shield;
+	mc_info mc_hull;
+} ship_weapon_model_hits;
+
+// Model checks which were done ahead of time on the worker threads, along with everything they depend on
+typedef struct ship_weapon_prefetch {
+	uint key;
+	int ship_sig;
+	int weapon_sig;
+	int ship_info_index;
+	bool no_shields;
+	vec3d ship_pos;
+	matrix ship_orient;
+	vec3d weapon_pos;
+	vec3d weapon_last_pos;
+	vec3d weapon_vel;
+	ship_weapon_model_hits hits;
+} ship_weapon_prefetch;
+
+static SCP_vector<ship_weapon_prefetch> Ship_weapon_prefetched;
 
-
-	Assert( shipp->objnum == OBJ_INDEX(ship_objp));
-
-	// Make ships that are warping in not get collision detection done
-	if ( shipp->is_arriving() ) return 0;
-	
-	//	Return information for AI to detect incoming fire.
-	//	Could perhaps be done elsewhere at lower cost --MK, 11/7/97
-	float	dist = vm_vec_dist_quick(&ship_objp->pos, &weapon_objp->pos);
-	if (dist < weapon_objp->phys_info.speed) {
-		update_danger_weapon(ship_objp, weapon_objp);
-	}
-
-	int	valid_hit_occurred = 0;				// If this is set, then hitpos is set
-	int	quadrant_num = -1;
+/**
+ * Does the model collision checks between a ship and a weapon.
+ *
+ * This does not change any game state so it can be used from the collision detection workers.
+ */
+static void ship_weapon_check_model_collisions(object *ship_objp, object *weapon_objp, float time_limit, ship_weapon_model_hits *hits)
+{
+	mc_info mc;
+	ship *shipp = &Ships[ship_objp->instance];
+	ship_info *sip = &Ship_info[shipp->ship_info_index];
+	weapon *wp = &Weapons[weapon_objp->instance];
 	polymodel *pm = model_get(sip->model_num);
 
+	mc_info &mc_shield = hits->mc_shield;
+	mc_info &mc_hull = hits->mc_hull;
+
 	//	total time is flFrametime + time_limit (time_limit used to predict collisions into the future)
 	vec3d weapon_end_pos;
 	vm_vec_scale_add( &weapon_end_pos, &weapon_objp->pos, &weapon_objp->phys_info.vel, time_limit );
@@ -347,6 +350,148 @@ int ship_weapon_check_collision(object *ship_objp, object *weapon_objp, float ti
 		hull_collision = model_collide(&mc_hull);
 	}
 
+	hits->shield_collision = shield_collision;
+	hits->hull_collision = hull_collision;
+}
+
+/**
+ * Runs the ship:weapon model checks for the given pairs on the worker threads.
+ *
+ * The results are picked up by ship_weapon_check_collision() during the serial collision pass, as long as
+ * nothing they depend on has changed in the meantime.  If anything has changed the checks are simply redone,
+ * so the outcome is always the same as without the prefetch.
+ *
+ * @param pairs The pairs to check, as (ship object, weapon object)
+ */
+void collide_ship_weapon_prefetch(const SCP_vector<std::pair<object*, object*>> &pairs)
+{
+	Ship_weapon_prefetched.resize(pairs.size());
+
+	threading::parallel_for(pairs.size(), 8, [&pairs](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			object *ship_objp = pairs[i].first;
+			object *weapon_objp = pairs[i].second;
+			ship_weapon_prefetch *pf = &Ship_weapon_prefetched[i];
+
+			pf->key = obj_collide_pair_key(OBJ_INDEX(ship_objp), OBJ_INDEX(weapon_objp));
+			pf->ship_sig = ship_objp->signature;
+			pf->weapon_sig = weapon_objp->signature;
+			pf->ship_info_index = Ships[ship_objp->instance].ship_info_index;
+			pf->no_shields = ship_objp->flags[Object::Object_Flags::No_shields];
+			pf->ship_pos = ship_objp->pos;
+			pf->ship_orient = ship_objp->orient;
+			pf->weapon_pos = weapon_objp->pos;
+			pf->weapon_last_pos = weapon_objp->last_pos;
+			pf->weapon_vel = weapon_objp->phys_info.vel;
+
+			ship_weapon_check_model_collisions(ship_objp, weapon_objp, 0.0f, &pf->hits);
+		}
+	});
+
+	std::sort(Ship_weapon_prefetched.begin(), Ship_weapon_prefetched.end(),
+		[](const ship_weapon_prefetch &a, const ship_weapon_prefetch &b) { return a.key < b.key; });
+}
+
+void collide_ship_weapon_prefetch_clear()
+{
+	Ship_weapon_prefetched.clear();
+}
+
+/**
+ * Looks up the prefetched model checks for a ship:weapon pair.
+ * @return true if there were results and they are still valid for the current state of both objects
+ */
+static bool ship_weapon_get_prefetched(object *ship_objp, object *weapon_objp, ship_weapon_model_hits *hits)
+{
+	if (Ship_weapon_prefetched.empty()) {
+		return false;
+	}
+
+	ship_weapon_prefetch search;
+	search.key = obj_collide_pair_key(OBJ_INDEX(ship_objp), OBJ_INDEX(weapon_objp));
+
+	auto it = std::lower_bound(Ship_weapon_prefetched.begin(), Ship_weapon_prefetched.end(), search,
+		[](const ship_weapon_prefetch &a, const ship_weapon_prefetch &b) { return a.key < b.key; });
+
+	if (it == Ship_weapon_prefetched.end() || it->key != search.key) {
+		return false;
+	}
+
+	// collision responses and scripting hooks run between the prefetch and now, so make sure the inputs are unchanged
+	if (it->ship_sig != ship_objp->signature || it->weapon_sig != weapon_objp->signature
+		|| it->ship_info_index != Ships[ship_objp->instance].ship_info_index
+		|| it->no_shields != (bool)ship_objp->flags[Object::Object_Flags::No_shields]
+		|| memcmp(&it->ship_pos, &ship_objp->pos, sizeof(vec3d)) || memcmp(&it->ship_orient, &ship_objp->orient, sizeof(matrix))
+		|| memcmp(&it->weapon_pos, &weapon_objp->pos, sizeof(vec3d)) || memcmp(&it->weapon_last_pos, &weapon_objp->last_pos, sizeof(vec3d))
+		|| memcmp(&it->weapon_vel, &weapon_objp->phys_info.vel, sizeof(vec3d))) {
+		return false;
+	}
+
+	*hits = it->hits;
+	return true;
+}
+
+
+int ship_weapon_check_collision(object *ship_objp, object *weapon_objp, float time_limit = 0.0f, int *next_hit = NULL)
+{
+	ship	*shipp;
+	ship_info *sip;
+	weapon	*wp;
+	weapon_info	*wip;
+
+	Assert( ship_objp != NULL );
+	Assert( ship_objp->type == OBJ_SHIP );
+	Assert( ship_objp->instance >= 0 );
+
+	shipp = &Ships[ship_objp->instance];
+	sip = &Ship_info[shipp->ship_info_index];
+
+	Assert( weapon_objp != NULL );
+	Assert( weapon_objp->type == OBJ_WEAPON );
+	Assert( weapon_objp->instance >= 0 );
+
+	wp = &Weapons[weapon_objp->instance];
+	wip = &Weapon_info[wp->weapon_info_index];
+
+
+	Assert( shipp->objnum == OBJ_INDEX(ship_objp));
+
+	// Make ships that are warping in not get collision detection done
+	if ( shipp->is_arriving() ) return 0;
+	
+	//	Return information for AI to detect incoming fire.
+	//	Could perhaps be done elsewhere at lower cost --MK, 11/7/97
+	float	dist = vm_vec_dist_quick(&ship_objp->pos, &weapon_objp->pos);
+	if (dist < weapon_objp->phys_info.speed) {
+		update_danger_weapon(ship_objp, weapon_objp);
+	}
+
+	int	valid_hit_occurred = 0;				// If this is set, then hitpos is set
+	int	quadrant_num = -1;
+
+	//	total time is flFrametime + time_limit (time_limit used to predict collisions into the future)
+	vec3d weapon_end_pos;
+	vm_vec_scale_add( &weapon_end_pos, &weapon_objp->pos, &weapon_objp->phys_info.vel, time_limit );
+
+	ship_weapon_model_hits hits;
+
+	if ( (time_limit != 0.0f) || !ship_weapon_get_prefetched(ship_objp, weapon_objp, &hits) ) {
+		ship_weapon_check_model_collisions(ship_objp, weapon_objp, time_limit, &hits);
+	}
+
+	int shield_collision = hits.shield_collision;
+	int hull_collision = hits.hull_collision;
+	mc_info mc, mc_shield, mc_hull;
+
+	memcpy(&mc_shield, &hits.mc_shield, sizeof(mc_info));
+	memcpy(&mc_hull, &hits.mc_hull, sizeof(mc_info));
+
+	// the position pointers refer to the locals of the model check, so point them at ours
+	mc_shield.orient = mc_hull.orient = &ship_objp->orient;
+	mc_shield.pos = mc_hull.pos = &ship_objp->pos;
+	mc_shield.p0 = mc_hull.p0 = &weapon_objp->last_pos;
+	mc_shield.p1 = mc_hull.p1 = &weapon_end_pos;
+
 	if (shield_collision) {
 		// pick out the shield quadrant
 		quadrant_num = get_quadrant(&mc_shield.hit_point, ship_objp);
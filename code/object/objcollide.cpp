@@ -19,6 +19,7 @@
 #include "weapon/beam.h"
 #include "weapon/weapon.h"
 #include "tracing/Monitor.h"
+#include "utils/flat_hash_map.h"
 
 
 
@@ -62,12 +63,40 @@ public:
 	{}
 };
 
-SCP_unordered_map<uint, collider_pair> Collision_cached_pairs;
+flat_hash_map<collider_pair> Collision_cached_pairs;
+
+// stale cached pairs are evicted in one batch whenever the map has grown to this size
+#define MIN_CACHED_PAIRS_EVICT_SIZE	4096
+static size_t Collision_cached_pairs_evict_size = MIN_CACHED_PAIRS_EVICT_SIZE;
 
 class checkobject;
 extern checkobject CheckObjects[MAX_OBJECTS];
 
 extern int Cmdline_old_collision_sys;
+extern int Cmdline_collision_grid;
+extern int Cmdline_collision_threads;
+
+// uniform grid broadphase, used instead of the sort-and-sweep when -collision_grid is given
+#define COLLISION_GRID_CELL_SIZE		250.0f	// edge length of a grid cell in meters
+#define COLLISION_GRID_MAX_OBJ_CELLS	64		// colliders spanning more cells than this are tested against everything
+
+typedef struct collider_bounds {
+	vec3d min;
+	vec3d max;
+	int objnum;
+} collider_bounds;
+
+typedef struct collider_cell_entry {
+	int x, y, z;
+	int bounds_index;
+} collider_cell_entry;
+
+static SCP_vector<collider_bounds> Collision_grid_bounds;
+static SCP_vector<collider_cell_entry> Collision_grid_cells;
+static SCP_vector<int> Collision_grid_oversize;
+
+// overlapping pairs found by the broadphase, handed to obj_collide_pair() once the broadphase is done
+static SCP_vector<std::pair<int, int>> Collision_overlap_pairs;
 
 void obj_pairs_close()
 {
@@ -1069,14 +1098,11 @@ int collide_remove_weapons( )
 			opp = opp->next;
 		}
 	} else {
-		SCP_unordered_map<uint, collider_pair>::iterator it;
-		collider_pair *pair_obj;
+		Collision_cached_pairs.for_each([](uint /*key*/, collider_pair &pair) {
+			collider_pair *pair_obj = &pair;
 
-		for ( it = Collision_cached_pairs.begin(); it != Collision_cached_pairs.end(); ++it ) {
-			pair_obj = &it->second;
-			
 			if ( !pair_obj->initialized ) {
-				continue;
+				return;
 			}
 
 			if ( pair_obj->a->type == OBJ_WEAPON && pair_obj->signature_a == pair_obj->a->signature ) {
@@ -1094,7 +1120,7 @@ int collide_remove_weapons( )
 					pair_obj->initialized = false;
 				}
 			}
-		}
+		});
 	}
 
 	// for each weapon which could be removed, delete the object
@@ -1206,15 +1232,33 @@ void obj_reset_colliders()
 {
 	Collision_sort_list.clear();
 	Collision_cached_pairs.clear();
+	Collision_cached_pairs_evict_size = MIN_CACHED_PAIRS_EVICT_SIZE;
 }
 
 void obj_collide_retime_cached_pairs(int checkdly)
 {
-	SCP_unordered_map<uint, collider_pair>::iterator it;
+	Collision_cached_pairs.for_each([checkdly](uint /*key*/, collider_pair &pair) {
+		pair.next_check_time = timestamp(checkdly);
+	});
+}
 
-	for ( it = Collision_cached_pairs.begin(); it != Collision_cached_pairs.end(); ++it ) {
-		it->second.next_check_time = timestamp(checkdly);
+/**
+ * Removes the cached pairs which refer to objects that no longer exist.
+ *
+ * obj_collide_pair() treats such a pair exactly like one which isn't cached at all, so
+ * this only keeps the map from filling up with dead pairs over the course of a mission.
+ */
+static void obj_collide_evict_cached_pairs()
+{
+	if ( Collision_cached_pairs.size() < Collision_cached_pairs_evict_size ) {
+		return;
 	}
+
+	Collision_cached_pairs.erase_if([](uint /*key*/, const collider_pair &pair) {
+		return !pair.initialized || (pair.signature_a != pair.a->signature) || (pair.signature_b != pair.b->signature);
+	});
+
+	Collision_cached_pairs_evict_size = MAX((size_t)MIN_CACHED_PAIRS_EVICT_SIZE, Collision_cached_pairs.size() * 2);
 }
 
 void obj_sort_and_collide()
@@ -1225,9 +1269,16 @@ void obj_sort_and_collide()
 	if ( !(Game_detail_flags & DETAIL_FLAG_COLLISION) )
 		return;
 
+	if ( Cmdline_collision_grid ) {
+		obj_grid_collide();
+		return;
+	}
+
 	SCP_vector<int> sort_list_y;
 	SCP_vector<int> sort_list_z;
 
+	Collision_overlap_pairs.clear();
+
 	sort_list_y.clear();
 	{
 		TRACE_SCOPE(tracing::SortColliders);
@@ -1248,6 +1299,86 @@ void obj_sort_and_collide()
 		obj_quicksort_colliders(&sort_list_z, 0, (int)(sort_list_z.size() - 1), 2);
 	}
 	obj_find_overlap_colliders(&sort_list_y, &sort_list_z, 2, true);
+
+	obj_collide_overlap_pairs();
+}
+
+/**
+ * Queues the model checks of the ship:weapon pairs which obj_collide_pair() is going to test
+ * this frame, so that they can be done on the worker threads.
+ *
+ * This only mirrors the cheap rejection tests of obj_collide_pair() and collide_ship_weapon(),
+ * anything which slips through here is simply not used.
+ */
+static void obj_prefetch_collisions()
+{
+	TRACE_SCOPE(tracing::CollisionPrefetch);
+
+	SCP_vector<std::pair<object*, object*>> ship_weapon_pairs;
+
+	for ( size_t i = 0; i < Collision_overlap_pairs.size(); ++i ) {
+		object *ship_objp = &Objects[Collision_overlap_pairs[i].first];
+		object *weapon_objp = &Objects[Collision_overlap_pairs[i].second];
+
+		if ( ship_objp->type == OBJ_WEAPON ) {
+			std::swap(ship_objp, weapon_objp);
+		}
+
+		if ( ship_objp->type != OBJ_SHIP || weapon_objp->type != OBJ_WEAPON ) {
+			continue;
+		}
+
+		if ( !(ship_objp->flags[Object::Object_Flags::Collides]) || !(weapon_objp->flags[Object::Object_Flags::Collides]) ) {
+			continue;
+		}
+
+		if ( reject_obj_pair_on_parent(ship_objp, weapon_objp) || reject_due_collision_groups(ship_objp, weapon_objp) ) {
+			continue;
+		}
+
+		uint key = obj_collide_pair_key(OBJ_INDEX(ship_objp), OBJ_INDEX(weapon_objp));
+		collider_pair *cached = Collision_cached_pairs.find(key);
+
+		if ( cached != NULL && cached->initialized
+			&& cached->signature_a == ship_objp->signature && cached->signature_b == weapon_objp->signature ) {
+			if ( cached->next_check_time == -1 || !timestamp_elapsed(cached->next_check_time) ) {
+				continue;
+			}
+		}
+
+		// lasers inside big ships are checked further ahead in time, see check_inside_radius_for_big_ships()
+		ship_info *sip = &Ship_info[Ships[ship_objp->instance].ship_info_index];
+		if ( sip->is_big_or_huge() && (Weapon_info[Weapons[weapon_objp->instance].weapon_info_index].subtype == WP_LASER)
+			&& !(sip->flags[Ship::Info_Flags::Auto_spread_shields])
+			&& vm_vec_dist_squared(&ship_objp->pos, &weapon_objp->pos) < (1.2f*ship_objp->radius*ship_objp->radius) ) {
+			continue;
+		}
+
+		ship_weapon_pairs.push_back(std::make_pair(ship_objp, weapon_objp));
+	}
+
+	collide_ship_weapon_prefetch(ship_weapon_pairs);
+}
+
+/**
+ * Runs obj_collide_pair() on all the pairs found by the broadphase, in the order they were found.
+ *
+ * With -collision_threads the expensive model checks are done up front on the worker threads.
+ * Damage and physics are still applied here on the main thread in the same order as without it.
+ */
+void obj_collide_overlap_pairs()
+{
+	obj_collide_evict_cached_pairs();
+
+	if ( Cmdline_collision_threads ) {
+		obj_prefetch_collisions();
+	}
+
+	for ( size_t i = 0; i < Collision_overlap_pairs.size(); ++i ) {
+		obj_collide_pair(&Objects[Collision_overlap_pairs[i].first], &Objects[Collision_overlap_pairs[i].second]);
+	}
+
+	collide_ship_weapon_prefetch_clear();
 }
 
 void obj_find_overlap_colliders(SCP_vector<int> *overlap_list_out, SCP_vector<int> *list, int axis, bool collide)
@@ -1280,7 +1411,7 @@ void obj_find_overlap_colliders(SCP_vector<int> *overlap_list_out, SCP_vector<in
 				}
 				
 				if ( collide ) {
-					obj_collide_pair(&Objects[(*list)[i]], &Objects[overlappers[j]]);
+					Collision_overlap_pairs.push_back(std::make_pair((*list)[i], overlappers[j]));
 				}
 			} else {
 				overlappers[j] = overlappers.back();
@@ -1352,6 +1483,173 @@ float obj_get_collider_endpoint(int obj_num, int axis, bool min)
 	}
 }
 
+static inline int collision_grid_coord(float val)
+{
+	return (int)floorf(val / COLLISION_GRID_CELL_SIZE);
+}
+
+static inline bool collider_bounds_overlap(const collider_bounds *a, const collider_bounds *b)
+{
+	// inclusive on every axis, matching the min <= max test in obj_find_overlap_colliders()
+	for ( int axis = 0; axis < 3; ++axis ) {
+		if ( a->min.a1d[axis] > b->max.a1d[axis] || b->min.a1d[axis] > a->max.a1d[axis] ) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static bool collider_cell_entry_compare(const collider_cell_entry &a, const collider_cell_entry &b)
+{
+	if ( a.x != b.x )
+		return a.x < b.x;
+	if ( a.y != b.y )
+		return a.y < b.y;
+	if ( a.z != b.z )
+		return a.z < b.z;
+
+	return a.bounds_index < b.bounds_index;
+}
+
+static inline void collision_grid_add_pair(int objnum_a, int objnum_b)
+{
+	// always store the higher object index first so the cached pair key is stable between frames
+	if ( objnum_a < objnum_b ) {
+		std::swap(objnum_a, objnum_b);
+	}
+
+	Collision_overlap_pairs.push_back(std::make_pair(objnum_a, objnum_b));
+}
+
+/**
+ * Uniform grid broadphase
+ *
+ * Each collider is bucketed into every grid cell its bounding box touches.  The bucket list is
+ * sorted so that colliders sharing a cell end up next to each other, and the pairs within a run
+ * are bounds checked.  A pair is only reported from the cell holding the minimum corner of the
+ * overlap of both boxes, which means every overlapping pair is found exactly once without needing
+ * a set to weed out duplicates.  Colliders which are too large for the grid (capital ships, beams)
+ * are checked directly against every other collider instead.
+ *
+ * The overlapping pairs are handed to obj_collide_overlap_pairs() in a fixed order, independent of
+ * where the objects are in the grid.
+ */
+void obj_grid_collide()
+{
+	size_t i, j;
+
+	Collision_grid_bounds.clear();
+	Collision_grid_cells.clear();
+	Collision_grid_oversize.clear();
+	Collision_overlap_pairs.clear();
+
+	{
+		TRACE_SCOPE(tracing::SortColliders);
+
+		for ( i = 0; i < Collision_sort_list.size(); ++i ) {
+			collider_bounds bounds;
+			int objnum = Collision_sort_list[i];
+
+			bounds.objnum = objnum;
+			for ( int axis = 0; axis < 3; ++axis ) {
+				bounds.min.a1d[axis] = obj_get_collider_endpoint(objnum, axis, true);
+				bounds.max.a1d[axis] = obj_get_collider_endpoint(objnum, axis, false);
+			}
+
+			int bounds_index = (int)Collision_grid_bounds.size();
+			Collision_grid_bounds.push_back(bounds);
+
+			int x0 = collision_grid_coord(bounds.min.xyz.x), x1 = collision_grid_coord(bounds.max.xyz.x);
+			int y0 = collision_grid_coord(bounds.min.xyz.y), y1 = collision_grid_coord(bounds.max.xyz.y);
+			int z0 = collision_grid_coord(bounds.min.xyz.z), z1 = collision_grid_coord(bounds.max.xyz.z);
+
+			float num_cells = (float)(x1 - x0 + 1) * (float)(y1 - y0 + 1) * (float)(z1 - z0 + 1);
+
+			if ( num_cells > COLLISION_GRID_MAX_OBJ_CELLS ) {
+				Collision_grid_oversize.push_back(bounds_index);
+				continue;
+			}
+
+			collider_cell_entry entry;
+			entry.bounds_index = bounds_index;
+
+			for ( entry.x = x0; entry.x <= x1; ++entry.x ) {
+				for ( entry.y = y0; entry.y <= y1; ++entry.y ) {
+					for ( entry.z = z0; entry.z <= z1; ++entry.z ) {
+						Collision_grid_cells.push_back(entry);
+					}
+				}
+			}
+		}
+
+		std::sort(Collision_grid_cells.begin(), Collision_grid_cells.end(), collider_cell_entry_compare);
+	}
+
+	{
+		TRACE_SCOPE(tracing::FindOverlapColliders);
+
+		size_t run_start = 0;
+
+		while ( run_start < Collision_grid_cells.size() ) {
+			const collider_cell_entry *cell = &Collision_grid_cells[run_start];
+			size_t run_end = run_start + 1;
+
+			while ( run_end < Collision_grid_cells.size() && Collision_grid_cells[run_end].x == cell->x
+				&& Collision_grid_cells[run_end].y == cell->y && Collision_grid_cells[run_end].z == cell->z ) {
+				++run_end;
+			}
+
+			for ( i = run_start; i < run_end; ++i ) {
+				const collider_bounds *a = &Collision_grid_bounds[Collision_grid_cells[i].bounds_index];
+
+				for ( j = i + 1; j < run_end; ++j ) {
+					const collider_bounds *b = &Collision_grid_bounds[Collision_grid_cells[j].bounds_index];
+
+					if ( !collider_bounds_overlap(a, b) ) {
+						continue;
+					}
+
+					// only the cell containing the minimum corner of the overlap reports the pair
+					if ( collision_grid_coord(MAX(a->min.xyz.x, b->min.xyz.x)) != cell->x
+						|| collision_grid_coord(MAX(a->min.xyz.y, b->min.xyz.y)) != cell->y
+						|| collision_grid_coord(MAX(a->min.xyz.z, b->min.xyz.z)) != cell->z ) {
+						continue;
+					}
+
+					collision_grid_add_pair(a->objnum, b->objnum);
+				}
+			}
+
+			run_start = run_end;
+		}
+
+		for ( i = 0; i < Collision_grid_oversize.size(); ++i ) {
+			int bounds_index = Collision_grid_oversize[i];
+			const collider_bounds *a = &Collision_grid_bounds[bounds_index];
+
+			for ( j = 0; j < Collision_grid_bounds.size(); ++j ) {
+				if ( (int)j == bounds_index ) {
+					continue;
+				}
+
+				// two oversized colliders only get tested once
+				if ( (int)j < bounds_index && std::binary_search(Collision_grid_oversize.begin(), Collision_grid_oversize.end(), (int)j) ) {
+					continue;
+				}
+
+				if ( collider_bounds_overlap(a, &Collision_grid_bounds[j]) ) {
+					collision_grid_add_pair(a->objnum, Collision_grid_bounds[j].objnum);
+				}
+			}
+		}
+
+		std::sort(Collision_overlap_pairs.begin(), Collision_overlap_pairs.end());
+	}
+
+	obj_collide_overlap_pairs();
+}
+
 void obj_quicksort_colliders(SCP_vector<int> *list, int left, int right, int axis)
 {
 	Assert( axis >= 0 );
@@ -1557,7 +1855,7 @@ void obj_collide_pair(object *A, object *B)
 
 	collider_pair *collision_info = NULL;
 	bool valid = false;
-	uint key = (OBJ_INDEX(A) << 12) + OBJ_INDEX(B);
+	uint key = obj_collide_pair_key(OBJ_INDEX(A), OBJ_INDEX(B));
 
 	collision_info = &Collision_cached_pairs[key];
 
@@ -12,6 +12,7 @@
 #ifndef _COLLIDESTUFF_H
 #define _COLLIDESTUFF_H
 
+#include "globalincs/globals.h"
 #include "globalincs/pstypes.h"
 
 class object;
@@ -85,8 +86,16 @@ void obj_sort_and_collide();
 void obj_quicksort_colliders(SCP_vector<int> *list, int left, int right, int axis);
 void obj_find_overlap_colliders(SCP_vector<int> *overlap_list_out, SCP_vector<int> *list, int axis, bool collide);
 float obj_get_collider_endpoint(int obj_num, int axis, bool min);
+void obj_grid_collide();
+void obj_collide_overlap_pairs();
 void obj_collide_pair(object *A, object *B);
 
+// the key of a pair of objects in the collision caches, unique for every pair of object indices
+inline uint obj_collide_pair_key(int objnum_a, int objnum_b)
+{
+	return (uint)objnum_a * MAX_OBJECTS + (uint)objnum_b;
+}
+
 // retimes all collision pairs to be checked (in 25ms by default)
 void obj_all_collisions_retime(int checkdly=25);
 void obj_collide_retime_cached_pairs(int checkdly=25);
@@ -119,6 +128,10 @@ int collide_weapon_weapon( obj_pair * pair );
 int collide_ship_weapon( obj_pair * pair );
 void ship_weapon_do_hit_stuff(object *pship_obj, object *weapon_obj, vec3d *world_hitpos, vec3d *hitpos, int quadrant_num, int submodel_num = -1);
 
+// Does the model checks of the given (ship, weapon) pairs on the worker threads ahead of the serial collision pass
+void collide_ship_weapon_prefetch(const SCP_vector<std::pair<object*, object*>> &pairs);
+void collide_ship_weapon_prefetch_clear();
+
 // Checks debris-weapon collisions.  pair->a is debris and pair->b is weapon.
 // Returns 1 if all future collisions between these can be ignored
 // CODE is locatated in CollideDebrisWeapon.cpp
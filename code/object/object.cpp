@@ -29,6 +29,7 @@
 #include "object/object.h"
 #include "object/objectdock.h"
 #include "object/objectshield.h"
+#include "object/objectspatial.h"
 #include "object/objectsnd.h"
 #include "observer/observer.h"
 #include "scripting/scripting.h"
@@ -39,6 +40,7 @@
 #include "ship/afterburner.h"
 #include "ship/ship.h"
 #include "tracing/tracing.h"
+#include "utils/threading.h"
 #include "weapon/beam.h"
 #include "weapon/shockwave.h"
 #include "weapon/swarm.h"
@@ -59,6 +61,8 @@ object *Player_obj = NULL;
 object *Viewer_obj = NULL;
 
 extern int Cmdline_old_collision_sys;
+extern int Cmdline_ai_threads;
+extern int Cmdline_physics_threads;
 
 //Data for objects
 object Objects[MAX_OBJECTS];
@@ -119,8 +123,8 @@ checkobject::checkobject()
 
 // all we need to set are the pointers, but type, parent, and instance are useful to set as well
 object::object()
-	: next(NULL), prev(NULL), type(OBJ_NONE), parent(-1), instance(-1), n_quadrants(0), hull_strength(0.0),
-	  sim_hull_strength(0.0), net_signature(0), num_pairs(0), dock_list(NULL), dead_dock_list(NULL), collision_group_id(0)
+	: next(NULL), prev(NULL), type(OBJ_NONE), parent(-1), instance(-1), collision_group_id(0), hull_strength(0.0),
+	  dock_list(NULL), n_quadrants(0), sim_hull_strength(0.0), net_signature(0), num_pairs(0), dead_dock_list(NULL)
 {
 	memset(&(this->phys_info), 0, sizeof(physics_info));
 }
@@ -168,10 +172,8 @@ int free_object_slots(int num_used)
 
 	olind = 0;
 
-	// calc num_already_free by walking the obj_free_list
-	num_already_free = 0;
-	for ( objp = GET_FIRST(&obj_free_list); objp != END_OF_LIST(&obj_free_list); objp = GET_NEXT(objp) )
-		num_already_free++;
+	// every slot which isn't in use is on the obj_free_list
+	num_already_free = MAX_OBJECTS - Num_objects;
 
 	if (MAX_OBJECTS - num_already_free < num_used)
 		return 0;
@@ -344,6 +346,8 @@ void obj_init()
 		objp++;
 	}
 
+	obj_spatial_reset();
+
 	Object_next_signature = 1;	//0 is invalid, others start at 1
 	Num_objects = 0;
 	Highest_object_index = 0;
@@ -656,6 +660,12 @@ void obj_merge_created_list(void)
 	// creates object pairs for it, and then adds it to the used list.
 	//	OLD WAY: list_merge( &obj_used_list, &obj_create_list );
 	object *objp = GET_FIRST(&obj_create_list);
+
+	// the turret candidates gathered with -ai_threads don't know about the new objects
+	if ( objp != END_OF_LIST(&obj_create_list) ) {
+		ai_turret_prefetch_clear();
+	}
+
 	while( objp !=END_OF_LIST(&obj_create_list) )	{
 		list_remove( obj_create_list, objp );
 
@@ -668,6 +678,7 @@ void obj_merge_created_list(void)
 
 		// Then add it to the object used list
 		list_append( &obj_used_list, objp );
+		obj_spatial_add_object(OBJ_INDEX(objp));
 
 		objp = GET_FIRST(&obj_create_list);
 	}
@@ -780,10 +791,9 @@ void obj_player_fire_stuff( object *objp, control_info ci )
 	
 }
 
-void obj_move_call_physics(object *objp, float frametime)
+// Does the work of obj_move_call_physics(), without the trace scope so obj_move_all() can call it on the worker threads
+static void obj_move_call_physics_sub(object *objp, float frametime)
 {
-	TRACE_SCOPE(tracing::Physics);
-
 	int has_fired = -1;	//stop fireing stuff-Bobboau
 
 	//	Do physics for objects with OF_PHYSICS flag set and with some engine strength remaining.
@@ -942,6 +952,37 @@ obj_maybe_fire:
 	}
 }
 
+void obj_move_call_physics(object *objp, float frametime)
+{
+	TRACE_SCOPE(tracing::Physics);
+
+	obj_move_call_physics_sub(objp, frametime);
+}
+
+/**
+ * Determines if the physics of an object can be integrated on a worker thread
+ *
+ * Weapons and debris only change their own position, orientation and physics state while they are moved. Anything
+ * which is docked, caught in a shockwave (which shakes it with the shared random number generator), interpolated by
+ * multiplayer or belongs to the player stays on the main thread.
+ */
+static bool obj_physics_can_batch(object *objp)
+{
+	if ( (objp->type != OBJ_WEAPON) && (objp->type != OBJ_DEBRIS) )
+		return false;
+
+	if ( physics_paused || (objp == Player_obj) || (objp->dock_list != NULL) )
+		return false;
+
+	if ( objp->flags[Object::Object_Flags::Immobile] || (objp->phys_info.flags & PF_IN_SHOCKWAVE) )
+		return false;
+
+	return !multi_oo_is_interp_object(objp);
+}
+
+// the objects whose physics obj_move_all() integrates on the worker threads, in obj_used_list order
+static SCP_vector<object*> Obj_physics_batch;
+
 
 #define IMPORTANT_FLAGS (OF_COLLIDES)
 
@@ -1409,6 +1450,14 @@ void obj_move_all(float frametime)
 
 	obj_merge_created_list();
 
+	// the AI uses this to find nearby ships while the objects are moved
+	obj_spatial_rebuild(frametime);
+
+	// with -ai_threads the turret targets of all ships are gathered up front on the worker threads
+	if (Cmdline_ai_threads) {
+		ai_turret_prefetch_targets(frametime);
+	}
+
 	// Clear the table that tells which groups of weapons have cast light so far.
 	if(!(Game_mode & GM_MULTIPLAYER) || (MULTIPLAYER_MASTER)) {
 		obj_clear_weapon_group_id_list();
@@ -1416,6 +1465,9 @@ void obj_move_all(float frametime)
 
 	MONITOR_INC( NumObjects, Num_objects );	
 
+	bool batch_physics = Cmdline_physics_threads && (threading::num_workers() > 0);
+	Obj_physics_batch.clear();
+
 	for (objp = GET_FIRST(&obj_used_list); objp != END_OF_LIST(&obj_used_list); objp = GET_NEXT(objp)) {
 		// skip objects which should be dead
 		if (objp->flags[Object::Object_Flags::Should_be_dead]) {
@@ -1440,6 +1492,12 @@ void obj_move_all(float frametime)
 		objp->last_pos = cur_pos;
 		objp->last_orient = objp->orient;
 
+		// with -physics_threads weapons and debris are moved together after all other objects, see below
+		if (batch_physics && obj_physics_can_batch(objp)) {
+			Obj_physics_batch.push_back(objp);
+			continue;
+		}
+
 		// Goober5000 - skip objects which don't move, but only until they're destroyed
 		if (!(objp->flags[Object::Object_Flags::Immobile] && objp->hull_strength > 0.0f)) {
 			// if this is an object which should be interpolated in multiplayer, do so
@@ -1472,6 +1530,27 @@ void obj_move_all(float frametime)
 		Script_system.RemHookVars(2, "User", "Target");
 	}
 
+	// The weapons and debris which were held back are integrated in parallel, then finish their move in list order
+	if (!Obj_physics_batch.empty()) {
+		{
+			TRACE_SCOPE(tracing::Physics);
+
+			threading::parallel_for(Obj_physics_batch.size(), 64, [frametime](size_t begin, size_t end) {
+				for (size_t i = begin; i < end; i++) {
+					obj_move_call_physics_sub(Obj_physics_batch[i], frametime);
+				}
+			});
+		}
+
+		for (auto batched : Obj_physics_batch) {
+			obj_move_all_post(batched, frametime);
+		}
+
+		Obj_physics_batch.clear();
+	}
+
+	ai_turret_prefetch_clear();
+
 	// Now that we've moved all the objects, move all the models that use intrinsic rotations.  We do that here because we already handled the
 	// ship models in obj_move_all_post, and this is more or less conceptually close enough to move the rest.  (Originally all models
 	// were intrinsic-rotated here, but for sequencing reasons, intrinsic ship rotations must happen along with regular ship rotations.)
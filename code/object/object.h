@@ -112,36 +112,38 @@ extern obj_flag_name Object_flag_names[];
 struct dock_instance;
 class model_draw_list;
 
+// The members which the movement, collision and render loops look at every frame come first so they share as few cache
+// lines as possible, the ones only used by some subsystems come after phys_info.
 class object
 {
 public:
 	class object	*next, *prev;	// for linked lists of objects
 	int				signature;		// Every object ever has a unique signature...
 	char			type;				// what type of object this is... robot, weapon, hostage, powerup, fireball
+	char			parent_type;	// This object's parent's type
 	int				parent;			// This object's parent.
 	int				parent_sig;		// This object's parent's signature
-	char			parent_type;	// This object's parent's type
 	int				instance;		// which instance.  ie.. if type is Robot, then this indexes into the Robots array
 	flagset<Object::Object_Flags> flags;			// misc flags.  Call obj_set_flags to change this.
+	int				collision_group_id; // This is a bitfield. Collision checks will be skipped if A->collision_group_id & B->collision_group_id returns nonzero
+	float			radius;			// 3d size of object - for collision detection
 	vec3d			pos;				// absolute x,y,z coordinate of center of object
 	matrix			orient;			// orientation of object in world
-	float			radius;			// 3d size of object - for collision detection
 	vec3d			last_pos;		// where object was last frame
 	matrix			last_orient;	// how the object was oriented last frame
+	float			hull_strength;	//	Remaining hull strength.
+	dock_instance	*dock_list;			// Goober5000 - objects this object is docked to
 	physics_info	phys_info;		// a physics object
+
 	int				n_quadrants;	// how many shield quadrants the ship has
 	SCP_vector<float>	shield_quadrant;	//	Shield is broken into components, quadrants by default.
-	float			hull_strength;	//	Remaining hull strength.
 	float			sim_hull_strength;	// Simulated hull strength - used with training weapons.
 	SCP_vector<int> objsnd_num;		// Index of persistant sound struct.
 	ushort			net_signature;
 	int				num_pairs;		// How many object pairs this is associated with.  When 0 then there are no more.
 
-	dock_instance	*dock_list;			// Goober5000 - objects this object is docked to
 	dock_instance	*dead_dock_list;	// Goober5000 - objects this object was docked to when destroyed; replaces dock_objnum_when_dead
 
-	int				collision_group_id; // This is a bitfield. Collision checks will be skipped if A->collision_group_id & B->collision_group_id returns nonzero
-
 	object();
 	~object();
 	void clear();
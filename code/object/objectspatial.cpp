@@ -0,0 +1,482 @@
+#include "globalincs/linklist.h"
+#include "iff_defs/iff_defs.h"
+#include "model/model.h"
+#include "object/object.h"
+#include "object/objectspatial.h"
+#include "ship/ship.h"
+#include "tracing/tracing.h"
+#include "utils/flat_hash_map.h"
+#include "weapon/weapon.h"
+
+#include <algorithm>
+
+namespace {
+
+// Edge length of a grid cell, most AI queries look a few thousand meters around a ship
+const float SPATIAL_CELL_SIZE = 2000.0f;
+
+// Queries for the nearest ships stop growing at this range
+const float SPATIAL_MAX_RANGE = 1.0e8f;
+
+// vm_vec_dist_quick() can underestimate a distance by almost 10%, ranges are widened so queries cover it as well
+const float SPATIAL_QUICK_DIST_SCALE = 1.125f;
+
+struct spatial_entry {
+	vec3d pos;
+	float extent;		// radius around pos which contains the bounding sphere and the bounding box of the ship
+	int objnum;
+	int signature;
+	int team;
+	int x, y, z;		// the grid cell of pos
+	bool always;		// returned by every query with a matching team
+};
+
+struct spatial_bucket {
+	int start = 0;
+	int count = 0;
+};
+
+bool Spatial_valid = false;
+
+// Ships which fit into a grid cell, sorted by bucket
+SCP_vector<spatial_entry> Spatial_entries;
+flat_hash_map<spatial_bucket> Spatial_buckets;
+
+// Ships which are too large for the grid, move in ways their velocity doesn't cover or were created after the rebuild
+SCP_vector<spatial_entry> Spatial_unbucketed;
+
+float Spatial_max_extent = 0.0f;	// largest extent of a bucketed ship
+float Spatial_slack = 0.0f;			// how far a ship may have moved since the rebuild
+int Spatial_team_mask = 0;			// the teams which have bucketed ships
+
+struct spatial_object {
+	int objnum;
+	int signature;
+	int type;
+	int kinds;			// SPATIAL_* flags
+};
+
+// Every object with a kind, in obj_used_list order
+SCP_vector<spatial_object> Spatial_objects;
+
+// Position of every ship in Ship_obj_list at the time of the rebuild, used to sort query results
+int Spatial_list_order[MAX_OBJECTS];
+int Spatial_next_list_order = 0;
+
+inline int spatial_cell_coord(float val)
+{
+	return (int)floorf(val / SPATIAL_CELL_SIZE);
+}
+
+inline uint spatial_bucket_key(int x, int y, int z, int team)
+{
+	uint key = ((uint)x * 73856093u) ^ ((uint)y * 19349663u) ^ ((uint)z * 83492791u) ^ ((uint)team * 2654435761u);
+
+	// cells which hash to the same key share a bucket, the entries remember their cell so they are told apart
+	return (key == flat_hash_map<spatial_bucket>::EMPTY_KEY) ? 0 : key;
+}
+
+float spatial_ship_extent(object *objp)
+{
+	float extent = objp->radius;
+
+	// The AI measures the distance to the bounding box of big ships, which may stick out of the bounding sphere
+	int model_num = Ship_info[Ships[objp->instance].ship_info_index].model_num;
+	polymodel *pm = (model_num >= 0) ? model_get(model_num) : nullptr;
+
+	if (pm != nullptr) {
+		vec3d corner;
+
+		for (int axis = 0; axis < 3; ++axis) {
+			corner.a1d[axis] = MAX(fl_abs(pm->mins.a1d[axis]), fl_abs(pm->maxs.a1d[axis]));
+		}
+
+		extent = MAX(extent, vm_vec_mag(&corner));
+	}
+
+	return extent;
+}
+
+float spatial_ship_max_speed(object *objp)
+{
+	float speed = vm_vec_mag(&objp->phys_info.vel);
+
+	speed = MAX(speed, vm_vec_mag(&objp->phys_info.max_vel));
+	speed = MAX(speed, vm_vec_mag(&objp->phys_info.afterburner_max_vel));
+	speed = MAX(speed, vm_vec_mag(&objp->phys_info.booster_max_vel));
+
+	return speed;
+}
+
+int spatial_object_kinds(object *objp)
+{
+	switch (objp->type) {
+		case OBJ_SHIP:
+			return SPATIAL_SHIPS;
+
+		case OBJ_ASTEROID:
+			return SPATIAL_ASTEROIDS;
+
+		case OBJ_WEAPON: {
+			weapon_info *wip = &Weapon_info[Weapons[objp->instance].weapon_info_index];
+			int kinds = 0;
+
+			if (wip->weapon_hitpoints > 0) {
+				kinds |= SPATIAL_WEAPONS_HITPOINTS;
+			}
+			if (wip->wi_flags[Weapon::Info_Flags::Cmeasure]) {
+				kinds |= SPATIAL_CMEASURES;
+			}
+
+			return kinds;
+		}
+
+		default:
+			return 0;
+	}
+}
+
+void spatial_add_object(object *objp)
+{
+	int kinds = spatial_object_kinds(objp);
+
+	if (kinds == 0) {
+		return;
+	}
+
+	spatial_object entry;
+	entry.objnum = OBJ_INDEX(objp);
+	entry.signature = objp->signature;
+	entry.type = objp->type;
+	entry.kinds = kinds;
+
+	Spatial_objects.push_back(entry);
+}
+
+inline bool spatial_entry_is_current(const spatial_entry& entry)
+{
+	const object *objp = &Objects[entry.objnum];
+
+	return (objp->signature == entry.signature) && (objp->type == OBJ_SHIP);
+}
+
+inline float spatial_max_dist(float range, float extent)
+{
+	return (range + extent) * SPATIAL_QUICK_DIST_SCALE + Spatial_slack;
+}
+
+inline bool spatial_in_range(const vec3d *pos, const vec3d *entry_pos, float extent, float range)
+{
+	float max_dist = spatial_max_dist(range, extent);
+
+	return vm_vec_dist_squared(pos, entry_pos) <= max_dist * max_dist;
+}
+
+void spatial_check_unbucketed(const vec3d *pos, float range, int team_mask, SCP_vector<int>& objnums)
+{
+	for (auto& entry : Spatial_unbucketed) {
+		if (!spatial_entry_is_current(entry)) {
+			continue;
+		}
+
+		object *objp = &Objects[entry.objnum];
+
+		// the team may have been set after the ship was added so this uses the current one
+		if (!iff_matches_mask(Ships[objp->instance].team, team_mask)) {
+			continue;
+		}
+
+		if (!entry.always && !spatial_in_range(pos, &objp->pos, entry.extent, range)) {
+			continue;
+		}
+
+		objnums.push_back(entry.objnum);
+	}
+}
+
+void spatial_check_bucketed(const vec3d *pos, float range, const spatial_entry& entry, SCP_vector<int>& objnums)
+{
+	if (!spatial_entry_is_current(entry)) {
+		return;
+	}
+
+	if (!spatial_in_range(pos, &entry.pos, entry.extent, range)) {
+		return;
+	}
+
+	objnums.push_back(entry.objnum);
+}
+
+bool spatial_list_order_compare(int objnum_a, int objnum_b)
+{
+	return Spatial_list_order[objnum_a] < Spatial_list_order[objnum_b];
+}
+
+}
+
+void obj_spatial_reset()
+{
+	Spatial_valid = false;
+
+	Spatial_entries.clear();
+	Spatial_buckets.clear();
+	Spatial_unbucketed.clear();
+	Spatial_objects.clear();
+}
+
+void obj_spatial_rebuild(float frametime)
+{
+	TRACE_SCOPE(tracing::BuildSpatialIndex);
+
+	ship_obj *so;
+	float max_speed = 0.0f;
+
+	obj_spatial_reset();
+
+	Spatial_max_extent = 0.0f;
+	Spatial_team_mask = 0;
+	Spatial_next_list_order = 0;
+
+	for (so = GET_FIRST(&Ship_obj_list); so != END_OF_LIST(&Ship_obj_list); so = GET_NEXT(so)) {
+		object *objp = &Objects[so->objnum];
+		ship *shipp = &Ships[objp->instance];
+
+		Spatial_list_order[so->objnum] = Spatial_next_list_order++;
+
+		spatial_entry entry;
+		entry.pos = objp->pos;
+		entry.extent = spatial_ship_extent(objp);
+		entry.objnum = so->objnum;
+		entry.signature = objp->signature;
+		entry.team = shipp->team;
+		entry.x = spatial_cell_coord(objp->pos.xyz.x);
+		entry.y = spatial_cell_coord(objp->pos.xyz.y);
+		entry.z = spatial_cell_coord(objp->pos.xyz.z);
+
+		// Warping ships move much faster than their physics allows, docked ships are moved along with the whole
+		// assembly. Neither can be bucketed by their position at the start of the frame.
+		entry.always = shipp->is_arriving() || shipp->flags[Ship::Ship_Flags::Depart_warp];
+
+		if (entry.always || object_is_docked(objp) || (entry.extent > SPATIAL_CELL_SIZE)) {
+			Spatial_unbucketed.push_back(entry);
+			continue;
+		}
+
+		max_speed = MAX(max_speed, spatial_ship_max_speed(objp));
+		Spatial_max_extent = MAX(Spatial_max_extent, entry.extent);
+		Spatial_team_mask |= iff_get_mask(entry.team);
+
+		Spatial_entries.push_back(entry);
+	}
+
+	// Twice the distance the fastest ship can cover in this frame, which leaves room for physics overshooting the
+	// maximum speed a bit
+	Spatial_slack = 2.0f * max_speed * frametime;
+
+	std::sort(Spatial_entries.begin(), Spatial_entries.end(), [](const spatial_entry& a, const spatial_entry& b) {
+		auto key_a = spatial_bucket_key(a.x, a.y, a.z, a.team);
+		auto key_b = spatial_bucket_key(b.x, b.y, b.z, b.team);
+
+		if (key_a != key_b) {
+			return key_a < key_b;
+		}
+
+		return Spatial_list_order[a.objnum] < Spatial_list_order[b.objnum];
+	});
+
+	Spatial_buckets.reserve(Spatial_entries.size());
+
+	for (size_t i = 0; i < Spatial_entries.size(); ++i) {
+		auto& entry = Spatial_entries[i];
+		auto& bucket = Spatial_buckets[spatial_bucket_key(entry.x, entry.y, entry.z, entry.team)];
+
+		if (bucket.count == 0) {
+			bucket.start = (int)i;
+		}
+		++bucket.count;
+	}
+
+	for (object *objp = GET_FIRST(&obj_used_list); objp != END_OF_LIST(&obj_used_list); objp = GET_NEXT(objp)) {
+		spatial_add_object(objp);
+	}
+
+	Spatial_valid = true;
+}
+
+void obj_spatial_add_ship(int objnum)
+{
+	if (!Spatial_valid) {
+		return;
+	}
+
+	Spatial_list_order[objnum] = Spatial_next_list_order++;
+
+	spatial_entry entry;
+	entry.pos = Objects[objnum].pos;
+	entry.extent = 0.0f;
+	entry.objnum = objnum;
+	entry.signature = Objects[objnum].signature;
+	entry.team = -1;
+	entry.x = entry.y = entry.z = 0;
+	// the ship may still be moved into place by the code creating it
+	entry.always = true;
+
+	Spatial_unbucketed.push_back(entry);
+}
+
+void obj_spatial_add_object(int objnum)
+{
+	if (!Spatial_valid) {
+		return;
+	}
+
+	spatial_add_object(&Objects[objnum]);
+}
+
+void obj_spatial_query_ships(const vec3d *pos, float range, int team_mask, SCP_vector<int>& objnums)
+{
+	objnums.clear();
+
+	if (!Spatial_valid) {
+		ship_obj *so;
+
+		for (so = GET_FIRST(&Ship_obj_list); so != END_OF_LIST(&Ship_obj_list); so = GET_NEXT(so)) {
+			if (iff_matches_mask(Ships[Objects[so->objnum].instance].team, team_mask)) {
+				objnums.push_back(so->objnum);
+			}
+		}
+
+		return;
+	}
+
+	spatial_check_unbucketed(pos, range, team_mask, objnums);
+
+	int teams = team_mask & Spatial_team_mask;
+
+	if (teams != 0) {
+		float cell_range = spatial_max_dist(range, Spatial_max_extent);
+
+		int x0 = spatial_cell_coord(pos->xyz.x - cell_range), x1 = spatial_cell_coord(pos->xyz.x + cell_range);
+		int y0 = spatial_cell_coord(pos->xyz.y - cell_range), y1 = spatial_cell_coord(pos->xyz.y + cell_range);
+		int z0 = spatial_cell_coord(pos->xyz.z - cell_range), z1 = spatial_cell_coord(pos->xyz.z + cell_range);
+
+		int num_teams = 0;
+		for (int team = 0; team < MAX_IFFS; ++team) {
+			if (teams & iff_get_mask(team)) {
+				++num_teams;
+			}
+		}
+
+		float num_buckets = (float)(x1 - x0 + 1) * (float)(y1 - y0 + 1) * (float)(z1 - z0 + 1) * (float)num_teams;
+
+		if (num_buckets >= (float)Spatial_entries.size()) {
+			// Looking at every bucket would take longer than just checking all ships
+			for (auto& entry : Spatial_entries) {
+				if (teams & iff_get_mask(entry.team)) {
+					spatial_check_bucketed(pos, range, entry, objnums);
+				}
+			}
+		} else {
+			for (int team = 0; team < MAX_IFFS; ++team) {
+				if (!(teams & iff_get_mask(team))) {
+					continue;
+				}
+
+				for (int x = x0; x <= x1; ++x) {
+					for (int y = y0; y <= y1; ++y) {
+						for (int z = z0; z <= z1; ++z) {
+							auto bucket = Spatial_buckets.find(spatial_bucket_key(x, y, z, team));
+
+							if (bucket == nullptr) {
+								continue;
+							}
+
+							for (int i = bucket->start; i < bucket->start + bucket->count; ++i) {
+								auto& entry = Spatial_entries[i];
+
+								if (entry.x == x && entry.y == y && entry.z == z && entry.team == team) {
+									spatial_check_bucketed(pos, range, entry, objnums);
+								}
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+
+	std::sort(objnums.begin(), objnums.end(), spatial_list_order_compare);
+}
+
+void obj_spatial_find_nearest_ships(const vec3d *pos, int team_mask, size_t count, SCP_vector<int>& objnums)
+{
+	objnums.clear();
+
+	if (count == 0) {
+		return;
+	}
+
+	// Grow the query until it finds enough ships. Ships with a large extent may be found before closer ones, the final
+	// query below takes care of that.
+	float range = SPATIAL_CELL_SIZE;
+	obj_spatial_query_ships(pos, range, team_mask, objnums);
+
+	while ((objnums.size() < count) && (range < SPATIAL_MAX_RANGE)) {
+		range *= 4.0f;
+		obj_spatial_query_ships(pos, range, team_mask, objnums);
+	}
+
+	SCP_vector<std::pair<float, int>> candidates;
+
+	for (auto objnum : objnums) {
+		candidates.emplace_back(vm_vec_dist(pos, &Objects[objnum].pos), objnum);
+	}
+
+	if (candidates.size() >= count) {
+		std::nth_element(candidates.begin(), candidates.begin() + (count - 1), candidates.end());
+
+		// Every ship which is closer than the count-th candidate is within this range
+		obj_spatial_query_ships(pos, candidates[count - 1].first, team_mask, objnums);
+
+		candidates.clear();
+		for (auto objnum : objnums) {
+			candidates.emplace_back(vm_vec_dist(pos, &Objects[objnum].pos), objnum);
+		}
+	}
+
+	std::sort(candidates.begin(), candidates.end());
+
+	objnums.clear();
+	for (size_t i = 0; i < candidates.size() && i < count; ++i) {
+		objnums.push_back(candidates[i].second);
+	}
+}
+
+void obj_spatial_get_objects(int kind_mask, SCP_vector<object*>& objps)
+{
+	objps.clear();
+
+	if (!Spatial_valid) {
+		for (object *objp = GET_FIRST(&obj_used_list); objp != END_OF_LIST(&obj_used_list); objp = GET_NEXT(objp)) {
+			if (spatial_object_kinds(objp) & kind_mask) {
+				objps.push_back(objp);
+			}
+		}
+
+		return;
+	}
+
+	for (auto& entry : Spatial_objects) {
+		if (!(entry.kinds & kind_mask)) {
+			continue;
+		}
+
+		// objects deleted since the rebuild are freed, new objects in their slot get a new signature
+		object *objp = &Objects[entry.objnum];
+		if ((objp->signature != entry.signature) || (objp->type != entry.type)) {
+			continue;
+		}
+
+		objps.push_back(objp);
+	}
+}
@@ -0,0 +1,85 @@
+#ifndef _OBJECTSPATIAL_H
+#define _OBJECTSPATIAL_H
+
+#include "globalincs/pstypes.h"
+
+class object;
+
+/**
+ * Spatial index over the ships of the mission
+ *
+ * The index is rebuilt at the start of every obj_move_all() and buckets the ships into a hash grid by position and
+ * team, so the AI can look for nearby ships without walking all of Ship_obj_list for every ship it thinks for.
+ *
+ * Ships keep moving while the index is used, so queries are widened by the distance any ship can travel in one frame.
+ * Ships which are warping, docked, or created after the last rebuild are returned by every query with a matching team.
+ * The results are candidates only, callers still do their own distance checks on the current positions. Candidates
+ * are returned in Ship_obj_list order so callers which depend on the iteration order behave like a list walk.
+ *
+ * The rebuild also remembers the few kinds of objects weapon homing and area effects look at, so those don't have to
+ * walk all of obj_used_list (which is mostly lasers) for every missile and shockwave.
+ */
+
+// Kinds of objects obj_spatial_get_objects() can look for
+#define SPATIAL_SHIPS				(1<<0)
+#define SPATIAL_ASTEROIDS			(1<<1)
+#define SPATIAL_WEAPONS_HITPOINTS	(1<<2)	// weapons which can be damaged
+#define SPATIAL_CMEASURES			(1<<3)
+
+/**
+ * @brief Drops the index, queries fall back to walking Ship_obj_list until the next rebuild
+ */
+void obj_spatial_reset();
+
+/**
+ * @brief Rebuilds the index from the current ship positions
+ * @param frametime The length of the frame the index will be used for
+ */
+void obj_spatial_rebuild(float frametime);
+
+/**
+ * @brief Makes sure a ship created after the last rebuild is found by queries. Called from ship_obj_list_add().
+ */
+void obj_spatial_add_ship(int objnum);
+
+/**
+ * @brief Makes sure an object merged into obj_used_list after the last rebuild is found by obj_spatial_get_objects().
+ * Called from obj_merge_created_list().
+ */
+void obj_spatial_add_object(int objnum);
+
+/**
+ * @brief Finds all ships which may be within a range of a position
+ *
+ * Every ship with a matching team whose bounding sphere or bounding box comes within @c range of @c pos, measured with
+ * either vm_vec_dist() or vm_vec_dist_quick(), is returned. Other ships may be returned as well.
+ *
+ * @param pos The center of the query
+ * @param range The maximum distance
+ * @param team_mask An IFF mask of the teams to look for
+ * @param[out] objnums The object numbers of the ships, in Ship_obj_list order
+ */
+void obj_spatial_query_ships(const vec3d* pos, float range, int team_mask, SCP_vector<int>& objnums);
+
+/**
+ * @brief Finds the ships closest to a position
+ *
+ * @param pos The position to measure from
+ * @param team_mask An IFF mask of the teams to look for
+ * @param count The maximum number of ships to return
+ * @param[out] objnums The object numbers of the closest ships, sorted by the distance of their centers to @c pos
+ */
+void obj_spatial_find_nearest_ships(const vec3d* pos, int team_mask, size_t count, SCP_vector<int>& objnums);
+
+/**
+ * @brief Gets all objects of some kinds
+ *
+ * Unlike the ship queries this is exact: the objects are the ones in obj_used_list which are of one of the kinds, in
+ * obj_used_list order. Walking them gives the same results as walking obj_used_list and skipping everything else.
+ *
+ * @param kind_mask The SPATIAL_* kinds to look for
+ * @param[out] objps The objects
+ */
+void obj_spatial_get_objects(int kind_mask, SCP_vector<object*>& objps);
+
+#endif
@@ -14,6 +14,7 @@
 #include <stdio.h>
 #include <stdarg.h>
 #include <string.h>
+#include <mutex>
 
 #include "osapi/DebugWindow.h"
 #include "osapi/osapi.h"
@@ -45,6 +46,10 @@ const char *FreeSpace_logfilename = NULL;
 
 std::unique_ptr<osapi::DebugWindow> debugWindow;
 
+// Bitmaps and sounds are decoded on worker threads which log as well. Recursive since the no filter file warning is
+// printed through outwnd_print() while the lock is held.
+static std::recursive_mutex Outwnd_mutex;
+
 void load_filter_info(void)
 {
 	FILE *fp = NULL;
@@ -182,6 +187,8 @@ void outwnd_print(const char *id, const char *tmp)
   	if ( !outwnd_inited )
   		return;
 
+	std::lock_guard<std::recursive_mutex> guard(Outwnd_mutex);
+
 	if (Outwnd_no_filter_file == 1) {
 		Outwnd_no_filter_file = 2;
 
@@ -282,6 +289,8 @@ void outwnd_close()
 
 		outwnd_printf("General", "... Log closed, %s\n", datestr);
 
+		std::lock_guard<std::recursive_mutex> guard(Outwnd_mutex);
+
 		fclose(Log_fp);
 		Log_fp = NULL;
 	}
@@ -14,6 +14,8 @@
 #include <stdarg.h>
 #include <setjmp.h>
 
+#include <algorithm>
+
 #include "ctype.h"
 #include "globalincs/version.h"
 #include "localization/fhash.h"
@@ -23,6 +25,7 @@
 #include "parse/parselo.h"
 #include "parse/sexp.h"
 #include "ship/ship.h"
+#include "utils/threading.h"
 #include "weapon/weapon.h"
 
 
@@ -54,6 +57,35 @@ static int Parsing_paused = 0;
 void allocate_mission_text(size_t size);
 static size_t Mission_text_size = 0;
 
+// Where the lines of recently processed texts start, so get_line_num() doesn't have to count them every time it's
+// called. Parsing may be paused to read another file in between, so more than one text is kept.
+struct parse_line_index {
+	const char *text = nullptr;
+	const char *end = nullptr;			// the EOF_CHAR the text ends with
+	SCP_vector<size_t> line_starts;		// offsets of the characters following each EOLN
+};
+
+#define MAX_PARSE_LINE_INDICES	4
+static parse_line_index Parse_line_indices[MAX_PARSE_LINE_INDICES];
+static int Parse_next_line_index = 0;
+
+// Case insensitive check if text starts with pstr, the same as !strnicmp(pstr, text, strlen(pstr)) but in a single pass.
+// If it does and len is given, the length of pstr is stored there.
+static inline bool token_matches(const char *pstr, const char *text, size_t *len = nullptr)
+{
+	const char *p = pstr;
+
+	for (; *p != '\0'; ++p, ++text) {
+		if ((*p != *text) && (tolower((unsigned char)*p) != tolower((unsigned char)*text)))
+			return false;
+	}
+
+	if (len != nullptr)
+		*len = (size_t)(p - pstr);
+
+	return true;
+}
+
 
 //	Return true if this character is white space, else false.
 int is_white_space(char ch)
@@ -214,11 +246,67 @@ char *next_tokens()
 	return Error_str;
 }
 
+// Drops the line starts of all texts which overlap the memory from text to end, e.g. since it is about to be freed
+static void forget_line_starts(const char *text, const char *end)
+{
+	for (auto &entry : Parse_line_indices) {
+		if ((entry.text != nullptr) && (entry.text <= end) && (text <= entry.end)) {
+			entry.text = nullptr;
+			entry.end = nullptr;
+			entry.line_starts.clear();
+		}
+	}
+}
+
+// Indexes the line starts of text which has just been processed, the text ends at the EOF_CHAR end points to
+static void index_line_starts(const char *text, const char *end)
+{
+	parse_line_index *index = nullptr;
+
+	// reuse the index of a buffer which has been processed before, e.g. Mission_text
+	for (auto &entry : Parse_line_indices) {
+		if (entry.text == text) {
+			index = &entry;
+			break;
+		}
+	}
+
+	// any other text which was in this memory is gone
+	forget_line_starts(text, end);
+
+	if (index == nullptr) {
+		index = &Parse_line_indices[Parse_next_line_index];
+		Parse_next_line_index = (Parse_next_line_index + 1) % MAX_PARSE_LINE_INDICES;
+	}
+
+	index->text = text;
+	index->end = end;
+	index->line_starts.clear();
+
+	for (auto p = text; (p = (const char *)memchr(p, EOLN, end - p)) != nullptr; )
+		index->line_starts.push_back((size_t)(++p - text));
+}
+
 //	Return the line number given by the current mission pointer, ie Mp.
-//	A very slow function (scans all processed text), but who cares how long
-//	an error reporting function takes?
+//	Texts read through the usual functions have their line starts indexed, so
+//	this only scans the text if Mp points somewhere else.
 int get_line_num()
 {
+	for (auto &index : Parse_line_indices) {
+		if ((index.text == nullptr) || (Mp < index.text) || (Mp > index.end))
+			continue;
+
+		// the buffer has been changed in place since it was indexed, shouldn't happen since freed and reprocessed
+		// texts are forgotten
+		if (*index.end != EOF_CHAR) {
+			index.text = nullptr;
+			continue;
+		}
+
+		auto offset = (size_t)(Mp - index.text);
+		return 1 + (int)(std::upper_bound(index.line_starts.begin(), index.line_starts.end(), offset) - index.line_starts.begin());
+	}
+
 	int	count = 1;
 	int	incomment = 0;
 	int	multiline = 0;
@@ -297,13 +385,16 @@ void advance_to_eoln(const char *more_terminators)
 
 	Assert((more_terminators == NULL) || (strlen(more_terminators) < 125));
 
+	if (more_terminators == NULL) {
+		while ((*Mp != EOLN) && (*Mp != EOF_CHAR))
+			Mp++;
+		return;
+	}
+
 	terminators[0] = EOLN;
 	terminators[1] = EOF_CHAR;
 	terminators[2] = 0;
-	if (more_terminators != NULL)
-		strcat_s(terminators, more_terminators);
-	else
-		terminators[2] = 0;
+	strcat_s(terminators, more_terminators);
 
 	while (strchr(terminators, *Mp) == NULL)
 		Mp++;
@@ -333,18 +424,15 @@ void advance_to_next_white()
 // block was reached.
 int skip_to_string(const char *pstr, const char *end)
 {
-	ignore_white_space();
-	auto len = strlen(pstr);
-	size_t len2 = 0;
+	size_t len = 0;
 
-	if (end)
-		len2 = strlen(end);
+	ignore_white_space();
 
-	while ((*Mp != EOF_CHAR) && strnicmp(pstr, Mp, len)) {
+	while ((*Mp != EOF_CHAR) && !token_matches(pstr, Mp, &len)) {
 		if (end && *Mp == '#')
 			return 0;
 
-		if (end && !strnicmp(end, Mp, len2))
+		if (end && token_matches(end, Mp))
 			return -1;
 
 		advance_to_eoln(NULL);
@@ -354,7 +442,7 @@ int skip_to_string(const char *pstr, const char *end)
 	if (!Mp || (*Mp == EOF_CHAR))
 		return 0;
 
-	Mp += strlen(pstr);
+	Mp += len;
 	return 1;
 }
 
@@ -363,18 +451,12 @@ int skip_to_string(const char *pstr, const char *end)
 int skip_to_start_of_string(const char *pstr, const char *end)
 {
 	ignore_white_space();
-	auto len = strlen(pstr);
-	size_t endlen;
-	if(end)
-		endlen = strlen(end);
-	else
-		endlen = 0;
 
-	while ( (*Mp != EOF_CHAR) && strnicmp(pstr, Mp, len) ) {
+	while ( (*Mp != EOF_CHAR) && !token_matches(pstr, Mp) ) {
 		if (end && *Mp == '#')
 			return 0;
 
-		if (end && !strnicmp(end, Mp, endlen))
+		if (end && token_matches(end, Mp))
 			return 0;
 
 		advance_to_eoln(NULL);
@@ -390,21 +472,13 @@ int skip_to_start_of_string(const char *pstr, const char *end)
 // Advance to start of either pstr1 or pstr2.  Return 0 is successful, otherwise return !0
 int skip_to_start_of_string_either(const char *pstr1, const char *pstr2, const char *end)
 {
-	size_t len1, len2, endlen;
-
 	ignore_white_space();
-	len1 = strlen(pstr1);
-	len2 = strlen(pstr2);
-	if(end)
-		endlen = strlen(end);
-	else
-		endlen = 0;
 
-	while ( (*Mp != EOF_CHAR) && strnicmp(pstr1, Mp, len1) && strnicmp(pstr2, Mp, len2) ) {
+	while ( (*Mp != EOF_CHAR) && !token_matches(pstr1, Mp) && !token_matches(pstr2, Mp) ) {
 		if (end && *Mp == '#')
 			return 0;
 
-		if (end && !strnicmp(end, Mp, endlen))
+		if (end && token_matches(end, Mp))
 			return 0;
 
 		advance_to_eoln(NULL);
@@ -426,10 +500,11 @@ int skip_to_start_of_string_either(const char *pstr1, const char *pstr2, const c
 int required_string(const char *pstr)
 {
 	int	count = 0;
+	size_t len = 0;
 
 	ignore_white_space();
 
-	while (strnicmp(pstr, Mp, strlen(pstr)) && (count < RS_MAX_TRIES)) {
+	while (!token_matches(pstr, Mp, &len) && (count < RS_MAX_TRIES)) {
 		error_display(1, "Missing required token: [%s]. Found [%.32s] instead.\n", pstr, next_tokens());
 		advance_to_eoln(NULL);
 		ignore_white_space();
@@ -442,7 +517,7 @@ int required_string(const char *pstr)
         throw parse::ParseException("Required string not found");
 	}
 
-	Mp += strlen(pstr);
+	Mp += len;
 	diag_printf("Found required string [%s]\n", token_found = pstr);
 	return 1;
 }
@@ -481,7 +556,7 @@ int check_for_string(const char *pstr)
 {
 	ignore_white_space();
 
-	if (!strnicmp(pstr, Mp, strlen(pstr)))
+	if (token_matches(pstr, Mp))
 		return 1;
 
 	return 0;
@@ -490,7 +565,7 @@ int check_for_string(const char *pstr)
 // like check for string, but doesn't skip past any whitespace
 int check_for_string_raw(const char *pstr)
 {
-	if (!strnicmp(pstr, Mp, strlen(pstr)))
+	if (token_matches(pstr, Mp))
 		return 1;
 
 	return 0;
@@ -501,10 +576,12 @@ int check_for_string_raw(const char *pstr)
 //	If found, point past string, else don't update pointer.
 int optional_string(const char *pstr)
 {
+	size_t len;
+
 	ignore_white_space();
 
-	if (!strnicmp(pstr, Mp, strlen(pstr))) {
-		Mp += strlen(pstr);
+	if (token_matches(pstr, Mp, &len)) {
+		Mp += len;
 		return 1;
 	}
 
@@ -513,13 +590,15 @@ int optional_string(const char *pstr)
 
 int optional_string_either(const char *str1, const char *str2)
 {
+	size_t len;
+
 	ignore_white_space();
 
-	if ( !strnicmp(str1, Mp, strlen(str1)) ) {
-		Mp += strlen(str1);
+	if ( token_matches(str1, Mp, &len) ) {
+		Mp += len;
 		return 0;
-	} else if ( !strnicmp(str2, Mp, strlen(str2)) ) {
-		Mp += strlen(str2);
+	} else if ( token_matches(str2, Mp, &len) ) {
+		Mp += len;
 		return 1;
 	}
 
@@ -532,6 +611,7 @@ int optional_string_one_of(int arg_count, ...)
 	Assertion(arg_count > 0, "optional_string_one_of() called with arg_count of %d; get a coder!\n", arg_count);
 	int idx, found = -1;
 	char *pstr;
+	size_t len;
 	va_list vl;
 
 	ignore_white_space();
@@ -541,9 +621,9 @@ int optional_string_one_of(int arg_count, ...)
 	{
 		pstr = va_arg(vl, char*);
 
-		if ( !strnicmp(pstr, Mp, strlen(pstr)) )
+		if ( token_matches(pstr, Mp, &len) )
 		{
-			Mp += strlen(pstr);
+			Mp += len;
 			found = idx;
 			break;
 		}
@@ -562,8 +642,8 @@ int required_string_fred(char *pstr, char *end)
 		return 0;
 
 	ignore_white_space();
-	while (*Mp != EOF_CHAR && strnicmp(pstr, Mp, strlen(pstr))) {
-		if ((*Mp == '#') || (end && !strnicmp(end, Mp, strlen(end)))) {
+	while (*Mp != EOF_CHAR && !token_matches(pstr, Mp)) {
+		if ((*Mp == '#') || (end && token_matches(end, Mp))) {
 			Mp = NULL;
 			break;
 		}
@@ -599,9 +679,9 @@ int optional_string_fred(char *pstr, char *end, char *end2)
 		return 0;
 
 	ignore_white_space();
-	while ((*Mp != EOF_CHAR) && strnicmp(pstr, Mp, strlen(pstr))) {
-		if ((*Mp == '#') || (end && !strnicmp(end, Mp, strlen(end))) ||
-			(end2 && !strnicmp(end2, Mp, strlen(end2)))) {
+	while ((*Mp != EOF_CHAR) && !token_matches(pstr, Mp)) {
+		if ((*Mp == '#') || (end && token_matches(end, Mp)) ||
+			(end2 && token_matches(end2, Mp))) {
 			Mp = NULL;
 			break;
 		}
@@ -638,11 +718,11 @@ int required_string_either(const char *str1, const char *str2)
 	ignore_white_space();
 
 	for (int count = 0; count < RS_MAX_TRIES; ++count) {
-		if (strnicmp(str1, Mp, strlen(str1)) == 0) {
+		if (token_matches(str1, Mp)) {
 			// Mp += strlen(str1);
 			diag_printf("Found required string [%s]\n", token_found = str1);
 			return 0;
-		} else if (strnicmp(str2, Mp, strlen(str2)) == 0) {
+		} else if (token_matches(str2, Mp)) {
 			// Mp += strlen(str2);
 			diag_printf("Found required string [%s]\n", token_found = str2);
 			return 1;
@@ -682,7 +762,7 @@ int required_string_one_of(int arg_count, ...)
 		va_start(vl, arg_count);
 		for (idx = 0; idx < arg_count; idx++) {
 			expected = va_arg(vl, char*);
-			if (strnicmp(expected, Mp, strlen(expected)) == 0) {
+			if (token_matches(expected, Mp)) {
 				diag_printf("Found required string [%s]", token_found = expected);
 				va_end(vl);
 				return idx;
@@ -722,12 +802,12 @@ int required_string_either_fred(const char *str1, const char *str2)
 	ignore_white_space();
 
 	while (*Mp != EOF_CHAR) {
-		if (!strnicmp(str1, Mp, strlen(str1))) {
+		if (token_matches(str1, Mp)) {
 			// Mp += strlen(str1);
 			diag_printf("Found required string [%s]\n", token_found = str1);
 			return fred_parse_flag = 0;
 
-		} else if (!strnicmp(str2, Mp, strlen(str2))) {
+		} else if (token_matches(str2, Mp)) {
 			// Mp += strlen(str2);
 			diag_printf("Found required string [%s]\n", token_found = str2);
 			return fred_parse_flag = 1;
@@ -2010,6 +2090,43 @@ int parse_get_line(char *lineout, int max_line_len, char *start, int max_size, c
 	return  num_chars_read;
 }
 
+// A table file which parse_modular_table() has read and stripped of comments ahead of time
+struct preprocessed_file {
+	SCP_string filename;
+	int mode = CF_TYPE_ANY;
+	bool valid = false;				// if not, read_file_text() reads the file as usual and reports any errors
+	SCP_vector<char> raw_text;		// sized like Mission_text_raw would be for this file
+	SCP_vector<char> processed_text;
+	size_t eof_offset = 0;			// where the EOF_CHAR of the processed text is
+};
+
+static SCP_vector<preprocessed_file> Preprocessed_files;
+
+// Copies a preprocessed file into Mission_text and Mission_text_raw, returns false if there is none for this file
+static bool use_preprocessed_file(const char *filename, int mode)
+{
+	for (auto &file : Preprocessed_files) {
+		if (!file.valid || (file.mode != mode) || stricmp(file.filename.c_str(), filename))
+			continue;
+
+		// the buffers have one byte more than the file, just like the ones read_raw_file_text() allocates
+		allocate_mission_text(file.raw_text.size() - 1);
+		memcpy(Mission_text_raw, file.raw_text.data(), file.raw_text.size());
+		memcpy(Mission_text, file.processed_text.data(), file.processed_text.size());
+
+		index_line_starts(Mission_text, Mission_text + file.eof_offset);
+
+		// every file is only parsed once, don't hold on to the copy
+		file.valid = false;
+		SCP_vector<char>().swap(file.raw_text);
+		SCP_vector<char>().swap(file.processed_text);
+
+		return true;
+	}
+
+	return false;
+}
+
 //	Read mission text, stripping comments.
 //	When a comment is found, it is removed.  If an entire line
 //	consisted of a comment, a blank line is left in the input file.
@@ -2027,6 +2144,10 @@ void read_file_text(const char *filename, int mode, char *processed_text, char *
 		Error(LOCATION, "ERROR: Neither processed_text nor raw_text may be NULL when parsing is paused!!\n");
 	}
 
+	// parse_modular_table() may have done all the work already
+	if ( (processed_text == NULL) && (raw_text == NULL) && use_preprocessed_file(filename, mode) )
+		return;
+
 	// read the raw text
 	read_raw_file_text(filename, mode, raw_text);
 
@@ -2102,6 +2223,8 @@ void stop_parse()
 	Assert( !Parsing_paused );
 
 	if (Mission_text != NULL) {
+		forget_line_starts(Mission_text, Mission_text + Mission_text_size);
+
 		vm_free(Mission_text);
 		Mission_text = NULL;
 	}
@@ -2122,6 +2245,8 @@ void allocate_mission_text(size_t size)
 	size += 1;
 
 	if (size <= Mission_text_size) {
+		forget_line_starts(Mission_text, Mission_text + Mission_text_size);
+
 		// Make sure that a new parsing session does not use uninitialized data.
 		memset( Mission_text, 0, sizeof(char) * Mission_text_size );
 		memset( Mission_text_raw, 0, sizeof(char) * Mission_text_size);
@@ -2136,6 +2261,8 @@ void allocate_mission_text(size_t size)
 	}
 
 	if (Mission_text != NULL) {
+		forget_line_starts(Mission_text, Mission_text + Mission_text_size);
+
 		vm_free(Mission_text);
 		Mission_text = NULL;
 	}
@@ -2225,8 +2352,9 @@ void read_raw_file_text(const char *filename, int mode, char *raw_text)
 	cfclose(mf);
 }
 
-// Goober5000
-void process_raw_file_text(char *processed_text, char *raw_text)
+// Strips the comments from raw_text into processed_text and returns a pointer to the EOF_CHAR the processed text ends
+// with. Doesn't touch any global parser state so worker threads can use it.
+static char *strip_file_text(char *processed_text, char *raw_text)
 {
 	char	*mp;
 	char	*mp_raw;
@@ -2236,15 +2364,6 @@ void process_raw_file_text(char *processed_text, char *raw_text)
 	bool in_multiline_comment_b = false;
 	int raw_text_len = (int)strlen(raw_text);
 
-	if (processed_text == NULL)
-		processed_text = Mission_text;
-
-	if (raw_text == NULL)
-		raw_text = Mission_text_raw;
-
-	Assert( processed_text != NULL );
-	Assert( raw_text != NULL );
-
 	mp = processed_text;
 	mp_raw = raw_text;
 
@@ -2279,6 +2398,8 @@ void process_raw_file_text(char *processed_text, char *raw_text)
 	}
 
 	*mp = *mp_raw = EOF_CHAR;
+
+	return mp;
 /*
 	while (cfgets(outbuf, PARSE_BUF_SIZE, mf) != NULL) {
 		if (strlen(outbuf) >= PARSE_BUF_SIZE-1)
@@ -2300,6 +2421,23 @@ void process_raw_file_text(char *processed_text, char *raw_text)
 
 }
 
+// Goober5000
+void process_raw_file_text(char *processed_text, char *raw_text)
+{
+	if (processed_text == NULL)
+		processed_text = Mission_text;
+
+	if (raw_text == NULL)
+		raw_text = Mission_text_raw;
+
+	Assert( processed_text != NULL );
+	Assert( raw_text != NULL );
+
+	auto end = strip_file_text(processed_text, raw_text);
+
+	index_line_starts(processed_text, end);
+}
+
 void debug_show_mission_text()
 {
 	char	*mp = Mission_text;
@@ -4230,7 +4368,34 @@ void parse_int_list(int *ilist, int size)
 	}
 }
 
+// Reads a table file and strips its comments, called on the worker threads
+static void preprocess_file(preprocessed_file &file)
+{
+	// this also fails if the worker thread couldn't get a file block, the file is then read on the main thread
+	CFILE *mf = cfopen(file.filename.c_str(), "rb", CFILE_NORMAL, file.mode);
+	if (mf == NULL)
+		return;
+
+	int file_len = cfilelength(mf);
+
+	if (file_len > 0) {
+		file.raw_text.assign(file_len + 2, '\0');
+
+		// encrypted and Unicode files are left to read_file_text() which knows how to deal with them
+		if ( (cfread(file.raw_text.data(), file_len, 1, mf) == 1) && !is_encrypted(file.raw_text.data()) && !is_unicode(file.raw_text.data()) ) {
+			file.processed_text.assign(file.raw_text.size(), '\0');
+			file.eof_offset = strip_file_text(file.processed_text.data(), file.raw_text.data()) - file.processed_text.data();
+			file.valid = true;
+		} else {
+			file.raw_text.clear();
+		}
+	}
+
+	cfclose(mf);
+}
+
 // parse a modular table of type "name_check" and parse it using the specified function callback
+extern int Cmdline_parse_threads;
 int parse_modular_table(const char *name_check, void (*parse_callback)(const char *filename), int path_type, int sort_type)
 {
 	SCP_vector<SCP_string> tbl_file_names;
@@ -4243,15 +4408,35 @@ int parse_modular_table(const char *name_check, void (*parse_callback)(const cha
 
 	num_files = cf_get_file_list(tbl_file_names, path_type, name_check, sort_type);
 
+	for (i = 0; i < num_files; i++)
+		tbl_file_names[i] += ".tbm";
+
+	// With -parse_threads all the files are read and stripped of comments on the worker threads first. The callbacks
+	// still parse them one after another in the usual order, read_file_text() just hands them the finished text.
+	if (Cmdline_parse_threads && (threading::num_workers() > 0) && (num_files > 1)) {
+		Preprocessed_files.resize(num_files);
+		for (i = 0; i < num_files; i++) {
+			Preprocessed_files[i].filename = tbl_file_names[i];
+			Preprocessed_files[i].mode = path_type;
+		}
+
+		threading::parallel_for(Preprocessed_files.size(), 1, [](size_t begin, size_t end) {
+			for (size_t idx = begin; idx < end; ++idx) {
+				preprocess_file(Preprocessed_files[idx]);
+			}
+		});
+	}
+
 	Parsing_modular_table = true;
 
 	for (i = 0; i < num_files; i++){
-		tbl_file_names[i] += ".tbm";
 		mprintf(("TBM  =>  Starting parse of '%s' ...\n", tbl_file_names[i].c_str()));
 		(*parse_callback)(tbl_file_names[i].c_str());
 	}
 
 	Parsing_modular_table = false;
 
+	Preprocessed_files.clear();
+
 	return num_files;
 }
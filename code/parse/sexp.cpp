@@ -845,6 +845,9 @@ float	Training_context_distance;
 int Num_sexp_nodes = 0;
 sexp_node *Sexp_nodes = NULL;
 
+// mission time of the last change to the mission log, see sexp_dependencies_unchanged()
+static fix Sexp_log_change_time = 0;
+
 sexp_variable Sexp_variables[MAX_SEXP_VARIABLES];
 sexp_variable Block_variables[MAX_SEXP_VARIABLES];			// used for compatibility with retail. 
 
@@ -1107,6 +1110,7 @@ void init_sexp()
 	sexp_nodes_init();
 	init_sexp_vars();
 	Locked_sexp_false = Locked_sexp_true = -1;
+	Sexp_log_change_time = 0;
 
 	Locked_sexp_false = alloc_sexp("false", SEXP_LIST, SEXP_ATOM_OPERATOR, -1, -1);
 	Assert(Locked_sexp_false != -1);
@@ -22537,6 +22541,240 @@ int is_sexp_true(int cur_node, int referenced_node)
 	return (result == SEXP_TRUE); // note: any SEXP_KNOWN_TRUE result will return SEXP_TRUE
 }
 
+// -delay operators with a longer delay than this are always evaluated
+#define SEXP_DEPENDENCIES_MAX_DELAY		(60 * 60)
+
+void sexp_mark_log_changed()
+{
+	Sexp_log_change_time = Missiontime;
+}
+
+/**
+ * Is this node an argument which always evaluates to the same thing?
+ */
+static bool sexp_dependencies_constant_arg(int node)
+{
+	if ((node < 0) || (Sexp_nodes[node].first != -1) || (Sexp_nodes[node].subtype == SEXP_ATOM_OPERATOR)) {
+		return false;
+	}
+
+	if (Sexp_nodes[node].type & SEXP_FLAG_VARIABLE) {
+		return false;
+	}
+
+	return strcmp(Sexp_nodes[node].text, SEXP_ARGUMENT_STRING) != 0;
+}
+
+static bool sexp_dependencies_constant_args(int node)
+{
+	for (; node != -1; node = CDR(node)) {
+		if (!sexp_dependencies_constant_arg(node)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * Adds the delay argument of a -delay operator
+ */
+static void sexp_dependencies_add_delay(sexp_dependencies *deps, int node)
+{
+	int delay = atoi(CTEXT(node));
+
+	if (delay > SEXP_DEPENDENCIES_MAX_DELAY) {
+		deps->log_driven = false;
+		return;
+	}
+
+	deps->max_delay = MAX(deps->max_delay, i2f(delay));
+}
+
+/**
+ * Walks the condition at node, clearing deps->log_driven if it depends on anything else than the mission log or events
+ */
+static void sexp_dependencies_collect(sexp_dependencies *deps, int node)
+{
+	if (!deps->log_driven || node < 0) {
+		return;
+	}
+
+	// a list is evaluated as its first element
+	if (Sexp_nodes[node].first != -1) {
+		sexp_dependencies_collect(deps, CAR(node));
+		return;
+	}
+
+	if (Sexp_nodes[node].subtype != SEXP_ATOM_OPERATOR) {
+		deps->log_driven = false;
+		return;
+	}
+
+	int args = CDR(node);
+
+	switch (get_operator_const(node)) {
+		case OP_TRUE:
+		case OP_FALSE:
+			break;
+
+		case OP_AND:
+		case OP_OR:
+		case OP_NOT:
+			for (int n = args; n != -1; n = CDR(n)) {
+				sexp_dependencies_collect(deps, n);
+			}
+			break;
+
+		case OP_IS_DESTROYED:
+		case OP_IS_SUBSYSTEM_DESTROYED:
+		case OP_HAS_ARRIVED:
+		case OP_HAS_DEPARTED:
+		case OP_IS_DISABLED:
+		case OP_IS_DISARMED:
+		case OP_HAS_DOCKED:
+		case OP_HAS_UNDOCKED:
+		case OP_GOAL_INCOMPLETE:
+			if (!sexp_dependencies_constant_args(args)) {
+				deps->log_driven = false;
+			}
+			break;
+
+		case OP_IS_DESTROYED_DELAY:
+		case OP_HAS_ARRIVED_DELAY:
+		case OP_HAS_DEPARTED_DELAY:
+		case OP_IS_DISABLED_DELAY:
+		case OP_IS_DISARMED_DELAY:
+			if (!sexp_dependencies_constant_args(args)) {
+				deps->log_driven = false;
+			} else {
+				sexp_dependencies_add_delay(deps, args);
+			}
+			break;
+
+		case OP_IS_SUBSYSTEM_DESTROYED_DELAY:
+			if (!sexp_dependencies_constant_args(args) || CDDR(args) == -1) {
+				deps->log_driven = false;
+			} else {
+				sexp_dependencies_add_delay(deps, CDDR(args));
+			}
+			break;
+
+		case OP_HAS_DOCKED_DELAY:
+		case OP_HAS_UNDOCKED_DELAY:
+			if (!sexp_dependencies_constant_args(args) || CDDDR(args) == -1) {
+				deps->log_driven = false;
+			} else {
+				sexp_dependencies_add_delay(deps, CDDDR(args));
+			}
+			break;
+
+		case OP_GOAL_TRUE_DELAY:
+		case OP_GOAL_FALSE_DELAY:
+			if (!sexp_dependencies_constant_args(args) || CDR(args) == -1) {
+				deps->log_driven = false;
+			} else {
+				sexp_dependencies_add_delay(deps, CDR(args));
+			}
+			break;
+
+		// these only stay false while the event is unresolved and false, which is checked on every use
+		case OP_EVENT_TRUE_DELAY:
+		case OP_EVENT_FALSE_DELAY:
+		case OP_EVENT_TRUE_MSECS_DELAY:
+		case OP_EVENT_FALSE_MSECS_DELAY:
+			if (!sexp_dependencies_constant_args(args)) {
+				deps->log_driven = false;
+			} else {
+				int i;
+				for (i = 0; i < Num_mission_events; i++) {
+					if (!stricmp(Mission_events[i].name, CTEXT(args))) {
+						deps->events.push_back(i);
+						break;
+					}
+				}
+
+				if (i == Num_mission_events) {
+					deps->log_driven = false;
+				}
+			}
+			break;
+
+		default:
+			deps->log_driven = false;
+			break;
+	}
+}
+
+void sexp_dependencies_reset(sexp_dependencies *deps)
+{
+	deps->formula = -1;
+	deps->log_driven = false;
+	deps->max_delay = 0;
+	deps->events.clear();
+	deps->false_since = -1;
+}
+
+/**
+ * Checks if a formula is certain to still be false
+ *
+ * @param deps		What was found out about the formula so far
+ * @param formula	The formula which is about to be evaluated
+ *
+ * @return true if the formula was false when it was last evaluated and nothing it depends on has changed since
+ */
+bool sexp_dependencies_unchanged(sexp_dependencies *deps, int formula)
+{
+	if (deps->formula != formula) {
+		sexp_dependencies_reset(deps);
+		deps->formula = formula;
+
+		if (formula < 0) {
+			return false;
+		}
+
+		deps->log_driven = true;
+
+		// the actions of a when are only run once the condition is true
+		int node = formula;
+		if (Sexp_nodes[node].first != -1) {
+			node = CAR(node);
+		}
+		if ((Sexp_nodes[node].subtype == SEXP_ATOM_OPERATOR) && (get_operator_const(node) == OP_WHEN)) {
+			sexp_dependencies_collect(deps, CADR(node));
+		} else {
+			sexp_dependencies_collect(deps, node);
+		}
+	}
+
+	if (!deps->log_driven || deps->false_since < 0) {
+		return false;
+	}
+
+	// anything logged in the same frame as the last evaluation might not have been seen by it
+	if (deps->false_since <= Sexp_log_change_time + deps->max_delay) {
+		return false;
+	}
+
+	for (auto event : deps->events) {
+		if ((Mission_events[event].formula >= 0) && (Mission_events[event].result == SEXP_FALSE)) {
+			continue;
+		}
+
+		return false;
+	}
+
+	return true;
+}
+
+/**
+ * Records the result of evaluating the formula last passed to sexp_dependencies_unchanged()
+ */
+void sexp_dependencies_evaluated(sexp_dependencies *deps, int result)
+{
+	deps->false_since = (result == SEXP_FALSE) ? Missiontime : -1;
+}
+
 
 /**
 * 
@@ -1175,6 +1175,28 @@ extern int query_sexp_ai_goal_valid(int sexp_ai_goal, int ship);
 int query_node_in_sexp(int node, int sexp);
 void flush_sexp_tree(int node);
 
+/**
+ * What a mission formula depends on, so formulas which can't have changed don't have to be evaluated again
+ *
+ * This applies to conditions built from and, or, not and the operators which only look at the mission log or at
+ * other events, with constant arguments. Such a condition can only become true when an entry is added to the mission
+ * log, when the delay of a -delay operator runs out, or when one of the events it checks is resolved.
+ */
+typedef struct sexp_dependencies {
+	int formula;				// the formula the rest was determined for, -1 if not determined yet
+	bool log_driven;			// the formula only depends on the mission log and the events below
+	fix max_delay;				// the longest delay of a -delay operator in the formula
+	SCP_vector<int> events;		// the events checked by the formula
+	fix false_since;			// mission time of the last evaluation if it returned false, -1 otherwise
+
+	sexp_dependencies() : formula(-1), log_driven(false), max_delay(0), false_since(-1) {}
+} sexp_dependencies;
+
+void sexp_dependencies_reset(sexp_dependencies *deps);
+bool sexp_dependencies_unchanged(sexp_dependencies *deps, int formula);
+void sexp_dependencies_evaluated(sexp_dependencies *deps, int result);
+void sexp_mark_log_changed();
+
 // sexp_variable
 void sexp_modify_variable(const char *text, int index, bool sexp_callback = true);
 int get_index_sexp_variable_from_node (int node);
@@ -20,10 +20,10 @@ void SourceOrigin::getGlobalPosition(vec3d* posOut) const {
 			break;
 		}
 		case SourceOriginType::PARTICLE: {
-			*posOut = m_origin.m_particle.lock()->pos;
+			*posOut = m_origin.m_particle.pos();
 
 			matrix m = vmd_identity_matrix;
-			vec3d dir = m_origin.m_particle.lock()->velocity;
+			vec3d dir = m_origin.m_particle.velocity();
 
 			vm_vec_normalize_safe(&dir);
 			vm_vector_2_matrix_norm(&m, &dir);
@@ -81,7 +81,7 @@ vec3d SourceOrigin::getVelocity() const {
 		case SourceOriginType::OBJECT:
 			return m_origin.m_object.objp->phys_info.vel;
 		case SourceOriginType::PARTICLE:
-			return m_origin.m_particle.lock()->velocity;
+			return m_origin.m_particle.velocity();
 		default:
 			return vmd_zero_vector;
 	}
@@ -108,9 +108,9 @@ void SourceOrigin::moveToObject(object* objp, vec3d* offset) {
 	m_offset = *offset;
 }
 
-void SourceOrigin::moveToParticle(WeakParticlePtr weakParticlePtr) {
+void SourceOrigin::moveToParticle(const ParticleHandle& particle) {
 	m_originType = SourceOriginType::PARTICLE;
-	m_origin.m_particle = weakParticlePtr;
+	m_origin.m_particle = particle;
 }
 
 bool SourceOrigin::isValid() const {
@@ -140,7 +140,7 @@ bool SourceOrigin::isValid() const {
 			return wp->weapon_state == m_weaponState;
 		}
 		case SourceOriginType::PARTICLE:
-			return !m_origin.m_particle.expired();
+			return m_origin.m_particle.isValid();
 		case SourceOriginType::VECTOR:
 			return true;
 	}
@@ -48,7 +48,7 @@ class SourceOrigin {
 
 		object_h m_object;
 
-		WeakParticlePtr m_particle;
+		ParticleHandle m_particle;
 	} m_origin;
 
 	WeaponState m_weaponState;
@@ -117,9 +117,9 @@ class SourceOrigin {
 
 	/**
 	 * @brief Moves the source to the specified particle
-	 * @param weakParticlePtr The hosting particle
+	 * @param particle The hosting particle
 	 */
-	void moveToParticle(WeakParticlePtr weakParticlePtr);
+	void moveToParticle(const ParticleHandle& particle);
 
 	friend class ParticleSource;
 };
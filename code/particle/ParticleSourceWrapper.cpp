@@ -59,11 +59,11 @@ namespace particle
 		}
 	}
 
-	void ParticleSourceWrapper::moveToParticle(WeakParticlePtr ptr)
+	void ParticleSourceWrapper::moveToParticle(const ParticleHandle& handle)
 	{
 		for (auto& source : m_sources)
 		{
-			source->getOrigin()->moveToParticle(ptr);
+			source->getOrigin()->moveToParticle(handle);
 		}
 	}
 
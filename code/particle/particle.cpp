@@ -29,7 +29,169 @@ using namespace particle;
 namespace
 {
 	int Num_particles = 0;
-	static SCP_vector<ParticlePtr> Particles;
+
+	static_assert(sizeof(vec3d) == 3 * sizeof(float), "move_all() treats the position arrays as flat float arrays!");
+
+	/**
+	 * All live particles, stored as a structure of arrays so that the per frame update only streams through the data
+	 * it actually needs. Particles are kept densely packed, removing one moves the last particle into its place.
+	 */
+	struct particle_store
+	{
+		// data which is updated every frame
+		SCP_vector<vec3d> pos;				// position
+		SCP_vector<vec3d> velocity;			// velocity
+		SCP_vector<float> age;				// How long it's been alive
+		SCP_vector<float> max_life;			// How much life we had
+		SCP_vector<float> radius;			// radius
+
+		// data which is only needed for rendering or for attached particles
+		SCP_vector<int> type;				// type
+		SCP_vector<int> optional_data;		// depends on type
+		SCP_vector<int> nframes;			// If an ani, how many frames?
+		SCP_vector<int> attached_objnum;	// if this is set, pos is relative to the attached object. velocity is ignored
+		SCP_vector<int> attached_sig;		// to check for dead/nonexistent objects
+		SCP_vector<ubyte> reverse;			// play any animations in reverse
+		SCP_vector<int> particle_index;		// used to pick the orientation of the particle
+
+		SCP_vector<uint> slot;				// the handle slot of the particle
+
+		size_t size() const
+		{
+			return pos.size();
+		}
+
+		void reserve(size_t count)
+		{
+			pos.reserve(count);
+			velocity.reserve(count);
+			age.reserve(count);
+			max_life.reserve(count);
+			radius.reserve(count);
+			type.reserve(count);
+			optional_data.reserve(count);
+			nframes.reserve(count);
+			attached_objnum.reserve(count);
+			attached_sig.reserve(count);
+			reverse.reserve(count);
+			particle_index.reserve(count);
+			slot.reserve(count);
+		}
+
+		void clear()
+		{
+			pos.clear();
+			velocity.clear();
+			age.clear();
+			max_life.clear();
+			radius.clear();
+			type.clear();
+			optional_data.clear();
+			nframes.clear();
+			attached_objnum.clear();
+			attached_sig.clear();
+			reverse.clear();
+			particle_index.clear();
+			slot.clear();
+		}
+
+		// Moves the last particle into the place of the given one and drops the last entry
+		void swap_remove(size_t idx)
+		{
+			auto last = size() - 1;
+
+			if (idx != last)
+			{
+				pos[idx] = pos[last];
+				velocity[idx] = velocity[last];
+				age[idx] = age[last];
+				max_life[idx] = max_life[last];
+				radius[idx] = radius[last];
+				type[idx] = type[last];
+				optional_data[idx] = optional_data[last];
+				nframes[idx] = nframes[last];
+				attached_objnum[idx] = attached_objnum[last];
+				attached_sig[idx] = attached_sig[last];
+				reverse[idx] = reverse[last];
+				particle_index[idx] = particle_index[last];
+				slot[idx] = slot[last];
+			}
+
+			pos.pop_back();
+			velocity.pop_back();
+			age.pop_back();
+			max_life.pop_back();
+			radius.pop_back();
+			type.pop_back();
+			optional_data.pop_back();
+			nframes.pop_back();
+			attached_objnum.pop_back();
+			attached_sig.pop_back();
+			reverse.pop_back();
+			particle_index.pop_back();
+			slot.pop_back();
+		}
+	};
+
+	particle_store Particles;
+
+	// Handle slots. Each slot knows where its particle currently is in Particles and the generation of the slot which is
+	// increased every time a particle in it is removed.
+	SCP_vector<uint> Slot_index;
+	SCP_vector<uint> Slot_generation;
+	SCP_vector<uint> Free_slots;
+
+	const uint INVALID_INDEX = UINT_MAX;
+
+	uint allocate_slot(size_t index)
+	{
+		uint slot;
+
+		if (!Free_slots.empty())
+		{
+			slot = Free_slots.back();
+			Free_slots.pop_back();
+		}
+		else
+		{
+			slot = (uint) Slot_index.size();
+			Slot_index.push_back(INVALID_INDEX);
+			Slot_generation.push_back(0);
+		}
+
+		Slot_index[slot] = (uint) index;
+
+		return slot;
+	}
+
+	void remove_particle(size_t idx)
+	{
+		auto slot = Particles.slot[idx];
+
+		Slot_index[slot] = INVALID_INDEX;
+		++Slot_generation[slot];
+		Free_slots.push_back(slot);
+
+		Particles.swap_remove(idx);
+
+		if (idx < Particles.size())
+		{
+			Slot_index[Particles.slot[idx]] = (uint) idx;
+		}
+	}
+
+	void remove_all_particles()
+	{
+		// invalidate all handles to the current particles
+		for (auto slot : Particles.slot)
+		{
+			Slot_index[slot] = INVALID_INDEX;
+			++Slot_generation[slot];
+			Free_slots.push_back(slot);
+		}
+
+		Particles.clear();
+	}
 
 	int Anim_bitmap_id_fire = -1;
 	int Anim_num_frames_fire = -1;
@@ -86,6 +248,9 @@ namespace particle
 	// Reset everything between levels
 	void init()
 	{
+		// big explosions easily create a few thousand particles, avoid growing the arrays during the first ones
+		Particles.reserve(4096);
+
 		// FIRE!!!
 		if (Anim_bitmap_id_fire == -1)
 		{
@@ -108,7 +273,7 @@ namespace particle
 	// only call from game_shutdown()!!!
 	void close()
 	{
-		Particles.clear();
+		remove_all_particles();
 	}
 
 	void page_in()
@@ -125,29 +290,66 @@ namespace particle
 
 	int Num_particles_hwm = 0;
 
+	ParticleHandle::ParticleHandle(uint slot, uint generation) : m_slot(slot), m_generation(generation)
+	{
+	}
+
+	bool ParticleHandle::isValid() const
+	{
+		// removing a particle changes the generation of its slot so this also catches reused slots
+		return (m_slot < Slot_generation.size()) && (Slot_generation[m_slot] == m_generation);
+	}
+
+	size_t ParticleHandle::index() const
+	{
+		Assertion(isValid(), "Tried to access a particle through an invalid handle!");
+
+		return Slot_index[m_slot];
+	}
+
+	vec3d& ParticleHandle::pos() const
+	{
+		return Particles.pos[index()];
+	}
+
+	vec3d& ParticleHandle::velocity() const
+	{
+		return Particles.velocity[index()];
+	}
+
+	float& ParticleHandle::age() const
+	{
+		return Particles.age[index()];
+	}
+
+	float& ParticleHandle::max_life() const
+	{
+		return Particles.max_life[index()];
+	}
+
+	float& ParticleHandle::radius() const
+	{
+		return Particles.radius[index()];
+	}
+
+	int& ParticleHandle::attached_objnum() const
+	{
+		return Particles.attached_objnum[index()];
+	}
+
 	// Creates a single particle. See the PARTICLE_?? defines for types.
-	WeakParticlePtr create(particle_info* pinfo)
+	ParticleHandle create(particle_info* pinfo)
 	{
 		if (!Particles_enabled)
 		{
-			return WeakParticlePtr();
+			return ParticleHandle();
 		}
 
-		ParticlePtr new_particle(new particle());
+		float max_life = pinfo->lifetime;
+		int optional_data = pinfo->optional_data;
+		int nframes = 0;
 		int fps = 1;
 
-		new_particle->pos = pinfo->pos;
-		new_particle->velocity = pinfo->vel;
-		new_particle->age = 0.0f;
-		new_particle->max_life = pinfo->lifetime;
-		new_particle->radius = pinfo->rad;
-		new_particle->type = pinfo->type;
-		new_particle->optional_data = pinfo->optional_data;
-		new_particle->attached_objnum = pinfo->attached_objnum;
-		new_particle->attached_sig = pinfo->attached_sig;
-		new_particle->reverse = pinfo->reverse;
-		new_particle->particle_index = (int) Particles.size();
-
 		switch (pinfo->type)
 		{
 			case PARTICLE_BITMAP:
@@ -155,12 +357,12 @@ namespace particle
 			{
 				Assertion(bm_is_valid(pinfo->optional_data), "Invalid bitmap handle passed to particle create.");
 
-				bm_get_info(pinfo->optional_data, NULL, NULL, NULL, &new_particle->nframes, &fps);
+				bm_get_info(pinfo->optional_data, NULL, NULL, NULL, &nframes, &fps);
 
-				if (new_particle->nframes > 1)
+				if (nframes > 1)
 				{
 					// Recalculate max life for ani's
-					new_particle->max_life = i2fl(new_particle->nframes) / i2fl(fps);
+					max_life = i2fl(nframes) / i2fl(fps);
 				}
 
 				break;
@@ -170,11 +372,11 @@ namespace particle
 			{
 				if (Anim_bitmap_id_fire < 0)
 				{
-					return WeakParticlePtr();
+					return ParticleHandle();
 				}
 
-				new_particle->optional_data = Anim_bitmap_id_fire;
-				new_particle->nframes = Anim_num_frames_fire;
+				optional_data = Anim_bitmap_id_fire;
+				nframes = Anim_num_frames_fire;
 
 				break;
 			}
@@ -183,11 +385,11 @@ namespace particle
 			{
 				if (Anim_bitmap_id_smoke < 0)
 				{
-					return WeakParticlePtr();
+					return ParticleHandle();
 				}
 
-				new_particle->optional_data = Anim_bitmap_id_smoke;
-				new_particle->nframes = Anim_num_frames_smoke;
+				optional_data = Anim_bitmap_id_smoke;
+				nframes = Anim_num_frames_smoke;
 
 				break;
 			}
@@ -196,21 +398,36 @@ namespace particle
 			{
 				if (Anim_bitmap_id_smoke2 < 0)
 				{
-					return WeakParticlePtr();
+					return ParticleHandle();
 				}
 
-				new_particle->optional_data = Anim_bitmap_id_smoke2;
-				new_particle->nframes = Anim_num_frames_smoke2;
+				optional_data = Anim_bitmap_id_smoke2;
+				nframes = Anim_num_frames_smoke2;
 
 				break;
 			}
 
 			default:
-				new_particle->nframes = 1;
+				nframes = 1;
 				break;
 		}
 
-		Particles.push_back(new_particle);
+		auto idx = Particles.size();
+		auto slot = allocate_slot(idx);
+
+		Particles.pos.push_back(pinfo->pos);
+		Particles.velocity.push_back(pinfo->vel);
+		Particles.age.push_back(0.0f);
+		Particles.max_life.push_back(max_life);
+		Particles.radius.push_back(pinfo->rad);
+		Particles.type.push_back(pinfo->type);
+		Particles.optional_data.push_back(optional_data);
+		Particles.nframes.push_back(nframes);
+		Particles.attached_objnum.push_back(pinfo->attached_objnum);
+		Particles.attached_sig.push_back(pinfo->attached_sig);
+		Particles.reverse.push_back(pinfo->reverse ? 1 : 0);
+		Particles.particle_index.push_back((int) idx);
+		Particles.slot.push_back(slot);
 
 #ifndef NDEBUG
 		if (Particles.size() > static_cast<size_t>(Num_particles_hwm))
@@ -221,10 +438,10 @@ namespace particle
 		}
 #endif
 
-		return WeakParticlePtr(Particles.back());
+		return ParticleHandle(slot, Slot_generation[slot]);
 	}
 
-	WeakParticlePtr create(vec3d* pos, vec3d* vel, float lifetime, float rad, ParticleType type, int optional_data,
+	ParticleHandle create(vec3d* pos, vec3d* vel, float lifetime, float rad, ParticleType type, int optional_data,
 						   object* objp, bool reverse)
 	{
 		particle_info pinfo;
@@ -232,7 +449,7 @@ namespace particle
 		if ((type < 0) || (type >= NUM_PARTICLE_TYPES))
 		{
 			Int3();
-			return WeakParticlePtr();
+			return ParticleHandle();
 		}
 
 		// setup old data
@@ -271,63 +488,63 @@ namespace particle
 		if (!Particles_enabled)
 			return;
 
-		if (Particles.empty())
+		auto count = Particles.size();
+
+		if (count == 0)
 			return;
 
-		for (auto p = Particles.begin(); p != Particles.end();)
+		float* age = Particles.age.data();
+		const float* max_life = Particles.max_life.data();
+
+		// Age all particles. A new particle only gets a tiny age in its first frame so that it's rendered at least once.
+		for (size_t i = 0; i < count; ++i)
 		{
-			ParticlePtr part = *p;
-			if (part->age == 0.0f)
-			{
-				part->age = 0.00001f;
-			}
-			else
-			{
-				part->age += frametime;
-			}
+			age[i] = (age[i] == 0.0f) ? 0.00001f : (age[i] + frametime);
+		}
 
-			bool remove_particle = false;
+		// move as regular particles, the position arrays are treated as flat float arrays so this loop vectorizes
+		float* pos = &Particles.pos[0].xyz.x;
+		const float* vel = &Particles.velocity[0].xyz.x;
+
+		for (size_t i = 0; i < count * 3; ++i)
+		{
+			pos[i] += vel[i] * frametime;
+		}
+
+		// Remove dead particles. This goes backwards so that the particle which is moved into the place of a removed one
+		// has already been checked.
+		const int* attached_objnum = Particles.attached_objnum.data();
+		const int* attached_sig = Particles.attached_sig.data();
+
+		for (size_t i = count; i-- > 0;)
+		{
+			bool remove = false;
 
 			// if its time expired, remove it
-			if (part->age > part->max_life)
+			if (age[i] > max_life[i])
 			{
 				// special case, if max_life is 0 then we want it to render at least once
-				if ((part->age > frametime) || (part->max_life > 0.0f))
+				if ((age[i] > frametime) || (max_life[i] > 0.0f))
 				{
-					remove_particle = true;
+					remove = true;
 				}
 			}
 
 			// if the particle is attached to an object which has become invalid, kill it
-			if (part->attached_objnum >= 0)
+			if (attached_objnum[i] >= 0)
 			{
 				// if the signature has changed, or it's bogus, kill it
-				if ((part->attached_objnum >= MAX_OBJECTS) ||
-					(part->attached_sig != Objects[part->attached_objnum].signature))
+				if ((attached_objnum[i] >= MAX_OBJECTS) || (attached_sig[i] != Objects[attached_objnum[i]].signature))
 				{
-					remove_particle = true;
+					remove = true;
 				}
 			}
 
-			if (remove_particle)
+			if (remove)
 			{
-				// if we're sitting on the very last particle, popping-back will invalidate the iterator!
-				if (p + 1 == Particles.end())
-				{
-					Particles.pop_back();
-					break;
-				}
-
-				*p = Particles.back();
-				Particles.pop_back();
-				continue;
+				// only pops the arrays so the pointers above stay valid
+				remove_particle(i);
 			}
-
-			// move as a regular particle
-			vm_vec_scale_add2(&part->pos, &part->velocity, frametime);
-
-			// next particle
-			++p;
 		}
 	}
 
@@ -338,7 +555,7 @@ namespace particle
 		Num_particles = 0;
 		Num_particles_hwm = 0;
 
-		Particles.clear();
+		remove_all_particles();
 	}
 
 	MONITOR(NumParticlesRend)
@@ -359,23 +576,28 @@ namespace particle
 
 		MONITOR_INC(NumParticlesRend, Num_particles);
 
-		if (Particles.empty())
+		if (Particles.size() == 0)
 			return;
 
-		for (SCP_vector<ParticlePtr>::iterator p = Particles.begin(); p != Particles.end(); ++p)
+		for (size_t i = 0; i < Particles.size(); ++i)
 		{
-			ParticlePtr part = *p;
+			auto attached_objnum = Particles.attached_objnum[i];
+			auto& part_pos = Particles.pos[i];
+			auto nframes = Particles.nframes[i];
+			auto optional_data = Particles.optional_data[i];
+			auto radius = Particles.radius[i];
+
 			// skip back-facing particles (ripped from fullneb code)
 			// Wanderer - add support for attached particles
 			vec3d p_pos;
-			if (part->attached_objnum >= 0)
+			if (attached_objnum >= 0)
 			{
-				vm_vec_unrotate(&p_pos, &part->pos, &Objects[part->attached_objnum].orient);
-				vm_vec_add2(&p_pos, &Objects[part->attached_objnum].pos);
+				vm_vec_unrotate(&p_pos, &part_pos, &Objects[attached_objnum].orient);
+				vm_vec_add2(&p_pos, &Objects[attached_objnum].pos);
 			}
 			else
 			{
-				p_pos = part->pos;
+				p_pos = part_pos;
 			}
 
 			if (vm_vec_dot_to_point(&Eye_matrix.vec.fvec, &Eye_position, &p_pos) <= 0.0f)
@@ -402,27 +624,27 @@ namespace particle
 			g3_transfer_vertex(&pos, &p_pos);
 
 			// figure out which frame we should be using
-			if (part->nframes > 1) {
-				framenum = bm_get_anim_frame(part->optional_data, part->age, part->max_life);
-				cur_frame = part->reverse ? (part->nframes - framenum - 1) : framenum;
+			if (nframes > 1) {
+				framenum = bm_get_anim_frame(optional_data, Particles.age[i], Particles.max_life[i]);
+				cur_frame = Particles.reverse[i] ? (nframes - framenum - 1) : framenum;
 			}
 			else
 			{
 				cur_frame = 0;
 			}
 
-			if (part->type == PARTICLE_DEBUG)
+			if (Particles.type[i] == PARTICLE_DEBUG)
 			{
 				gr_set_color(255, 0, 0);
-				g3_draw_sphere_ez(&p_pos, part->radius);
+				g3_draw_sphere_ez(&p_pos, radius);
 			}
 			else
 			{
-				framenum = part->optional_data;
+				framenum = optional_data;
 
-				Assert( cur_frame < part->nframes );
+				Assert( cur_frame < nframes );
 
-				batching_add_volume_bitmap(framenum + cur_frame, &pos, part->particle_index % 8, part->radius, alpha);
+				batching_add_volume_bitmap(framenum + cur_frame, &pos, Particles.particle_index[i] % 8, radius, alpha);
 
 				render_batch = true;
 			}
@@ -15,7 +15,7 @@
 #include "globalincs/pstypes.h"
 #include "object/object.h"
 
-#include <memory>
+#include <climits>
 
 namespace particle
 {
@@ -74,30 +74,43 @@ namespace particle
 		bool	reverse;						// play any animations in reverse
 	} particle_info;
 
-	typedef struct particle {
-		// old style data
-		vec3d	pos;				// position
-		vec3d	velocity;			// velocity
-		float	age;				// How long it's been alive
-		float	max_life;			// How much life we had
-		float	radius;				// radius
-		int		type;				// type										// -1 = None
-		int		optional_data;		// depends on type
-		int		nframes;			// If an ani, how many frames?	
-
-		// new style data
-		int		attached_objnum;	// if this is set, pos is relative to the attached object. velocity is ignored
-		int		attached_sig;		// to check for dead/nonexistent objects
-		bool	reverse;			// play any animations in reverse
-		int		particle_index;		// used to keep particle offset in dynamic array for orient usage
-	} particle;
-
-	typedef std::weak_ptr<particle> WeakParticlePtr;
-	typedef std::shared_ptr<particle> ParticlePtr;
+	/**
+	 * @brief A handle to a particle which can safely be kept after the particle has died
+	 *
+	 * Particles live in a pooled structure of arrays which is compacted when particles die so they can't be referenced
+	 * by pointer. A handle refers to a slot of the pool together with the generation the slot had when the particle was
+	 * created. Removing the particle bumps the generation of the slot which invalidates all handles to it, even if the
+	 * slot is reused by a new particle.
+	 *
+	 * The references returned by the accessors are only valid until the next particle is created or removed.
+	 */
+	class ParticleHandle
+	{
+		uint m_slot = UINT_MAX;
+		uint m_generation = 0;
+
+		size_t index() const;
+
+	public:
+		ParticleHandle() = default;
+		ParticleHandle(uint slot, uint generation);
+
+		/**
+		 * @brief Checks if the particle this handle refers to is still alive
+		 */
+		bool isValid() const;
+
+		vec3d& pos() const;
+		vec3d& velocity() const;
+		float& age() const;
+		float& max_life() const;
+		float& radius() const;
+		int& attached_objnum() const;
+	};
 
 	// Creates a single particle. See the PARTICLE_?? defines for types.
-    WeakParticlePtr create(particle_info *pinfo);
-    WeakParticlePtr create(vec3d *pos, vec3d *vel, float lifetime, float rad, ParticleType type, int optional_data = -1, object *objp = NULL, bool reverse = false);
+    ParticleHandle create(particle_info *pinfo);
+    ParticleHandle create(vec3d *pos, vec3d *vel, float lifetime, float rad, ParticleType type, int optional_data = -1, object *objp = NULL, bool reverse = false);
 
 	//============================================================================
 	//============== HIGH-LEVEL PARTICLE SYSTEM CREATION CODE ====================
@@ -30,15 +30,15 @@ void ParticleProperties::parse(bool nocreate) {
 	}
 }
 
-WeakParticlePtr ParticleProperties::createParticle(particle_info& info) {
+ParticleHandle ParticleProperties::createParticle(particle_info& info) {
 	info.optional_data = m_bitmap;
 	info.type = PARTICLE_BITMAP;
 	info.rad = m_radius.next();
 
 	auto p = create(&info);
 
-	if (m_hasLifetime && !p.expired()) {
-		p.lock()->max_life = m_lifetime.next();
+	if (m_hasLifetime && p.isValid()) {
+		p.max_life() = m_lifetime.next();
 	}
 
 	return p;
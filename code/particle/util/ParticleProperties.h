@@ -33,7 +33,7 @@ class ParticleProperties {
 	 * @param info The base values of the particle. Some values will be overwritten by this function
 	 * @return The created particle
 	 */
-	WeakParticlePtr createParticle(particle_info& info);
+	ParticleHandle createParticle(particle_info& info);
 
 	void pageIn();
 };
@@ -10,14 +10,14 @@ namespace api {
 
 particle_h::particle_h() {
 }
-particle_h::particle_h(const particle::WeakParticlePtr& part_p) {
+particle_h::particle_h(const particle::ParticleHandle& part_p) {
 	this->part = part_p;
 }
-particle::WeakParticlePtr particle_h::Get() {
+particle::ParticleHandle particle_h::Get() {
 	return this->part;
 }
 bool particle_h::isValid() {
-	return !part.expired();
+	return part.isValid();
 }
 
 
@@ -58,10 +58,10 @@ ADE_VIRTVAR(Position, l_Particle, "vector", "The current position of the particl
 
 	if (ADE_SETTING_VAR)
 	{
-		ph->Get().lock()->pos = newVec;
+		ph->Get().pos() = newVec;
 	}
 
-	return ade_set_args(L, "o", l_Vector.Set(ph->Get().lock()->pos));
+	return ade_set_args(L, "o", l_Vector.Set(ph->Get().pos()));
 }
 
 ADE_VIRTVAR(Velocity, l_Particle, "vector", "The current velocity of the particle (world vector)", "vector", "The current velocity")
@@ -79,10 +79,10 @@ ADE_VIRTVAR(Velocity, l_Particle, "vector", "The current velocity of the particl
 
 	if (ADE_SETTING_VAR)
 	{
-		ph->Get().lock()->velocity = newVec;
+		ph->Get().velocity() = newVec;
 	}
 
-	return ade_set_args(L, "o", l_Vector.Set(ph->Get().lock()->velocity));
+	return ade_set_args(L, "o", l_Vector.Set(ph->Get().velocity()));
 }
 
 ADE_VIRTVAR(Age, l_Particle, "number", "The time this particle already lives", "number", "The current age or -1 on error")
@@ -101,10 +101,10 @@ ADE_VIRTVAR(Age, l_Particle, "number", "The time this particle already lives", "
 	if (ADE_SETTING_VAR)
 	{
 		if (newAge >= 0)
-			ph->Get().lock()->age = newAge;
+			ph->Get().age() = newAge;
 	}
 
-	return ade_set_args(L, "f", ph->Get().lock()->age);
+	return ade_set_args(L, "f", ph->Get().age());
 }
 
 ADE_VIRTVAR(MaximumLife, l_Particle, "number", "The time this particle can live", "number", "The maximal life or -1 on error")
@@ -123,10 +123,10 @@ ADE_VIRTVAR(MaximumLife, l_Particle, "number", "The time this particle can live"
 	if (ADE_SETTING_VAR)
 	{
 		if (newLife >= 0)
-			ph->Get().lock()->max_life = newLife;
+			ph->Get().max_life() = newLife;
 	}
 
-	return ade_set_args(L, "f", ph->Get().lock()->max_life);
+	return ade_set_args(L, "f", ph->Get().max_life());
 }
 
 ADE_VIRTVAR(Radius, l_Particle, "number", "The radius of the particle", "number", "The radius or -1 on error")
@@ -145,10 +145,10 @@ ADE_VIRTVAR(Radius, l_Particle, "number", "The radius of the particle", "number"
 	if (ADE_SETTING_VAR)
 	{
 		if (newRadius >= 0)
-			ph->Get().lock()->radius = newRadius;
+			ph->Get().radius() = newRadius;
 	}
 
-	return ade_set_args(L, "f", ph->Get().lock()->radius);
+	return ade_set_args(L, "f", ph->Get().radius());
 }
 
 ADE_VIRTVAR(TracerLength, l_Particle, "number", "The tracer legth of the particle", "number", "The radius or -1 on error")
@@ -184,10 +184,10 @@ ADE_VIRTVAR(AttachedObject, l_Particle, "object", "The object this particle is a
 	if (ADE_SETTING_VAR)
 	{
 		if (newObj->IsValid())
-			ph->Get().lock()->attached_objnum = newObj->objp->signature;
+			ph->Get().attached_objnum() = newObj->objp->signature;
 	}
 
-	return ade_set_args(L, "o", l_Object.Set(object_h(&Objects[ph->Get().lock()->attached_objnum])));
+	return ade_set_args(L, "o", l_Object.Set(object_h(&Objects[ph->Get().attached_objnum()])));
 }
 
 ADE_FUNC(isValid, l_Particle, NULL, "Detects whether this handle is valid", "boolean", "true if valid false if not")
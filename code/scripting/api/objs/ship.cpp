@@ -244,7 +244,7 @@ ADE_VIRTVAR(Name, l_Ship, "string", "Ship name", "string", "Ship name, or empty
 	ship *shipp = &Ships[objh->objp->instance];
 
 	if(ADE_SETTING_VAR && s != NULL) {
-		strncpy(shipp->ship_name, s, sizeof(shipp->ship_name)-1);
+		ship_rename(objh->objp->instance, s);
 	}
 
 	return ade_set_args(L, "s", shipp->ship_name);
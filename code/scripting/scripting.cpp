@@ -234,6 +234,69 @@ bool ConditionedHook::AddAction(script_action *sa)
 	return true;
 }
 
+bool ConditionedHook::HasAction(int action) const
+{
+	for (auto& sa : Actions)
+	{
+		if (sa.action_type == action)
+			return true;
+	}
+
+	return false;
+}
+
+// Looks up the table entries the conditions refer to so ConditionsValid() can compare indices instead of names
+void ConditionedHook::ResolveConditions()
+{
+	for (int i = 0; i < MAX_HOOK_CONDITIONS; i++)
+	{
+		script_condition *scp = &Conditions[i];
+		int idx = -1;
+
+		scp->resolved_class = -1;
+
+		switch (scp->condition_type)
+		{
+			case CHC_STATE:
+				idx = gameseq_get_state_idx(scp->data.name);
+				break;
+			case CHC_SHIPTYPE:
+				idx = ship_type_name_lookup(scp->data.name);
+				// FALLTHROUGH
+			case CHC_SHIPCLASS:
+				{
+					// ship_info_lookup() also tries a few variations of the name, the condition has to match exactly
+					int class_idx = ship_info_lookup(scp->data.name);
+					if (class_idx >= 0 && stricmp(Ship_info[class_idx].name, scp->data.name))
+						class_idx = -1;
+
+					if (scp->condition_type == CHC_SHIPTYPE)
+						scp->resolved_class = class_idx;
+					else
+						idx = class_idx;
+					break;
+				}
+			case CHC_WEAPONCLASS:
+				idx = weapon_info_lookup(scp->data.name);
+				break;
+			case CHC_OBJECTTYPE:
+				for (int j = 0; j < MAX_OBJECT_TYPES; j++)
+				{
+					if (Object_type_names[j] != NULL && !stricmp(Object_type_names[j], scp->data.name))
+					{
+						idx = j;
+						break;
+					}
+				}
+				break;
+			default:
+				break;
+		}
+
+		scp->resolved_index = idx;
+	}
+}
+
 bool ConditionedHook::ConditionsValid(int action, object *objp, int more_data)
 {
 	uint i;
@@ -249,7 +312,7 @@ bool ConditionedHook::ConditionsValid(int action, object *objp, int more_data)
 			case CHC_STATE:
 				if(gameseq_get_depth() < 0)
 					return false;
-				if(stricmp(GS_state_text[gameseq_get_state(0)], scp->data.name))
+				if(scp->resolved_index < 0 || gameseq_get_state(0) != scp->resolved_index)
 					return false;
 				break;
 			case CHC_SHIPTYPE:
@@ -258,12 +321,16 @@ bool ConditionedHook::ConditionsValid(int action, object *objp, int more_data)
 				sip = &Ship_info[Ships[objp->instance].ship_info_index];
 				if(sip->class_type < 0)
 					return false;
-				if(stricmp(Ship_types[sip->class_type].name, scp->data.name))
+				if(scp->resolved_index < 0 || sip->class_type != scp->resolved_index)
+					return false;
+				// the ship class has to have the same name, this has always fallen through
+				if(scp->resolved_class < 0 || Ships[objp->instance].ship_info_index != scp->resolved_class)
 					return false;
+				break;
 			case CHC_SHIPCLASS:
 				if(objp == NULL || objp->type != OBJ_SHIP)
 					return false;
-				if(stricmp(Ship_info[Ships[objp->instance].ship_info_index].name, scp->data.name))
+				if(scp->resolved_index < 0 || Ships[objp->instance].ship_info_index != scp->resolved_index)
 					return false;
 				break;
 			case CHC_SHIP:
@@ -299,15 +366,19 @@ bool ConditionedHook::ConditionsValid(int action, object *objp, int more_data)
 				}
 			case CHC_WEAPONCLASS:
 				{
+					// no weapon has that name, so nothing can match
+					if (scp->resolved_index < 0)
+						return false;
+
 					if (action == CHA_COLLIDEWEAPON) {
-						if (stricmp(Weapon_info[more_data].name, scp->data.name) != 0)
+						if (more_data != scp->resolved_index)
 							return false;
 					} else if (!(action == CHA_ONWPSELECTED || action == CHA_ONWPDESELECTED || action == CHA_ONWPEQUIPPED || action == CHA_ONWPFIRED || action == CHA_ONTURRETFIRED )) {
 						if(objp == NULL || (objp->type != OBJ_WEAPON && objp->type != OBJ_BEAM))
 							return false;
-						else if (( objp->type == OBJ_WEAPON) && (stricmp(Weapon_info[Weapons[objp->instance].weapon_info_index].name, scp->data.name) != 0 ))
+						else if (( objp->type == OBJ_WEAPON) && (Weapons[objp->instance].weapon_info_index != scp->resolved_index ))
 							return false;
-						else if (( objp->type == OBJ_BEAM) && (stricmp(Weapon_info[Beams[objp->instance].weapon_info_index].name, scp->data.name) != 0 ))
+						else if (( objp->type == OBJ_BEAM) && (Beams[objp->instance].weapon_info_index != scp->resolved_index ))
 							return false;
 					} else if(objp == NULL || objp->type != OBJ_SHIP) {
 						return false;
@@ -318,8 +389,8 @@ bool ConditionedHook::ConditionsValid(int action, object *objp, int more_data)
 						bool primary = false, secondary = false, prev_primary = false, prev_secondary = false;
 						switch (action) {
 							case CHA_ONWPSELECTED:
-								primary = stricmp(Weapon_info[shipp->weapons.primary_bank_weapons[shipp->weapons.current_primary_bank]].name, scp->data.name) == 0;
-								secondary = stricmp(Weapon_info[shipp->weapons.secondary_bank_weapons[shipp->weapons.current_secondary_bank]].name, scp->data.name) == 0;
+								primary = shipp->weapons.primary_bank_weapons[shipp->weapons.current_primary_bank] == scp->resolved_index;
+								secondary = shipp->weapons.secondary_bank_weapons[shipp->weapons.current_secondary_bank] == scp->resolved_index;
 								
 								if (!(primary || secondary))
 									return false;
@@ -329,10 +400,10 @@ bool ConditionedHook::ConditionsValid(int action, object *objp, int more_data)
 								
 								break;
 							case CHA_ONWPDESELECTED:
-								primary = stricmp(Weapon_info[shipp->weapons.primary_bank_weapons[shipp->weapons.current_primary_bank]].name, scp->data.name) == 0;
-								prev_primary = stricmp(Weapon_info[shipp->weapons.primary_bank_weapons[shipp->weapons.previous_primary_bank]].name, scp->data.name) == 0;
-								secondary = stricmp(Weapon_info[shipp->weapons.secondary_bank_weapons[shipp->weapons.current_secondary_bank]].name, scp->data.name) == 0;
-								prev_secondary = stricmp(Weapon_info[shipp->weapons.secondary_bank_weapons[shipp->weapons.previous_secondary_bank]].name, scp->data.name) == 0;
+								primary = shipp->weapons.primary_bank_weapons[shipp->weapons.current_primary_bank] == scp->resolved_index;
+								prev_primary = shipp->weapons.primary_bank_weapons[shipp->weapons.previous_primary_bank] == scp->resolved_index;
+								secondary = shipp->weapons.secondary_bank_weapons[shipp->weapons.current_secondary_bank] == scp->resolved_index;
+								prev_secondary = shipp->weapons.secondary_bank_weapons[shipp->weapons.previous_secondary_bank] == scp->resolved_index;
 
 								if ((shipp->flags[Ship::Ship_Flags::Primary_linked]) && prev_primary && (Weapon_info[shipp->weapons.primary_bank_weapons[shipp->weapons.previous_primary_bank]].wi_flags[Weapon::Info_Flags::Nolink]))
 									return true;
@@ -357,7 +428,7 @@ bool ConditionedHook::ConditionsValid(int action, object *objp, int more_data)
 								bool equipped = false;
 								for(int j = 0; j < MAX_SHIP_PRIMARY_BANKS; j++) {
 									if (!equipped && (shipp->weapons.primary_bank_weapons[j] >= 0) && (shipp->weapons.primary_bank_weapons[j] < MAX_WEAPON_TYPES) ) {
-										if ( !stricmp(Weapon_info[shipp->weapons.primary_bank_weapons[j]].name, scp->data.name) ) {
+										if ( shipp->weapons.primary_bank_weapons[j] == scp->resolved_index ) {
 											equipped = true;
 											break;
 										}
@@ -367,7 +438,7 @@ bool ConditionedHook::ConditionsValid(int action, object *objp, int more_data)
 								if (!equipped) {
 									for(int j = 0; j < MAX_SHIP_SECONDARY_BANKS; j++) {
 										if (!equipped && (shipp->weapons.secondary_bank_weapons[j] >= 0) && (shipp->weapons.secondary_bank_weapons[j] < MAX_WEAPON_TYPES) ) {
-											if ( !stricmp(Weapon_info[shipp->weapons.secondary_bank_weapons[j]].name, scp->data.name) ) {
+											if ( shipp->weapons.secondary_bank_weapons[j] == scp->resolved_index ) {
 												equipped = true;
 												break;
 											}
@@ -382,11 +453,11 @@ bool ConditionedHook::ConditionsValid(int action, object *objp, int more_data)
 							}
 							case CHA_ONWPFIRED: {
 								if (more_data == 1) {
-									primary = stricmp(Weapon_info[shipp->weapons.primary_bank_weapons[shipp->weapons.current_primary_bank]].name, scp->data.name) == 0;
+									primary = shipp->weapons.primary_bank_weapons[shipp->weapons.current_primary_bank] == scp->resolved_index;
 									secondary = false;
 								} else {
 									primary = false;
-									secondary = stricmp(Weapon_info[shipp->weapons.secondary_bank_weapons[shipp->weapons.current_secondary_bank]].name, scp->data.name) == 0;
+									secondary = shipp->weapons.secondary_bank_weapons[shipp->weapons.current_secondary_bank] == scp->resolved_index;
 								}
 
 								if ((shipp->flags[Ship::Ship_Flags::Primary_linked]) && primary && (Weapon_info[shipp->weapons.primary_bank_weapons[shipp->weapons.current_primary_bank]].wi_flags[Weapon::Info_Flags::Nolink]))
@@ -397,22 +468,22 @@ bool ConditionedHook::ConditionsValid(int action, object *objp, int more_data)
 								break;
 							}
 							case CHA_ONTURRETFIRED: {
-								if (! (stricmp(Weapon_info[shipp->last_fired_turret->last_fired_weapon_info_index].name, scp->data.name) == 0))
+								if (shipp->last_fired_turret->last_fired_weapon_info_index != scp->resolved_index)
 									return false;
 								break;
 							}
 							case CHA_PRIMARYFIRE: {
-								if (stricmp(Weapon_info[shipp->weapons.primary_bank_weapons[shipp->weapons.current_primary_bank]].name, scp->data.name))
+								if (shipp->weapons.primary_bank_weapons[shipp->weapons.current_primary_bank] != scp->resolved_index)
 									return false;
 								break;
 							}
 							case CHA_SECONDARYFIRE: {
-								if (stricmp(Weapon_info[shipp->weapons.secondary_bank_weapons[shipp->weapons.current_secondary_bank]].name, scp->data.name))
+								if (shipp->weapons.secondary_bank_weapons[shipp->weapons.current_secondary_bank] != scp->resolved_index)
 									return false;
 								break;
 							}
 							case CHA_BEAMFIRE: {
-								if (!(stricmp(Weapon_info[more_data].name, scp->data.name) == 0))
+								if (more_data != scp->resolved_index)
 									return false;
 								break;
 							}
@@ -424,7 +495,7 @@ bool ConditionedHook::ConditionsValid(int action, object *objp, int more_data)
 			case CHC_OBJECTTYPE:
 				if(objp == NULL)
 					return false;
-				if(stricmp(Object_type_names[objp->type], scp->data.name))
+				if(scp->resolved_index < 0 || objp->type != scp->resolved_index)
 					return false;
 				break;
 			case CHC_KEYPRESS:
@@ -873,11 +944,51 @@ int script_state::RunBytecode(script_hook &hd, char format, void *data)
 	return 1;
 }
 
+void script_state::AddConditionalHook(const ConditionedHook& hook)
+{
+	int idx = (int)ConditionalHooks.size();
+
+	ConditionalHooks.push_back(hook);
+
+	for (int action = 0; action <= CHA_LAST; action++)
+	{
+		if (hook.HasAction(action))
+			HooksByAction[action].push_back(idx);
+	}
+
+	ConditionsResolved = false;
+}
+
+// The conditions refer to ship and weapon classes which are parsed after the scripting tables, so they are resolved
+// on first use and again whenever any of those tables changed
+void script_state::MaybeResolveConditions()
+{
+	if (ConditionsResolved && ResolvedShipClasses == Ship_info.size() && ResolvedShipTypes == Ship_types.size() && ResolvedWeaponClasses == Num_weapon_types)
+		return;
+
+	for (auto& hook : ConditionalHooks)
+		hook.ResolveConditions();
+
+	ConditionsResolved = true;
+	ResolvedShipClasses = Ship_info.size();
+	ResolvedShipTypes = Ship_types.size();
+	ResolvedWeaponClasses = Num_weapon_types;
+}
+
 int script_state::RunCondition(int action, char format, void *data, object *objp, int more_data)
 {
 	int num = 0;
-	for(SCP_vector<ConditionedHook>::iterator chp = ConditionalHooks.begin(); chp != ConditionalHooks.end(); ++chp) 
+
+	if (action < 0 || action > CHA_LAST)
+		return 0;
+
+	MaybeResolveConditions();
+
+	// Only the hooks with this action
+	const SCP_vector<int>& hooks = HooksByAction[action];
+	for (size_t i = 0; i < hooks.size(); i++)
 	{
+		ConditionedHook *chp = &ConditionalHooks[hooks[i]];
 		if(chp->ConditionsValid(action, objp, more_data))
 		{
 			chp->Run(this, action, format, data);
@@ -889,9 +1000,15 @@ int script_state::RunCondition(int action, char format, void *data, object *objp
 
 bool script_state::IsConditionOverride(int action, object *objp)
 {
-	//bool b = false;
-	for(SCP_vector<ConditionedHook>::iterator chp = ConditionalHooks.begin(); chp != ConditionalHooks.end(); ++chp)
+	if (action < 0 || action > CHA_LAST)
+		return false;
+
+	MaybeResolveConditions();
+
+	const SCP_vector<int>& hooks = HooksByAction[action];
+	for (size_t i = 0; i < hooks.size(); i++)
 	{
+		ConditionedHook *chp = &ConditionalHooks[hooks[i]];
 		if(chp->ConditionsValid(action, objp))
 		{
 			if(chp->IsOverride(this, action))
@@ -910,6 +1027,9 @@ void script_state::Clear()
 {
 	// Free all lua value references
 	ConditionalHooks.clear();
+	for (auto& hooks : HooksByAction)
+		hooks.clear();
+	ConditionsResolved = false;
 
 	if(LuaState != NULL) {
 		lua_close(LuaState);
@@ -929,6 +1049,11 @@ script_state::script_state(const char *name)
 
 	Langs = 0;
 
+	ConditionsResolved = false;
+	ResolvedShipClasses = 0;
+	ResolvedShipTypes = 0;
+	ResolvedWeaponClasses = 0;
+
 	LuaState = NULL;
 	LuaLibs = NULL;
 }
@@ -1220,11 +1345,12 @@ void script_state::ParseGlobalChunk(int hookType, const char* debug_str) {
 	//Add the action
 	hook.AddAction(&sat);
 
-	ConditionalHooks.push_back(hook);
+	AddConditionalHook(hook);
 }
 bool script_state::ParseCondition(const char *filename)
 {
-	ConditionedHook *chp = NULL;
+	ConditionedHook hook;
+	bool conditions_added = false;
 	int condition;
 
 	for(condition = script_parse_condition(); condition != CHC_NONE; condition = script_parse_condition())
@@ -1249,19 +1375,15 @@ bool script_state::ParseCondition(const char *filename)
 				break;
 		}
 
-		if(chp == NULL)
-		{
-			ConditionalHooks.push_back(ConditionedHook());
-			chp = &ConditionalHooks[ConditionalHooks.size()-1];
-		}
+		conditions_added = true;
 
-		if(!chp->AddCondition(&sct))
+		if(!hook.AddCondition(&sct))
 		{
 			Warning(LOCATION, "Could not add condition to conditional hook in file '%s'; you may have more than %d", filename, MAX_HOOK_CONDITIONS);
 		}
 	}
 
-	if(chp == NULL)
+	if(!conditions_added)
 	{
 		return false;
 	}
@@ -1283,17 +1405,18 @@ bool script_state::ParseCondition(const char *filename)
 		vm_free(buf);
 
 		//Add the action
-		if(chp->AddAction(&sat))
+		if(hook.AddAction(&sat))
 			actions_added = true;
 	}
 
 	if(!actions_added)
 	{
 		Warning(LOCATION, "No actions specified for conditional hook in file '%s'", filename);
-		ConditionalHooks.pop_back();
 		return false;
 	}
 
+	AddConditionalHook(hook);
+
 	return true;
 }
 
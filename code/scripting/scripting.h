@@ -98,6 +98,8 @@ extern bool script_hook_valid(script_hook *hook);
 #define CHA_BEAMFIRE        38
 #define CHA_SIMULATION      39
 
+#define CHA_LAST			CHA_SIMULATION
+
 // management stuff
 void scripting_state_init();
 void scripting_state_close();
@@ -112,8 +114,13 @@ public:
 		char name[CONDITION_LENGTH];
 	} data;
 
+	// The table entry data.name refers to, set by ConditionedHook::ResolveConditions(). -1 if there is none.
+	int resolved_index;
+	// CHC_SHIPTYPE also checks the ship class name, this is the ship class with the same name
+	int resolved_class;
+
 	script_condition()
-		: condition_type(CHC_NONE)
+		: condition_type(CHC_NONE), resolved_index(-1), resolved_class(-1)
 	{
 		memset(data.name, 0, sizeof(data.name));
 	}
@@ -139,7 +146,9 @@ private:
 public:
 	bool AddCondition(script_condition *sc);
 	bool AddAction(script_action *sa);
+	bool HasAction(int action) const;
 
+	void ResolveConditions();
 	bool ConditionsValid(int action, class object *objp=NULL, int more_data = 0);
 	bool IsOverride(class script_state *sys, int action);
 	bool Run(class script_state *sys, int action, char format='\0', void *data=NULL);
@@ -159,8 +168,20 @@ private:
 	SCP_vector<image_desc> ScriptImages;
 	SCP_vector<ConditionedHook> ConditionalHooks;
 
+	// The indices into ConditionalHooks of the hooks with an action of each type, in the order they were parsed
+	SCP_vector<int> HooksByAction[CHA_LAST + 1];
+
+	// The table sizes the conditions were last resolved with, they have to be resolved again if any changed
+	bool ConditionsResolved;
+	size_t ResolvedShipClasses;
+	size_t ResolvedShipTypes;
+	int ResolvedWeaponClasses;
+
 private:
 
+	void AddConditionalHook(const ConditionedHook& hook);
+	void MaybeResolveConditions();
+
 	void ParseChunkSub(script_function& out_func, const char* debug_str=NULL);
 	int RunBytecodeSub(script_function& func, char format='\0', void *data=NULL);
 
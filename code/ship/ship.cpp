@@ -61,6 +61,7 @@
 #include "object/objectdock.h"
 #include "object/objectshield.h"
 #include "object/objectsnd.h"
+#include "object/objectspatial.h"
 #include "object/waypoint.h"
 #include "parse/parselo.h"
 #include "scripting/scripting.h"
@@ -86,6 +87,7 @@
 #include "weapon/weapon.h"
 #include "tracing/Monitor.h"
 #include "tracing/tracing.h"
+#include "utils/name_registry.h"
 
 using namespace Ship;
 
@@ -171,6 +173,14 @@ SCP_vector<ship_info>	Ship_templates;
 
 SCP_vector<ship_type_info> Ship_types;
 
+// Name indices for the lookup functions. Ship_names is kept up to date by ship_create(), ship_delete() and
+// ship_rename(), the others are table data which find_in_table() keeps up to date by itself. Fred renames ships and
+// wings directly so it still uses linear scans.
+static name_registry Ship_names;
+static name_registry Wing_names;
+static name_registry Ship_info_names;
+static name_registry Ship_type_names;
+
 SCP_vector<ArmorType> Armor_types;
 SCP_vector<DamageTypeStruct>	Damage_types;
 
@@ -601,6 +611,8 @@ int ship_obj_list_add(int objnum)
 	list_append(&Ship_obj_list, &Ship_objs[i]);
 	Ship_objs[i].flags |= SHIP_OBJ_USED;
 
+	obj_spatial_add_ship(objnum);
+
 	return i;
 }
 
@@ -5383,8 +5395,10 @@ void ship_level_init()
 		Ships[i].ship_name[0] = '\0';
 		Ships[i].objnum = -1;
 	}
+	Ship_names.clear();
 
 	Num_wings = 0;
+	Wing_names.clear();
 	for (i = 0; i < MAX_WINGS; i++ )
 	{
 		Wings[i].num_waves = -1;
@@ -5911,6 +5925,10 @@ void ship::clear()
 		np_updates[i].subsys_update_stamp = -1;
 		np_updates[i].pos_chksum = 0;
 		np_updates[i].orient_chksum = 0;
+		np_updates[i].status_chksum = 0;
+		np_updates[i].subsys_chksum = 0;
+		np_updates[i].status_refresh_stamp = -1;
+		np_updates[i].subsys_refresh_stamp = -1;
 	}
 
 	lightning_stamp = timestamp(-1);
@@ -7201,6 +7219,7 @@ void ship_delete( object * obj )
 	// on ship back to the free list for other ships to use.
 	ship_subsystems_delete(&Ships[num]);
 	shipp->objnum = -1;
+	Ship_names.remove(shipp->ship_name, num);
 
 	if (shipp->shield_integrity != NULL) {
 		vm_free(shipp->shield_integrity);
@@ -9412,6 +9431,8 @@ int ship_create(matrix *orient, vec3d *pos, int ship_type, char *ship_name)
 	} else {
 		strcpy_s(shipp->ship_name, ship_name);
 	}
+	if (!Fred_running)
+		Ship_names.add(shipp->ship_name, n);
 
 	ship_set_default_weapons(shipp, sip);	//	Moved up here because ship_set requires that weapon info be valid.  MK, 4/28/98
 	ship_set(n, objnum, ship_type);
@@ -12528,18 +12549,17 @@ int wing_name_lookup(const char *name, int ignore_count)
 	else
 		wing_limit = Num_wings;
 
-	if (Fred_running || ignore_count ) {  // current_count not used for Fred..
+	if ( Fred_running ) {  // current_count not used for Fred..
 		for (i=0; i<wing_limit; i++)
 			if (Wings[i].wave_count && !stricmp(Wings[i].name, name))
 				return i;
 
-	} else {
-		for (i=0; i<wing_limit; i++)
-			if (Wings[i].current_count && !stricmp(Wings[i].name, name))
-				return i;
+		return -1;
 	}
 
-	return -1;
+	return Wing_names.find_in_table(name, wing_limit, [](int idx) { return Wings[idx].name; }, [ignore_count](int idx) {
+		return (ignore_count ? Wings[idx].wave_count : Wings[idx].current_count) != 0;
+	});
 }
 
 /**
@@ -12549,11 +12569,16 @@ int wing_name_lookup(const char *name, int ignore_count)
 int wing_lookup(const char *name)
 {
    int idx;
-	for(idx=0;idx<Num_wings;idx++)
-		if(stricmp(Wings[idx].name,name)==0)
-		   return idx;
 
-	return -1;
+	if (Fred_running) {
+		for(idx=0;idx<Num_wings;idx++)
+			if(stricmp(Wings[idx].name,name)==0)
+			   return idx;
+
+		return -1;
+	}
+
+	return Wing_names.find_in_table(name, Num_wings, [](int i) { return Wings[i].name; });
 }
 
 /**
@@ -12561,11 +12586,7 @@ int wing_lookup(const char *name)
  */
 int ship_info_lookup_sub(const char *token)
 {
-	for (auto it = Ship_info.cbegin(); it != Ship_info.cend(); ++it)
-		if (!stricmp(token, it->name))
-			return (int)std::distance(Ship_info.cbegin(), it);
-
-	return -1;
+	return Ship_info_names.find_in_table(token, (int)Ship_info.size(), [](int i) { return Ship_info[i].name; });
 }
 
 /**
@@ -12719,18 +12740,47 @@ int ship_name_lookup(const char *name, int inc_players)
 		return -1;
 	}
 
-	for (i=0; i<MAX_SHIPS; i++){
-		if (Ships[i].objnum >= 0){
-			if (Objects[Ships[i].objnum].type == OBJ_SHIP || (Objects[Ships[i].objnum].type == OBJ_START && inc_players)){
-				if (!stricmp(name, Ships[i].ship_name)){
-					return i;
+	auto matches = [name, inc_players](int idx) {
+		if (Ships[idx].objnum >= 0){
+			if (Objects[Ships[idx].objnum].type == OBJ_SHIP || (Objects[Ships[idx].objnum].type == OBJ_START && inc_players)){
+				if (!stricmp(name, Ships[idx].ship_name)){
+					return true;
 				}
 			}
 		}
+		return false;
+	};
+
+	if (Fred_running) {
+		for (i=0; i<MAX_SHIPS; i++){
+			if (matches(i)){
+				return i;
+			}
+		}
+
+		// couldn't find it
+		return -1;
 	}
-	
-	// couldn't find it
-	return -1;
+
+	return Ship_names.find(name, matches);
+}
+
+/**
+ * Changes the name of a ship, names which are too long are truncated.
+ */
+void ship_rename(int shipnum, const char *name)
+{
+	Assert((shipnum >= 0) && (shipnum < MAX_SHIPS));
+	ship *shipp = &Ships[shipnum];
+
+	Ship_names.remove(shipp->ship_name, shipnum);
+
+	strncpy(shipp->ship_name, name, NAME_LENGTH - 1);
+	shipp->ship_name[NAME_LENGTH - 1] = '\0';
+
+	// only ships in the mission are indexed, see ship_create() and ship_delete()
+	if ((shipp->objnum >= 0) && !Fred_running)
+		Ship_names.add(shipp->ship_name, shipnum);
 }
 
 int ship_type_name_lookup(const char *name)
@@ -12740,15 +12790,7 @@ int ship_type_name_lookup(const char *name)
 		return -1;
 	}
 
-	//Look through Ship_types array
-	size_t max_size = Ship_types.size();
-	for(size_t idx=0; idx < max_size; idx++){
-		if(!stricmp(name, Ship_types[idx].name)){
-			return (int)idx;
-		}
-	}
-	// couldn't find it
-	return -1;
+	return Ship_type_names.find_in_table(name, (int)Ship_types.size(), [](int idx) { return Ship_types[idx].name; });
 }
 
 // checks the (arrival & departure) state of a ship.  Return values:
@@ -13985,12 +14027,14 @@ void ship_close()
 
 	// free info from parsed table data
 	Ship_info.clear();
+	Ship_info_names.clear();
 
 	for (i = 0; i < (int)Ship_types.size(); i++) {
 		Ship_types[i].ai_actively_pursues.clear();
 		Ship_types[i].ai_actively_pursues_temp.clear();
 	}
 	Ship_types.clear();
+	Ship_type_names.clear();
 	
 	if(CLOAKMAP != -1)
 		bm_release(CLOAKMAP);
@@ -1438,6 +1438,7 @@ void parse_ship_particle_effect(ship_info* sip, particle_effect* pe, char *id_st
 
 extern int ship_info_lookup(const char *name = NULL);
 extern int ship_name_lookup(const char *name, int inc_players = 0);	// returns the index into Ship array of name
+extern void ship_rename(int shipnum, const char *name);	// use this instead of writing ship_name so the ship can still be looked up
 extern int ship_type_name_lookup(const char *name);
 
 extern int wing_lookup(const char *name);
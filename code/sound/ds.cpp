@@ -246,35 +246,35 @@ int ds_get_sid()
 	return (int)(sound_buffers.size() - 1);
 }
 
-int ds_load_buffer(int *sid, int flags, ffmpeg::WaveFile* file)
+/**
+ * Decodes all of an audio file into memory
+ *
+ * Doesn't touch any OpenAL or sound system state so it may be called on a worker thread.
+ *
+ * @param decoded The decoded data and its format
+ * @param file The file to decode
+ * @return 0 on success, -1 if the audio format isn't supported
+ */
+int ds_decode_buffer(ds_decoded_data *decoded, ffmpeg::WaveFile* file)
 {
-	Assert(sid != NULL);
+	Assert(decoded != NULL);
 	Assert(file != NULL);
 
-	// All sounds are required to have a software buffer
-	*sid = ds_get_sid();
-	if (*sid == -1) {
-		nprintf(("Sound", "SOUND ==> No more sound buffers available\n"));
-		return -1;
-	}
-
-	ALuint pi;
-	OpenAL_ErrorCheck(alGenBuffers(1, &pi), return -1);
-
-	ALenum format;
 	ALsizei size = file->getTotalSamples() * file->getSampleByteSize();
-	ALint n_channels = file->getNumChannels();
-	ALsizei frequency;
-		
+
 	// format is now in pcm
-	frequency = file->getSampleRate();
-	format = file->getALFormat();
+	decoded->format = file->getALFormat();
+	decoded->frequency = file->getSampleRate();
+	decoded->bits_per_sample = (file->getSampleByteSize() / file->getNumChannels()) * 8;
+	decoded->n_channels = file->getNumChannels();
+	decoded->duration = file->getDuration();
 
-	if (format == AL_INVALID_VALUE) {
+	if (decoded->format == AL_INVALID_VALUE) {
 		return -1;
 	}
 
-	SCP_vector<uint8_t> audio_buffer;
+	SCP_vector<uint8_t>& audio_buffer = decoded->data;
+	audio_buffer.clear();
 	audio_buffer.reserve(size);
 
 	SCP_vector<uint8_t> buffer(file->getSampleRate() * file->getSampleByteSize());
@@ -288,21 +288,57 @@ int ds_load_buffer(int *sid, int flags, ffmpeg::WaveFile* file)
 		}
 	}
 
-	Snd_sram += audio_buffer.size();
+	return 0;
+}
 
-	OpenAL_ErrorCheck(alBufferData(pi, format, audio_buffer.data(), (ALsizei)audio_buffer.size(), frequency), return -1; );
+/**
+ * Creates a sound buffer from decoded audio data
+ *
+ * @param sid The sound id of the new buffer
+ * @param decoded Data from ds_decode_buffer()
+ * @return 0 on success, -1 on failure
+ */
+int ds_load_buffer(int *sid, const ds_decoded_data *decoded)
+{
+	Assert(sid != NULL);
+	Assert(decoded != NULL);
+
+	// All sounds are required to have a software buffer
+	*sid = ds_get_sid();
+	if (*sid == -1) {
+		nprintf(("Sound", "SOUND ==> No more sound buffers available\n"));
+		return -1;
+	}
+
+	ALuint pi;
+	OpenAL_ErrorCheck(alGenBuffers(1, &pi), return -1);
+
+	Snd_sram += decoded->data.size();
+
+	OpenAL_ErrorCheck(alBufferData(pi, decoded->format, decoded->data.data(), (ALsizei)decoded->data.size(), decoded->frequency), return -1; );
 
 	sound_buffers[*sid].buf_id = pi;
 	sound_buffers[*sid].channel_id = -1;
-	sound_buffers[*sid].frequency = frequency;
-	sound_buffers[*sid].bits_per_sample = (file->getSampleByteSize() / file->getNumChannels()) * 8;
-	sound_buffers[*sid].nchannels = n_channels;
-	sound_buffers[*sid].nseconds = fl2i(file->getDuration());
-	sound_buffers[*sid].nbytes = (int)audio_buffer.size();
+	sound_buffers[*sid].frequency = decoded->frequency;
+	sound_buffers[*sid].bits_per_sample = decoded->bits_per_sample;
+	sound_buffers[*sid].nchannels = decoded->n_channels;
+	sound_buffers[*sid].nseconds = fl2i(decoded->duration);
+	sound_buffers[*sid].nbytes = (int)decoded->data.size();
 
 	return 0;
 }
 
+int ds_load_buffer(int *sid, int flags, ffmpeg::WaveFile* file)
+{
+	ds_decoded_data decoded;
+
+	if (ds_decode_buffer(&decoded, file) == -1) {
+		return -1;
+	}
+
+	return ds_load_buffer(sid, &decoded);
+}
+
 /**
  * Initialise the ::Channels[] array
  */
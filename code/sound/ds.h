@@ -47,10 +47,22 @@ typedef struct sound_info {
 	int duration;	// time in ms for duration of sound
 } sound_info;
 
+// Audio data decoded by ds_decode_buffer() which ds_load_buffer() can hand to OpenAL
+struct ds_decoded_data {
+	SCP_vector<uint8_t> data;
+	int format = 0;				// the OpenAL format of the data
+	int frequency = 0;
+	int bits_per_sample = 0;
+	int n_channels = 0;
+	float duration = 0.0f;		// in seconds
+};
+
 extern int ds_initialized;
 
 int ds_init();
 void ds_close();
+int ds_decode_buffer(ds_decoded_data *decoded, ffmpeg::WaveFile* file);
+int ds_load_buffer(int *sid, const ds_decoded_data *decoded);
 int ds_load_buffer(int *sid, int flags, ffmpeg::WaveFile* file);
 void ds_unload_buffer(int sid);
 int ds_play(int sid, int snd_id, int priority, const EnhancedSoundData * enhanced_sound_data, float volume, float pan, int looping, bool is_voice_msg = false);
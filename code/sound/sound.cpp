@@ -26,6 +26,7 @@
 #include "sound/dscap.h"
 #include "tracing/Monitor.h"
 #include "tracing/tracing.h"
+#include "utils/threading.h"
 
 #include "globalincs/pstypes.h"
 
@@ -259,6 +260,144 @@ void snd_spew_debug_info()
 	gr_printf_no_resize(sx, sy, "Total sounds : %d\n", game_sounds + interface_sounds + message_sounds);
 }
 
+// A sound which snd_queue_loads() has been told snd_load() will be asked for soon
+struct snd_queued_load {
+	SCP_string filename;		// empty once snd_load() has used it
+	bool use_3d = false;
+	bool decoded = false;		// if the workers have been at it yet
+	bool ok = false;			// if they succeeded, otherwise snd_load() does it all over again on the main thread
+	bool multi_channel = false;	// the file has more than one channel and has been mixed down to mono
+	sound_info info;
+	ds_decoded_data data;
+};
+
+static SCP_vector<snd_queued_load> Snd_queued_loads;
+static size_t Snd_next_queued_load = 0;		// where snd_load() starts looking, the loads usually come in queue order
+
+// Opens a sound file and prepares it for use as a 3D sound if requested. Safe to call on a worker thread.
+static bool snd_open_file(ffmpeg::WaveFile *audio_file, const char *filename, bool use_3d, bool *multi_channel)
+{
+	*multi_channel = false;
+
+	if (!audio_file->Open(filename, false)) {
+		return false;
+	}
+
+	if (use_3d && (audio_file->getNumChannels() > 1)) {
+		// We need to resample the audio down to one channel
+		auto current = audio_file->getAudioProperties();
+		current.channel_layout = AV_CH_LAYOUT_MONO;
+
+		audio_file->setAdjustedAudioProperties(current);
+
+		*multi_channel = true;
+	}
+
+	return true;
+}
+
+// Fills in the sound info of an opened sound file
+static void snd_get_info(sound_info *si, ffmpeg::WaveFile *audio_file)
+{
+	si->n_channels			= audio_file->getNumChannels();		// 16-bit channel count (nChannels)
+	si->sample_rate			= audio_file->getSampleRate();	// 32-bit sample rate (nSamplesPerSec)
+	si->avg_bytes_per_sec	= audio_file->getSampleRate() * audio_file->getSampleByteSize();	// 32-bit average bytes per second (nAvgBytesPerSec)
+	si->bits					= audio_file->getSampleByteSize() / audio_file->getNumChannels() * 8;	// Read 16-bit bits per sample	
+	si->size					= audio_file->getTotalSamples() * audio_file->getSampleByteSize();
+}
+
+// Decodes a queued sound, called on the worker threads
+static void snd_decode_queued_load(snd_queued_load *load)
+{
+	ffmpeg::WaveFile audio_file;
+
+	// this also fails if the worker couldn't get a file block, snd_load() then tries again on the main thread
+	if (!snd_open_file(&audio_file, load->filename.c_str(), load->use_3d, &load->multi_channel)) {
+		return;
+	}
+
+	snd_get_info(&load->info, &audio_file);
+
+	load->ok = (ds_decode_buffer(&load->data, &audio_file) == 0);
+}
+
+// Finds the queued load for a sound, decoding it and the ones queued after it if that hasn't happened yet
+static snd_queued_load *snd_get_queued_load(const game_snd *gs)
+{
+	bool use_3d = (gs->flags & GAME_SND_USE_DS3D) != 0;
+	size_t count = Snd_queued_loads.size();
+
+	for (size_t i = 0; i < count; i++) {
+		size_t idx = (Snd_next_queued_load + i) % count;
+		snd_queued_load *load = &Snd_queued_loads[idx];
+
+		if ((load->use_3d != use_3d) || stricmp(load->filename.c_str(), gs->filename)) {
+			continue;
+		}
+
+		if (!load->decoded) {
+			// Only decode a limited number ahead so that not too much audio data is held at the same time
+			size_t batch_end = MIN(idx + (threading::num_workers() + 1) * 2, count);
+
+			threading::parallel_for(batch_end - idx, 1, [idx](size_t begin, size_t end) {
+				for (size_t j = idx + begin; j < idx + end; ++j) {
+					if (!Snd_queued_loads[j].decoded && !Snd_queued_loads[j].filename.empty()) {
+						snd_decode_queued_load(&Snd_queued_loads[j]);
+					}
+				}
+			});
+
+			for (size_t j = idx; j < batch_end; ++j) {
+				Snd_queued_loads[j].decoded = true;
+			}
+		}
+
+		Snd_next_queued_load = idx + 1;
+		return load;
+	}
+
+	return nullptr;
+}
+
+// ---------------------------------------------------------------------------------------
+// snd_queue_loads()
+//
+// Tells the sound system which sounds are going to be loaded next.  With -sound_threads
+// the snd_load() calls for them then find the sounds already decoded on the worker
+// threads and only hand them to OpenAL.  Sounds still queued from an earlier call are
+// dropped.
+//
+void snd_queue_loads(const SCP_vector<game_snd*> &sounds)
+{
+	Snd_queued_loads.clear();
+	Snd_next_queued_load = 0;
+
+	if ( !ds_initialized || !Cmdline_sound_threads || (threading::num_workers() == 0) )
+		return;
+
+	for (auto gs : sounds) {
+		if ( !VALID_FNAME(gs->filename) )
+			continue;
+
+		snd_queued_load load;
+		load.filename = gs->filename;
+		load.use_3d = (gs->flags & GAME_SND_USE_DS3D) != 0;
+
+		// the same file may be used by several game sounds
+		bool duplicate = false;
+		for (auto& other : Snd_queued_loads) {
+			if ((other.use_3d == load.use_3d) && !stricmp(other.filename.c_str(), gs->filename)) {
+				duplicate = true;
+				break;
+			}
+		}
+
+		if (!duplicate) {
+			Snd_queued_loads.push_back(std::move(load));
+		}
+	}
+}
+
 // ---------------------------------------------------------------------------------------
 // snd_load() 
 //
@@ -316,25 +455,29 @@ int snd_load( game_snd *gs, int allow_hardware_load )
 
 	TRACE_SCOPE(tracing::LoadSound);
 
-	std::unique_ptr<ffmpeg::WaveFile> audio_file(new ffmpeg::WaveFile());
+	std::unique_ptr<ffmpeg::WaveFile> audio_file;
+	bool multi_channel;
 
 	nprintf(("Sound", "SOUND ==> Loading '%s'\n", gs->filename));
 
-	if (!audio_file->Open(gs->filename, false)) {
-		return -1;
+	// maybe the worker threads have decoded it already
+	snd_queued_load *queued = snd_get_queued_load(gs);
+
+	if ( (queued == nullptr) || !queued->ok ) {
+		audio_file.reset(new ffmpeg::WaveFile());
+
+		if (!snd_open_file(audio_file.get(), gs->filename, (gs->flags & GAME_SND_USE_DS3D) != 0, &multi_channel)) {
+			return -1;
+		}
+	} else {
+		multi_channel = queued->multi_channel;
 	}
 
 	type = 0;
 	if (gs->flags & GAME_SND_USE_DS3D) {
 		type |= DS_3D;
 
-		if (audio_file->getNumChannels() > 1) {
-			// We need to resample the audio down to one channel
-			auto current = audio_file->getAudioProperties();
-			current.channel_layout = AV_CH_LAYOUT_MONO;
-
-			audio_file->setAdjustedAudioProperties(current);
-
+		if (multi_channel) {
 #ifndef NDEBUG
             // Retail has a few sounds that triggers this warning so we need to ignore those
             const char* warning_ignore_list[] = {
@@ -360,22 +503,35 @@ int snd_load( game_snd *gs, int allow_hardware_load )
 	}
 
 	// Load was a success
-	si->n_channels			= audio_file->getNumChannels();		// 16-bit channel count (nChannels)
-	si->sample_rate			= audio_file->getSampleRate();	// 32-bit sample rate (nSamplesPerSec)
-	si->avg_bytes_per_sec	= audio_file->getSampleRate() * audio_file->getSampleByteSize();	// 32-bit average bytes per second (nAvgBytesPerSec)
-	si->bits					= audio_file->getSampleByteSize() / audio_file->getNumChannels() * 8;	// Read 16-bit bits per sample	
-	si->size					= audio_file->getTotalSamples() * audio_file->getSampleByteSize();
+	if (audio_file) {
+		snd_get_info(si, audio_file.get());
+	} else {
+		*si = queued->info;
+	}
 
 	snd->uncompressed_size = si->size;
 
-	auto rc = ds_load_buffer(&snd->sid, type, audio_file.get());
+	int rc;
+	float duration;
+	if (audio_file) {
+		rc = ds_load_buffer(&snd->sid, type, audio_file.get());
+		duration = audio_file->getDuration();
+	} else {
+		rc = ds_load_buffer(&snd->sid, &queued->data);
+		duration = queued->data.duration;
+
+		// every queued sound is only loaded once
+		queued->filename.clear();
+		SCP_vector<uint8_t>().swap(queued->data.data);
+	}
+
 	if (rc == -1) {
 		nprintf(("Sound", "SOUND ==> Failed to load '%s'\n", gs->filename));
 		return -1;
 	}
 
 	// NOTE: "si" values can change once loaded in the buffer
-	snd->duration = fl2i(1000.0f * audio_file->getDuration());
+	snd->duration = fl2i(1000.0f * duration);
 
 	strcpy_s( snd->filename, gs->filename );
 	snd->flags = SND_F_USED;
@@ -444,6 +600,7 @@ void snd_close(void)
 {
 	snd_stop_all();
 	if (!ds_initialized) return;
+	snd_queue_loads(SCP_vector<game_snd*>());
 	snd_unload_all();		// free the sound data stored in DirectSound secondary buffers
 	dscap_close();	// Close DirectSoundCapture
 	ds_close();		// Close DirectSound off
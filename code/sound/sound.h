@@ -105,6 +105,7 @@ extern float aav_effect_volume;
 
 //int	snd_load( char *filename, int hardware=0, int three_d=0, int *sig=NULL );
 int	snd_load( game_snd *gs, int allow_hardware_load = 0);
+void	snd_queue_loads( const SCP_vector<game_snd*> &sounds );
 
 int	snd_unload( int sndnum );
 void	snd_unload_all();
@@ -629,6 +629,8 @@ set (file_root_model
 	model/model.h
 	model/modelanim.cpp
 	model/modelanim.h
+	model/modelcache.cpp
+	model/modelcache.h
 	model/modelcollide.cpp
 	model/modelinterp.cpp
 	model/modeloctant.cpp
@@ -745,6 +747,8 @@ set (file_root_object
 	object/objectsnd.cpp
 	object/objectsnd.h
 	object/objectsort.cpp
+	object/objectspatial.cpp
+	object/objectspatial.h
 	object/parseobjectdock.cpp
 	object/parseobjectdock.h
 	object/waypoint.cpp
@@ -1157,7 +1161,12 @@ set (file_root_ui
 )
 
 set(file_root_utils
+	utils/block_allocator.h
+	utils/flat_hash_map.h
+	utils/name_registry.h
 	utils/strings.h
+	utils/threading.cpp
+	utils/threading.h
 )
 
 # Utils files
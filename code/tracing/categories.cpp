@@ -35,6 +35,7 @@ Category LoadBatchingBuffers("Load batching buffers", true);
 Category SortColliders("Sort Colliders", false);
 Category FindOverlapColliders("Find overlap colliders", false);
 Category CollidePair("Collide Pair", false);
+Category CollisionPrefetch("Collision prefetch", false);
 
 Category WeaponPostMove("Weapon post move", false);
 Category ShipPostMove("Ship post move", false);
@@ -75,6 +76,8 @@ Category BuildShadowMap("Build Shadow Map", true);
 Category RenderScene("Render scene", true);
 Category RenderTrails("Render trails", true);
 Category MoveObjects("Move Objects", false);
+Category BuildSpatialIndex("Build spatial index", false);
+Category AITurretPrefetch("AI turret target prefetch", false);
 Category ProcessParticleEffects("Process particle effects", false);
 Category TrailsMoveAll("Trails move all", false);
 Category Simulation("Simulation", false);
@@ -99,6 +102,7 @@ Category ModelCreateVertexBuffers("Create model vertex buffers", false);
 Category ModelCreateOctants("Create model octants", false);
 Category ModelParseAllBSPTrees("Parse all BSP trees", false);
 Category ModelParseBSPTree("Parse BSP tree", false);
+Category ModelLoadCachedBSPTrees("Load cached BSP trees", false);
 Category ModelConfigureVertexBuffers("Model configure vertex buffers", false);
 Category ModelCreateTransparencyIndexBuffer("Model create transparency buffer", false);
 Category ModelCreateDetailIndexBuffers("Model create detail index buffers", false);
@@ -109,6 +113,7 @@ Category LoadSound("Load Sound", false);
 Category LevelPageIn("Level page in", false);
 Category PageInStop("Finish page in", false);
 Category PageInSingleBitmap("Page in single bitmap", false);
+Category PageInDecodeBitmaps("Decode bitmaps", false);
 Category ShipPageIn("Ship page in", false);
 Category WeaponPageIn("Weapon page in", false);
 }
@@ -47,6 +47,7 @@ extern Category LoadBatchingBuffers;
 extern Category SortColliders;
 extern Category FindOverlapColliders;
 extern Category CollidePair;
+extern Category CollisionPrefetch;
 
 extern Category WeaponPostMove;
 extern Category ShipPostMove;
@@ -87,6 +88,8 @@ extern Category BuildShadowMap;
 extern Category RenderScene;
 extern Category RenderTrails;
 extern Category MoveObjects;
+extern Category BuildSpatialIndex;
+extern Category AITurretPrefetch;
 extern Category ProcessParticleEffects;
 extern Category TrailsMoveAll;
 extern Category Simulation;
@@ -112,6 +115,7 @@ extern Category ModelCreateVertexBuffers;
 extern Category ModelCreateOctants;
 extern Category ModelParseAllBSPTrees;
 extern Category ModelParseBSPTree;
+extern Category ModelLoadCachedBSPTrees;
 extern Category ModelConfigureVertexBuffers;
 extern Category ModelCreateTransparencyIndexBuffer;
 extern Category ModelCreateDetailIndexBuffers;
@@ -122,6 +126,7 @@ extern Category LoadSound;
 extern Category LevelPageIn;
 extern Category PageInStop;
 extern Category PageInSingleBitmap;
+extern Category PageInDecodeBitmaps;
 extern Category ShipPageIn;
 extern Category WeaponPageIn;
 
@@ -0,0 +1,209 @@
+#pragma once
+
+#include "globalincs/pstypes.h"
+
+/**
+ * @brief Keeps track of which entries of a fixed size array are in use
+ *
+ * The free entries are kept in a segment tree which stores the longest run of free entries for every subrange of the
+ * array. Finding the first run of a given length, the last free entry or changing the state of an entry all take
+ * O(log n) instead of scanning the array. The returned positions are the same as the ones a linear scan from the start
+ * (or from the end for allocate_last()) would find.
+ */
+class block_allocator {
+	struct node {
+		int length;		// The number of entries covered by this node
+		int prefix;		// Free entries at the start of the range
+		int suffix;		// Free entries at the end of the range
+		int best;		// The longest run of free entries in the range
+	};
+
+	SCP_vector<node> _nodes;
+	int _leaves = 0;
+	int _size = 0;
+	int _used = 0;
+
+	void set_leaf(int index, bool free) {
+		auto pos = _leaves + index;
+		auto value = free ? 1 : 0;
+
+		_nodes[pos].prefix = value;
+		_nodes[pos].suffix = value;
+		_nodes[pos].best = value;
+
+		for (pos /= 2; pos >= 1; pos /= 2) {
+			update(pos);
+		}
+	}
+
+	void update(int pos) {
+		const auto& left = _nodes[pos * 2];
+		const auto& right = _nodes[pos * 2 + 1];
+		auto& n = _nodes[pos];
+
+		n.prefix = (left.prefix == left.length) ? left.length + right.prefix : left.prefix;
+		n.suffix = (right.suffix == right.length) ? right.length + left.suffix : right.suffix;
+		n.best = std::max(std::max(left.best, right.best), left.suffix + right.prefix);
+	}
+
+ public:
+	block_allocator() = default;
+
+	explicit block_allocator(int size) {
+		reset(size);
+	}
+
+	/**
+	 * @brief Resizes the tracked array and marks all entries as free
+	 */
+	void reset(int size) {
+		Assertion(size >= 0, "Invalid size %d!", size);
+
+		_size = size;
+		_used = 0;
+
+		_leaves = 1;
+		while (_leaves < size) {
+			_leaves *= 2;
+		}
+
+		_nodes.assign(_leaves * 2, node());
+
+		for (int i = 0; i < _leaves; ++i) {
+			// The padding at the end is never free so runs can't extend into it
+			auto value = (i < size) ? 1 : 0;
+			auto& leaf = _nodes[_leaves + i];
+
+			leaf.length = 1;
+			leaf.prefix = value;
+			leaf.suffix = value;
+			leaf.best = value;
+		}
+
+		for (int pos = _leaves - 1; pos >= 1; --pos) {
+			_nodes[pos].length = _nodes[pos * 2].length * 2;
+			update(pos);
+		}
+	}
+
+	int size() const {
+		return _size;
+	}
+
+	int num_used() const {
+		return _used;
+	}
+
+	bool is_used(int index) const {
+		Assertion(index >= 0 && index < _size, "Index %d is out of range!", index);
+
+		return _nodes[_leaves + index].best == 0;
+	}
+
+	/**
+	 * @brief The length of the longest run of free entries
+	 */
+	int largest_free_block() const {
+		return _size > 0 ? _nodes[1].best : 0;
+	}
+
+	/**
+	 * @brief Counts the runs of free entries
+	 *
+	 * This walks over the whole array so it should only be used for statistics.
+	 */
+	int count_free_blocks() const {
+		int blocks = 0;
+		bool in_block = false;
+
+		for (int i = 0; i < _size; ++i) {
+			bool free = !is_used(i);
+
+			if (free && !in_block) {
+				++blocks;
+			}
+			in_block = free;
+		}
+
+		return blocks;
+	}
+
+	/**
+	 * @brief Finds the first run of free entries with the given length and marks it as used
+	 * @return The index of the first entry of the run or -1 if there is no such run
+	 */
+	int allocate_first(int count) {
+		Assertion(count > 0, "Invalid block size %d!", count);
+
+		if (largest_free_block() < count) {
+			return -1;
+		}
+
+		int pos = 1;
+		int start = -1;
+
+		while (pos < _leaves) {
+			const auto& left = _nodes[pos * 2];
+			const auto& right = _nodes[pos * 2 + 1];
+
+			if (left.best >= count) {
+				pos = pos * 2;
+			} else if (left.suffix + right.prefix >= count) {
+				// The run starts in the left half and continues into the right half
+				auto mid = (pos * 2 + 1) * right.length - _leaves;
+
+				start = mid - left.suffix;
+				break;
+			} else {
+				pos = pos * 2 + 1;
+			}
+		}
+
+		if (start < 0) {
+			start = pos - _leaves;
+		}
+
+		for (int i = 0; i < count; ++i) {
+			set_leaf(start + i, false);
+		}
+		_used += count;
+
+		return start;
+	}
+
+	/**
+	 * @brief Finds the last free entry and marks it as used
+	 * @return The index of the entry or -1 if all entries are in use
+	 */
+	int allocate_last() {
+		if (largest_free_block() == 0) {
+			return -1;
+		}
+
+		int pos = 1;
+		while (pos < _leaves) {
+			pos = (_nodes[pos * 2 + 1].best > 0) ? pos * 2 + 1 : pos * 2;
+		}
+
+		auto index = pos - _leaves;
+
+		set_leaf(index, false);
+		++_used;
+
+		return index;
+	}
+
+	/**
+	 * @brief Marks a run of entries as free again
+	 */
+	void release(int start, int count) {
+		Assertion(start >= 0 && count >= 0 && start + count <= _size, "Invalid range %d+%d!", start, count);
+
+		for (int i = start; i < start + count; ++i) {
+			Assertion(is_used(i), "Entry %d is not in use!", i);
+
+			set_leaf(i, true);
+		}
+		_used -= count;
+	}
+};
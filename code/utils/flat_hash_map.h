@@ -0,0 +1,245 @@
+#pragma once
+
+#include "globalincs/pstypes.h"
+
+#include <limits>
+
+/**
+ * @brief An open addressing hash map with unsigned integer keys
+ *
+ * Keys and values are stored in two flat arrays and collisions are resolved by linear probing, so a lookup usually
+ * only touches one or two cache lines instead of chasing the node pointers of SCP_unordered_map. Erasing shifts the
+ * following entries of the probe sequence back instead of leaving tombstones behind, so the table never has to be
+ * rebuilt because of deleted entries.
+ *
+ * Pointers to values are invalidated by any insertion or erase.
+ *
+ * @tparam T The value type, must be default constructible
+ */
+template<typename T>
+class flat_hash_map {
+ public:
+	typedef uint key_type;
+
+	/// The one key value which may not be used, it marks empty slots
+	static const key_type EMPTY_KEY = std::numeric_limits<key_type>::max();
+
+ private:
+	SCP_vector<key_type> _keys;
+	SCP_vector<T> _values;
+	size_t _size = 0;
+	size_t _mask = 0;
+	int _shift = 32;
+
+	size_t home_slot(key_type key) const {
+		// Fibonacci hashing spreads keys which only differ in a few bits (like packed object indices) over the table
+		return (size_t)((std::uint32_t)(key * 2654435769u) >> _shift);
+	}
+
+	void rehash(size_t new_capacity) {
+		SCP_vector<key_type> old_keys;
+		SCP_vector<T> old_values;
+
+		old_keys.swap(_keys);
+		old_values.swap(_values);
+
+		_keys.assign(new_capacity, EMPTY_KEY);
+		_values.assign(new_capacity, T());
+		_mask = new_capacity - 1;
+
+		_shift = 32;
+		for (size_t cap = new_capacity; cap > 1; cap >>= 1) {
+			--_shift;
+		}
+
+		for (size_t i = 0; i < old_keys.size(); ++i) {
+			if (old_keys[i] == EMPTY_KEY) {
+				continue;
+			}
+
+			auto slot = home_slot(old_keys[i]);
+			while (_keys[slot] != EMPTY_KEY) {
+				slot = (slot + 1) & _mask;
+			}
+
+			_keys[slot] = old_keys[i];
+			_values[slot] = std::move(old_values[i]);
+		}
+	}
+
+	void erase_slot(size_t hole) {
+		// Move following entries of the same cluster back into the hole if that doesn't place them before their
+		// home slot. This keeps every entry reachable from its home slot without needing tombstones.
+		auto slot = hole;
+		while (true) {
+			slot = (slot + 1) & _mask;
+
+			if (_keys[slot] == EMPTY_KEY) {
+				break;
+			}
+
+			auto home = home_slot(_keys[slot]);
+
+			// Distance from the home slot of the entry to the hole and to its current slot, modulo the table size
+			if (((hole - home) & _mask) < ((slot - home) & _mask)) {
+				_keys[hole] = _keys[slot];
+				_values[hole] = std::move(_values[slot]);
+				hole = slot;
+			}
+		}
+
+		_keys[hole] = EMPTY_KEY;
+		_values[hole] = T();
+		--_size;
+	}
+
+ public:
+	flat_hash_map() = default;
+
+	size_t size() const {
+		return _size;
+	}
+
+	bool empty() const {
+		return _size == 0;
+	}
+
+	size_t capacity() const {
+		return _keys.size();
+	}
+
+	/**
+	 * @brief Makes sure that the given number of elements fit into the table without growing it
+	 */
+	void reserve(size_t count) {
+		size_t capacity = 16;
+		while (capacity * 3 < count * 4) {
+			capacity *= 2;
+		}
+
+		if (capacity > _keys.size()) {
+			rehash(capacity);
+		}
+	}
+
+	void clear() {
+		std::fill(_keys.begin(), _keys.end(), EMPTY_KEY);
+		std::fill(_values.begin(), _values.end(), T());
+		_size = 0;
+	}
+
+	/**
+	 * @brief Looks up a key
+	 * @return A pointer to the value or @c nullptr if the key is not in the map
+	 */
+	T* find(key_type key) {
+		Assertion(key != EMPTY_KEY, "The empty key can not be used as a key!");
+
+		if (_size == 0) {
+			return nullptr;
+		}
+
+		auto slot = home_slot(key);
+		while (_keys[slot] != EMPTY_KEY) {
+			if (_keys[slot] == key) {
+				return &_values[slot];
+			}
+			slot = (slot + 1) & _mask;
+		}
+
+		return nullptr;
+	}
+
+	const T* find(key_type key) const {
+		return const_cast<flat_hash_map*>(this)->find(key);
+	}
+
+	/**
+	 * @brief Gets the value of a key, inserting a default constructed value if it does not exist yet
+	 */
+	T& operator[](key_type key) {
+		Assertion(key != EMPTY_KEY, "The empty key can not be used as a key!");
+
+		// Keep the load factor at or below 3/4
+		if ((_size + 1) * 4 > _keys.size() * 3) {
+			rehash(std::max(_keys.size() * 2, (size_t)16));
+		}
+
+		auto slot = home_slot(key);
+		while (_keys[slot] != EMPTY_KEY) {
+			if (_keys[slot] == key) {
+				return _values[slot];
+			}
+			slot = (slot + 1) & _mask;
+		}
+
+		_keys[slot] = key;
+		++_size;
+
+		return _values[slot];
+	}
+
+	/**
+	 * @brief Removes a key from the map
+	 * @return @c true if the key was in the map
+	 */
+	bool erase(key_type key) {
+		Assertion(key != EMPTY_KEY, "The empty key can not be used as a key!");
+
+		if (_size == 0) {
+			return false;
+		}
+
+		auto slot = home_slot(key);
+		while (_keys[slot] != EMPTY_KEY) {
+			if (_keys[slot] == key) {
+				erase_slot(slot);
+				return true;
+			}
+			slot = (slot + 1) & _mask;
+		}
+
+		return false;
+	}
+
+	/**
+	 * @brief Removes all entries for which the predicate returns @c true in a single pass over the table
+	 *
+	 * @param pred Called as pred(key, value), may be called more than once for the same entry
+	 * @return The number of removed entries
+	 */
+	template<typename Pred>
+	size_t erase_if(Pred pred) {
+		size_t removed = 0;
+
+		for (size_t slot = 0; slot < _keys.size();) {
+			if (_keys[slot] != EMPTY_KEY && pred(_keys[slot], _values[slot])) {
+				erase_slot(slot);
+				++removed;
+
+				// Another entry may have been moved into this slot so check it again
+				continue;
+			}
+			++slot;
+		}
+
+		return removed;
+	}
+
+	/**
+	 * @brief Calls a function for every entry in the map
+	 *
+	 * @param func Called as func(key, value). The map must not be modified while iterating.
+	 */
+	template<typename Func>
+	void for_each(Func func) {
+		for (size_t slot = 0; slot < _keys.size(); ++slot) {
+			if (_keys[slot] != EMPTY_KEY) {
+				func(_keys[slot], _values[slot]);
+			}
+		}
+	}
+};
+
+template<typename T>
+const typename flat_hash_map<T>::key_type flat_hash_map<T>::EMPTY_KEY;
@@ -0,0 +1,184 @@
+#pragma once
+
+#include "globalincs/pstypes.h"
+#include "utils/flat_hash_map.h"
+
+/**
+ * @brief Case insensitive index from names to the entries of an array
+ *
+ * Entries are bucketed by the case insensitive hash of their name. The entries of a bucket are linked in ascending
+ * index order so find() returns the same entry a linear scan from the start of the array would. Different names may
+ * end up in the same bucket, so the predicate passed to find() has to compare the actual name.
+ *
+ * Arrays which are only ever appended to, cleared or reordered as a whole (like the table data) can use
+ * find_in_table() which keeps the index up to date by itself. Everything else has to call add() and remove()
+ * whenever the name of an entry changes.
+ */
+class name_registry {
+ public:
+	typedef uint hash_type;
+
+ private:
+	struct bucket {
+		int first = -1;
+	};
+
+	flat_hash_map<bucket> _buckets;
+	SCP_vector<int> _next;
+	size_t _size = 0;
+
+ public:
+	/**
+	 * @brief The case insensitive hash of a name, the same names stricmp() considers equal have the same hash
+	 */
+	static hash_type hash_name(const char* name) {
+		hash_type hash = 2166136261u;
+
+		for (; *name != '\0'; ++name) {
+			hash ^= (hash_type)(unsigned char)tolower((unsigned char)*name);
+			hash *= 16777619u;
+		}
+
+		if (hash == flat_hash_map<bucket>::EMPTY_KEY) {
+			hash = 0;
+		}
+
+		return hash;
+	}
+
+	/**
+	 * @brief The number of indexed entries
+	 */
+	size_t size() const {
+		return _size;
+	}
+
+	void clear() {
+		_buckets.clear();
+		_next.clear();
+		_size = 0;
+	}
+
+	/**
+	 * @brief Adds an entry, it must not be in the index already
+	 */
+	void add(const char* name, int index) {
+		Assertion(index >= 0, "Invalid index %d!", index);
+
+		if ((size_t)index >= _next.size()) {
+			_next.resize(index + 1, -1);
+		}
+
+		int* link = &_buckets[hash_name(name)].first;
+		while ((*link >= 0) && (*link < index)) {
+			link = &_next[*link];
+		}
+
+		_next[index] = *link;
+		*link = index;
+		++_size;
+	}
+
+	/**
+	 * @brief Removes an entry, must be called with the name the entry was added with
+	 * @return @c true if the entry was in the index
+	 */
+	bool remove(const char* name, int index) {
+		auto hash = hash_name(name);
+		auto entry = _buckets.find(hash);
+		bool found = false;
+
+		if (entry == nullptr) {
+			return false;
+		}
+
+		for (int* link = &entry->first; *link >= 0; link = &_next[*link]) {
+			if (*link == index) {
+				*link = _next[index];
+				_next[index] = -1;
+				--_size;
+				found = true;
+				break;
+			}
+		}
+
+		if (entry->first < 0) {
+			_buckets.erase(hash);
+		}
+
+		return found;
+	}
+
+	/**
+	 * @brief Finds the first entry indexed under the hash of a name which matches a predicate
+	 *
+	 * @param name The name to look for
+	 * @param pred Called as pred(index) in ascending index order, must check the name of the entry as well
+	 * @return The index of the entry or -1 if there is none
+	 */
+	template<typename Pred>
+	int find(const char* name, Pred pred) const {
+		auto entry = _buckets.find(hash_name(name));
+
+		if (entry == nullptr) {
+			return -1;
+		}
+
+		for (int index = entry->first; index >= 0; index = _next[index]) {
+			if (pred(index)) {
+				return index;
+			}
+		}
+
+		return -1;
+	}
+
+	/**
+	 * @brief Looks up a name in an array which is only appended to, cleared or reordered as a whole
+	 *
+	 * New entries at the end of the array are added before the lookup. If the array got shorter or an indexed entry
+	 * no longer has the name it was added with, the index is rebuilt from scratch.
+	 *
+	 * @param name The name to look for
+	 * @param count The current number of entries in the array
+	 * @param name_of Called as name_of(index), returns the current name of an entry
+	 * @param pred Called as pred(index) for the entries with that name, in ascending index order
+	 * @return The index of the first entry with that name which matches the predicate or -1 if there is none
+	 */
+	template<typename NameFunc, typename Pred>
+	int find_in_table(const char* name, int count, NameFunc name_of, Pred pred) {
+		if (_size > (size_t)count) {
+			clear();
+		}
+		for (int i = (int)_size; i < count; ++i) {
+			add(name_of(i), i);
+		}
+
+		auto hash = hash_name(name);
+		bool stale = false;
+
+		auto index = find(name, [&](int i) {
+			if (!stricmp(name_of(i), name)) {
+				return pred(i);
+			}
+
+			// Either another name with the same hash or an entry which has been replaced
+			if (hash_name(name_of(i)) != hash) {
+				stale = true;
+			}
+			return false;
+		});
+
+		if (index < 0 && stale) {
+			clear();
+			return find_in_table(name, count, name_of, pred);
+		}
+
+		return index;
+	}
+
+	template<typename NameFunc>
+	int find_in_table(const char* name, int count, NameFunc name_of) {
+		return find_in_table(name, count, name_of, [](int) { return true; });
+	}
+};
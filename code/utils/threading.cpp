@@ -0,0 +1,173 @@
+
+#include "utils/threading.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+const std::thread::id main_thread_id = std::this_thread::get_id();
+
+std::mutex queue_mutex;
+std::condition_variable queue_cond;
+std::deque<std::function<void()>> job_queue;
+bool shutting_down = false;
+
+SCP_vector<std::thread> worker_threads;
+
+void worker_thread_main() {
+	while (true) {
+		std::function<void()> job;
+
+		{
+			std::unique_lock<std::mutex> lock(queue_mutex);
+			queue_cond.wait(lock, []() { return shutting_down || !job_queue.empty(); });
+
+			if (job_queue.empty()) {
+				// Only possible if we are shutting down
+				return;
+			}
+
+			job = std::move(job_queue.front());
+			job_queue.pop_front();
+		}
+
+		job();
+	}
+}
+
+struct parallel_for_state {
+	std::atomic<size_t> next_chunk;
+	size_t num_chunks;
+	size_t chunk_size;
+	size_t count;
+
+	std::mutex done_mutex;
+	std::condition_variable done_cond;
+	size_t chunks_done;
+
+	const std::function<void(size_t, size_t)>* func;
+};
+
+void parallel_for_run_chunks(parallel_for_state* state) {
+	while (true) {
+		auto chunk = state->next_chunk.fetch_add(1);
+
+		if (chunk >= state->num_chunks) {
+			return;
+		}
+
+		auto begin = chunk * state->chunk_size;
+		auto end = std::min(begin + state->chunk_size, state->count);
+
+		(*state->func)(begin, end);
+
+		std::lock_guard<std::mutex> guard(state->done_mutex);
+		++state->chunks_done;
+		if (state->chunks_done == state->num_chunks) {
+			state->done_cond.notify_all();
+		}
+	}
+}
+
+}
+
+namespace threading {
+
+void init(int num_threads) {
+	Assertion(worker_threads.empty(), "Worker threads have already been initialized!");
+
+	if (num_threads < 0) {
+		// Leave one hardware thread for the main thread
+		num_threads = std::max((int)std::thread::hardware_concurrency() - 1, 0);
+	}
+
+	shutting_down = false;
+
+	for (int i = 0; i < num_threads; ++i) {
+		worker_threads.emplace_back(worker_thread_main);
+	}
+
+	mprintf(("Started %d worker threads.\n", num_threads));
+}
+
+void shutdown() {
+	{
+		std::lock_guard<std::mutex> guard(queue_mutex);
+		shutting_down = true;
+	}
+	queue_cond.notify_all();
+
+	for (auto& thread : worker_threads) {
+		thread.join();
+	}
+	worker_threads.clear();
+}
+
+size_t num_workers() {
+	return worker_threads.size();
+}
+
+bool is_main_thread() {
+	return std::this_thread::get_id() == main_thread_id;
+}
+
+void submit(std::function<void()> job) {
+	if (worker_threads.empty()) {
+		job();
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> guard(queue_mutex);
+		job_queue.push_back(std::move(job));
+	}
+	queue_cond.notify_one();
+}
+
+void parallel_for(size_t count, size_t min_chunk, const std::function<void(size_t begin, size_t end)>& func) {
+	if (count == 0) {
+		return;
+	}
+
+	min_chunk = std::max(min_chunk, (size_t)1);
+
+	// Split the work into a few more chunks than we have threads so that uneven chunks balance out
+	auto num_threads = worker_threads.size() + 1;
+	auto chunk_size = std::max(min_chunk, (count + num_threads * 4 - 1) / (num_threads * 4));
+	auto num_chunks = (count + chunk_size - 1) / chunk_size;
+
+	if (worker_threads.empty() || num_chunks == 1) {
+		func(0, count);
+		return;
+	}
+
+	// The state is shared since helper jobs may only start running after all the work has been done already
+	auto state = std::make_shared<parallel_for_state>();
+	state->next_chunk = 0;
+	state->num_chunks = num_chunks;
+	state->chunk_size = chunk_size;
+	state->count = count;
+	state->chunks_done = 0;
+	state->func = &func;
+
+	auto num_helpers = std::min(worker_threads.size(), num_chunks - 1);
+	{
+		std::lock_guard<std::mutex> guard(queue_mutex);
+		for (size_t i = 0; i < num_helpers; ++i) {
+			job_queue.push_back([state]() { parallel_for_run_chunks(state.get()); });
+		}
+	}
+	queue_cond.notify_all();
+
+	parallel_for_run_chunks(state.get());
+
+	std::unique_lock<std::mutex> lock(state->done_mutex);
+	state->done_cond.wait(lock, [&state]() { return state->chunks_done == state->num_chunks; });
+}
+
+}
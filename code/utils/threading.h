@@ -0,0 +1,70 @@
+#pragma once
+
+#include "globalincs/pstypes.h"
+
+#include <functional>
+
+/** @file
+ *  @ingroup threading
+ */
+
+/**
+ * @defgroup threading Worker threads
+ *
+ * A small pool of worker threads which engine subsystems can use to spread independent work across all cores. The pool
+ * is only used by code which explicitly opts in (usually via a command line option) and the results of any work which
+ * is done on it must be merged back on the main thread in a deterministic order.
+ */
+
+namespace threading {
+
+/**
+ * @brief Starts the worker threads
+ *
+ * @param num_threads The number of worker threads to start. If this is negative the number is chosen based on the
+ * number of hardware threads. If this is 0 then all work will be executed on the calling thread.
+ */
+void init(int num_threads = -1);
+
+/**
+ * @brief Stops all worker threads
+ *
+ * Jobs which have already been submitted are finished before this returns.
+ */
+void shutdown();
+
+/**
+ * @brief Gets the number of worker threads which are currently running
+ * @return The number of worker threads, 0 if the pool has not been initialized
+ */
+size_t num_workers();
+
+/**
+ * @brief Determines if the current thread is the main thread
+ * @return @c true if called from the thread the engine was started on
+ */
+bool is_main_thread();
+
+/**
+ * @brief Submits a job to be run on one of the worker threads
+ *
+ * If there are no worker threads the job is executed immediately.
+ *
+ * @warning The job must not access any engine state which is not safe to use from a different thread
+ *
+ * @param job The job to run
+ */
+void submit(std::function<void()> job);
+
+/**
+ * @brief Splits a range of work into chunks and runs them on the worker threads
+ *
+ * The calling thread participates in the work and this function only returns once all items have been processed.
+ *
+ * @param count The number of items to process
+ * @param min_chunk The minimum number of items which should be handled by a single call of @c func
+ * @param func The function to call with the half-open [begin, end) item range which should be processed
+ */
+void parallel_for(size_t count, size_t min_chunk, const std::function<void(size_t begin, size_t end)>& func);
+
+}
@@ -15,6 +15,7 @@
 #include "io/timer.h"
 #include "model/modelrender.h"
 #include "object/object.h"
+#include "object/objectspatial.h"
 #include "render/3d.h"
 #include "render/batching.h"
 #include "ship/ship.h"
@@ -263,7 +264,11 @@ void shockwave_move(object *shockwave_objp, float frametime)
 
 	// blast ships and asteroids
 	// And (some) weapons
-	for ( objp = GET_FIRST(&obj_used_list); objp !=END_OF_LIST(&obj_used_list); objp = GET_NEXT(objp) ) {
+	SCP_vector<object*> targets;
+	obj_spatial_get_objects(SPATIAL_SHIPS | SPATIAL_ASTEROIDS | SPATIAL_WEAPONS_HITPOINTS, targets);
+
+	for (auto target : targets) {
+		objp = target;
 		if ( (objp->type != OBJ_SHIP) && (objp->type != OBJ_ASTEROID) && (objp->type != OBJ_WEAPON)) {
 			continue;
 		}
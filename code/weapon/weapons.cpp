@@ -34,6 +34,7 @@
 #include "network/multiutil.h"
 #include "object/objcollide.h"
 #include "object/object.h"
+#include "object/objectspatial.h"
 #include "parse/parselo.h"
 #include "scripting/scripting.h"
 #include "particle/particle.h"
@@ -57,6 +58,7 @@
 #include "particle/effects/ParticleEmitterEffect.h"
 #include "tracing/Monitor.h"
 #include "tracing/tracing.h"
+#include "utils/name_registry.h"
 
 // Since SSMs are parsed after weapons, if we want to allow SSM strikes to be specified by name, we need to store those names until after SSMs are parsed.
 typedef struct delayed_ssm_data {
@@ -179,6 +181,9 @@ const size_t num_weapon_info_flags = sizeof(Weapon_Info_Flags) / sizeof(flag_def
 
 int Num_weapon_types = 0;
 
+// Index of Weapon_info by name for weapon_info_lookup()
+static name_registry Weapon_info_names;
+
 int Num_weapons = 0;
 int Weapons_inited = 0;
 int Weapon_expl_initted = 0;
@@ -545,11 +550,7 @@ int weapon_info_lookup(const char *name)
 	if (name == NULL)
 		return -1;
 
-	for (int i=0; i<Num_weapon_types; i++)
-		if (!stricmp(name, Weapon_info[i].name))
-			return i;
-
-	return -1;
+	return Weapon_info_names.find_in_table(name, Num_weapon_types, [](int i) { return Weapon_info[i].name; });
 }
 
 #define DEFAULT_WEAPON_SPAWN_COUNT	10
@@ -3059,6 +3060,9 @@ void weapon_sort_by_type()
 	if (big_missiles)	delete [] big_missiles;
 	if (child_primaries)	delete [] child_primaries;
 	if (child_secondaries)	delete [] child_secondaries;
+
+	// every entry has moved
+	Weapon_info_names.clear();
 }
 
 /**
@@ -3468,6 +3472,7 @@ void weapon_init()
 
 		Num_weapon_types = 0;
 		Num_spawn_types = 0;
+		Weapon_info_names.clear();
 
 		parse_weaponstbl("weapons.tbl");
 
@@ -3720,8 +3725,12 @@ void find_homing_object(object *weapon_objp, int num)
 
 	wp->homing_object = &obj_used_list;
 
-	//	Scan all objects, find a weapon to home on.
-	for ( objp = GET_FIRST(&obj_used_list); objp !=END_OF_LIST(&obj_used_list); objp = GET_NEXT(objp) ) {
+	//	Scan all ships and countermeasures, find one to home on.
+	SCP_vector<object*> candidates;
+	obj_spatial_get_objects(SPATIAL_SHIPS | SPATIAL_CMEASURES, candidates);
+
+	for (auto candidate : candidates) {
+		objp = candidate;
 		if ((objp->type == OBJ_SHIP) || ((objp->type == OBJ_WEAPON) && (Weapon_info[Weapons[objp->instance].weapon_info_index].wi_flags[Weapon::Info_Flags::Cmeasure])))
 		{
 			//WMC - Spawn weapons shouldn't go for protected ships
@@ -3823,8 +3832,10 @@ void find_homing_object(object *weapon_objp, int num)
 
 /**
  * Scan all countermeasures.  Maybe make weapon_objp home on it.
+ *
+ * @param cmeasures All countermeasures in obj_used_list order, see obj_spatial_get_objects()
  */
-void find_homing_object_cmeasures_1(object *weapon_objp)
+void find_homing_object_cmeasures_1(object *weapon_objp, const SCP_vector<object*>& cmeasures)
 {
 	object	*objp;
 	weapon	*wp, *cm_wp;
@@ -3836,8 +3847,10 @@ void find_homing_object_cmeasures_1(object *weapon_objp)
 
 	best_dot = wip->fov;			//	Note, setting to this avoids comparison below.
 
-	for ( objp = GET_FIRST(&obj_used_list); objp !=END_OF_LIST(&obj_used_list); objp = GET_NEXT(objp) )
+	for (auto cmeasure : cmeasures)
 	{
+		objp = cmeasure;
+
 		//first check if its a weapon, then setup the pointers
 		if (objp->type == OBJ_WEAPON)
 		{
@@ -3931,12 +3944,15 @@ void find_homing_object_cmeasures()
 
 	Cmeasures_homing_check--;
 
+	SCP_vector<object*> cmeasures;
+	obj_spatial_get_objects(SPATIAL_CMEASURES, cmeasures);
+
 	for (weapon_objp = GET_FIRST(&obj_used_list); weapon_objp != END_OF_LIST(&obj_used_list); weapon_objp = GET_NEXT(weapon_objp) ) {
 		if (weapon_objp->type == OBJ_WEAPON) {
 			weapon_info	*wip = &Weapon_info[Weapons[weapon_objp->instance].weapon_info_index];
 
 			if (wip->is_homing())
-				find_homing_object_cmeasures_1(weapon_objp);
+				find_homing_object_cmeasures_1(weapon_objp, cmeasures);
 		}
 	}
 
@@ -5972,7 +5988,11 @@ void weapon_do_area_effect(object *wobjp, shockwave_create_info *sci, vec3d *pos
 
 	// only blast ships and asteroids
 	// And (some) weapons
-	for ( objp = GET_FIRST(&obj_used_list); objp !=END_OF_LIST(&obj_used_list); objp = GET_NEXT(objp) ) {
+	SCP_vector<object*> targets;
+	obj_spatial_get_objects(SPATIAL_SHIPS | SPATIAL_ASTEROIDS | SPATIAL_WEAPONS_HITPOINTS, targets);
+
+	for (auto target : targets) {
+		objp = target;
 		if ( (objp->type != OBJ_SHIP) && (objp->type != OBJ_ASTEROID) && (objp->type != OBJ_WEAPON) ) {
 			continue;
 		}
@@ -159,6 +159,7 @@
 #include "stats/medals.h"
 #include "stats/stats.h"
 #include "tracing/tracing.h"
+#include "utils/threading.h"
 #include "weapon/beam.h"
 #include "weapon/emp.h"
 #include "weapon/flak.h"
@@ -1801,6 +1802,12 @@ void game_init()
 	// This needs to happen after graphics initialization
 	tracing::init();
 
+	// the worker threads are only needed by the experimental options which use them
+	if (Cmdline_collision_threads || Cmdline_bitmap_threads || Cmdline_ai_threads || Cmdline_parse_threads
+		|| Cmdline_sound_threads || Cmdline_physics_threads) {
+		threading::init();
+	}
+
 // Karajorma - Moved here from the sound init code cause otherwise windows complains
 #ifdef FS2_VOICER
 	if(Cmdline_voice_recognition)
@@ -6865,6 +6872,8 @@ void game_shutdown(void)
 	model_free_all();
 	bm_unload_all();			// unload/free bitmaps, has to be called *after* model_free_all()!
 
+	threading::shutdown();
+
 	tracing::shutdown();
 
 #ifndef NDEBUG
@@ -1,5 +1,7 @@
 
 #include <gtest/gtest.h>
+#include <cfile/cfilesystem.h>
+#include <cmdline/cmdline.h>
 #include <graphics/font.h>
 
 #include "util/FSTestFixture.h"
@@ -81,3 +83,141 @@ TEST_F(CFileTest, list_files_in_vps_and_dirs) {
 	ASSERT_STREQ("dir", table_files[0].c_str());
 	ASSERT_STREQ("dir2", table_files[1].c_str());
 }
+
+TEST_F(CFileTest, find_file_location) {
+	char pack_filename[MAX_PATH_LEN];
+	size_t size;
+	size_t offset;
+
+	// only in the VP, lookups are case insensitive
+	ASSERT_EQ(1, cf_find_file_location("TEST.tbl", CF_TYPE_TABLES, sizeof(pack_filename) - 1, pack_filename, &size, &offset));
+	ASSERT_GT(offset, (size_t)0);
+	ASSERT_NE(nullptr, strstr(pack_filename, "test.vp"));
+
+	// in the VP and the directory, the loose file takes precedence
+	ASSERT_EQ(1, cf_find_file_location("test2.tbl", CF_TYPE_ANY, sizeof(pack_filename) - 1, pack_filename, &size, &offset));
+	ASSERT_EQ((size_t)0, offset);
+
+	ASSERT_EQ(0, cf_find_file_location("test3.tbl", CF_TYPE_TABLES, sizeof(pack_filename) - 1, pack_filename, &size, &offset));
+	ASSERT_EQ(0, cf_find_file_location("test.tbl", CF_TYPE_MODELS, sizeof(pack_filename) - 1, pack_filename, &size, &offset));
+
+	const char* ext_list[] = { ".tbm", ".tbl" };
+	ASSERT_EQ(1, cf_find_file_location_ext("Test", 2, ext_list, CF_TYPE_ANY, sizeof(pack_filename) - 1, pack_filename, &size, &offset));
+	ASSERT_GT(offset, (size_t)0);
+	ASSERT_EQ(-1, cf_find_file_location_ext("test3", 2, ext_list, CF_TYPE_ANY));
+}
+
+class CFileMappedTest : public test::FSTestFixture {
+ public:
+	CFileMappedTest() : test::FSTestFixture(INIT_CFILE) {
+		pushModDir("cfile");
+		addCommandlineArg("-mmap_vps");
+	}
+
+ protected:
+	virtual void SetUp() override {
+		test::FSTestFixture::SetUp();
+	}
+	virtual void TearDown() override {
+		test::FSTestFixture::TearDown();
+
+		cfile_close();
+
+		Cmdline_mmap_vps = 0;
+	}
+};
+
+TEST_F(CFileMappedTest, read_mapped_pack_files) {
+	auto cf = cfopen("test2.tbl", "rb", CFILE_NORMAL, CF_TYPE_TABLES);
+	ASSERT_NE(nullptr, cf);
+
+	ASSERT_EQ(5, cfilelength(cf));
+
+	char buf[16] = {};
+	ASSERT_EQ(5, cfread(buf, 1, sizeof(buf), cf));
+	ASSERT_STREQ("asdf\n", buf);
+	ASSERT_TRUE(cfeof(cf) != 0);
+
+	ASSERT_EQ(0, cfseek(cf, 1, CF_SEEK_SET));
+	ASSERT_EQ(1, cftell(cf));
+	ASSERT_EQ('s', cfgetc(cf));
+
+	cfclose(cf);
+
+	// Files from mapped pack files don't need file handles so more than MAX_CFILE_BLOCKS files can be opened at once
+	SCP_vector<CFILE*> files;
+	for (int i = 0; i < 100; ++i) {
+		cf = cfopen("test.tbl", "rb", CFILE_NORMAL, CF_TYPE_TABLES);
+		ASSERT_NE(nullptr, cf);
+
+		files.push_back(cf);
+	}
+
+	for (auto file : files) {
+		ASSERT_EQ('a', cfgetc(file));
+		cfclose(file);
+	}
+}
+
+class CFilePackIndexCacheTest : public test::FSTestFixture {
+ public:
+	CFilePackIndexCacheTest() : test::FSTestFixture(INIT_NONE) {
+		pushModDir("cfile");
+	}
+
+ protected:
+	virtual void SetUp() override {
+		test::FSTestFixture::SetUp();
+
+		// The fixture disables the cache so that the other tests don't write into the test data
+		Cmdline_novpcache = false;
+	}
+	virtual void TearDown() override {
+		test::FSTestFixture::TearDown();
+
+		cfile_close();
+
+		Cmdline_novpcache = true;
+	}
+};
+
+TEST_F(CFilePackIndexCacheTest, save_and_load) {
+	SCP_string cfile_dir(TEST_DATA_PATH);
+	cfile_dir += DIR_SEPARATOR_CHAR;
+	cfile_dir += "test"; // Cfile expects something after the path
+
+	char pack_filename[MAX_PATH_LEN];
+	size_t size;
+	size_t offset;
+
+	// The first init reads the VPs and writes the cache
+	ASSERT_FALSE(cfile_init(cfile_dir.c_str()));
+
+	SCP_string cache_filename;
+	cf_create_default_path_string(cache_filename, CF_TYPE_CACHE, "vp_index.bin");
+
+	cfile_close();
+
+	auto fp = fopen(cache_filename.c_str(), "rb");
+	ASSERT_NE(nullptr, fp);
+	fclose(fp);
+
+	// The second one adds the files of the VPs from the cache
+	ASSERT_FALSE(cfile_init(cfile_dir.c_str()));
+
+	SCP_vector<SCP_string> table_files;
+	ASSERT_EQ(4, cf_get_file_list(table_files, CF_TYPE_TABLES, "*", CF_SORT_NAME));
+
+	ASSERT_EQ(1, cf_find_file_location("TEST.tbl", CF_TYPE_TABLES, sizeof(pack_filename) - 1, pack_filename, &size, &offset));
+	ASSERT_GT(offset, (size_t)0);
+	ASSERT_NE(nullptr, strstr(pack_filename, "test.vp"));
+
+	auto cf = cfopen("test2.tbl", "rb", CFILE_NORMAL, CF_TYPE_TABLES);
+	ASSERT_NE(nullptr, cf);
+	ASSERT_EQ(5, cfilelength(cf));
+	cfclose(cf);
+
+	cfile_close();
+
+	remove(cache_filename.c_str());
+}
@@ -0,0 +1,254 @@
+#include <gtest/gtest.h>
+
+#include "iff_defs/iff_defs.h"
+#include "globalincs/linklist.h"
+#include "object/object.h"
+#include "object/objectspatial.h"
+#include "ship/ship.h"
+#include "weapon/weapon.h"
+
+#include <random>
+
+// not exported by ship.h since only ship_create() and the save/restore code use them
+extern void ship_obj_list_init();
+extern int ship_obj_list_add(int objnum);
+
+namespace {
+
+const int NUM_TEAMS = 4;
+
+// a laser, a bomb and a countermeasure
+const int NUM_WEAPON_INFOS = 3;
+
+const int ALL_KINDS = SPATIAL_SHIPS | SPATIAL_ASTEROIDS | SPATIAL_WEAPONS_HITPOINTS | SPATIAL_CMEASURES;
+
+class ObjectSpatialTest : public ::testing::Test {
+ protected:
+	std::mt19937 _rng{ 11 };
+	int _next_signature = 1;
+
+	void SetUp() override {
+		obj_init();
+		ship_obj_list_init();
+
+		// ships without a model, the index then only uses the object radius
+		Ship_info.clear();
+		Ship_info.emplace_back();
+	}
+
+	void TearDown() override {
+		obj_spatial_reset();
+		ship_obj_list_init();
+
+		Ship_info.clear();
+		for (int i = 0; i < NUM_WEAPON_INFOS; ++i) {
+			Weapon_info[i].reset();
+		}
+	}
+
+	float random_float(float min, float max) {
+		return std::uniform_real_distribution<float>(min, max)(_rng);
+	}
+
+	vec3d random_pos(float extent) {
+		vec3d pos;
+		pos.xyz.x = random_float(-extent, extent);
+		pos.xyz.y = random_float(-extent, extent);
+		pos.xyz.z = random_float(-extent, extent);
+
+		return pos;
+	}
+
+	int add_ship(int objnum, const vec3d& pos, float radius, int team) {
+		object *objp = &Objects[objnum];
+
+		objp->type = OBJ_SHIP;
+		objp->instance = objnum;
+		objp->signature = _next_signature++;
+		objp->pos = pos;
+		objp->radius = radius;
+		objp->phys_info.max_vel.xyz.z = 100.0f;
+
+		Ships[objnum].clear();
+		Ships[objnum].objnum = objnum;
+		Ships[objnum].team = team;
+		Ships[objnum].ship_info_index = 0;
+		Ships[objnum].ship_list_index = ship_obj_list_add(objnum);
+
+		return objnum;
+	}
+
+	// Links an object of a random type into obj_used_list the way obj_merge_created_list() does
+	void add_object(int objnum) {
+		static const int types[] = { OBJ_SHIP, OBJ_ASTEROID, OBJ_WEAPON, OBJ_WEAPON, OBJ_WEAPON, OBJ_DEBRIS };
+		object *objp = &Objects[objnum];
+
+		objp->type = types[_rng() % 6];
+		objp->instance = objnum;
+		objp->signature = _next_signature++;
+
+		if (objp->type == OBJ_WEAPON) {
+			Weapons[objnum].weapon_info_index = (int)(_rng() % NUM_WEAPON_INFOS);
+		}
+
+		list_append(&obj_used_list, objp);
+		obj_spatial_add_object(objnum);
+	}
+
+	void delete_object(int objnum) {
+		list_remove(&obj_used_list, &Objects[objnum]);
+		Objects[objnum].type = OBJ_NONE;
+	}
+
+	void check_objects() {
+		SCP_vector<object*> result;
+
+		for (int kind_mask = 1; kind_mask <= ALL_KINDS; ++kind_mask) {
+			obj_spatial_get_objects(kind_mask, result);
+
+			// The way the weapon code used to walk the list
+			SCP_vector<object*> expected;
+			for (object *objp = GET_FIRST(&obj_used_list); objp != END_OF_LIST(&obj_used_list); objp = GET_NEXT(objp)) {
+				weapon_info *wip = (objp->type == OBJ_WEAPON) ? &Weapon_info[Weapons[objp->instance].weapon_info_index] : nullptr;
+
+				if (((kind_mask & SPATIAL_SHIPS) && (objp->type == OBJ_SHIP))
+					|| ((kind_mask & SPATIAL_ASTEROIDS) && (objp->type == OBJ_ASTEROID))
+					|| ((kind_mask & SPATIAL_WEAPONS_HITPOINTS) && wip && (wip->weapon_hitpoints > 0))
+					|| ((kind_mask & SPATIAL_CMEASURES) && wip && wip->wi_flags[Weapon::Info_Flags::Cmeasure])) {
+					expected.push_back(objp);
+				}
+			}
+
+			ASSERT_EQ(expected, result);
+		}
+	}
+
+	// Every ship the AI could find with a list walk and a vm_vec_dist_quick() check
+	SCP_vector<int> expected_ships(const vec3d *pos, float range, int team_mask) {
+		SCP_vector<int> objnums;
+
+		for (ship_obj *so = GET_FIRST(&Ship_obj_list); so != END_OF_LIST(&Ship_obj_list); so = GET_NEXT(so)) {
+			object *objp = &Objects[so->objnum];
+
+			if (!iff_matches_mask(Ships[objp->instance].team, team_mask)) {
+				continue;
+			}
+
+			if (vm_vec_dist_quick(pos, &objp->pos) - objp->radius < range) {
+				objnums.push_back(so->objnum);
+			}
+		}
+
+		return objnums;
+	}
+
+	void check_queries(int num_queries) {
+		SCP_vector<int> result;
+
+		for (int i = 0; i < num_queries; ++i) {
+			auto pos = random_pos(20000.0f);
+			auto range = random_float(100.0f, 8000.0f);
+			auto team_mask = (int)(_rng() % (1 << NUM_TEAMS));
+
+			obj_spatial_query_ships(&pos, range, team_mask, result);
+			auto expected = expected_ships(&pos, range, team_mask);
+
+			// Extra candidates are fine, they must be in list order though so only check the expected ones are there
+			size_t found = 0;
+			for (auto objnum : result) {
+				if (found < expected.size() && expected[found] == objnum) {
+					++found;
+				}
+			}
+			ASSERT_EQ(expected.size(), found);
+		}
+	}
+};
+
+}
+
+TEST_F(ObjectSpatialTest, query_matches_list_walk) {
+	for (int i = 0; i < 360; ++i) {
+		// mostly fighters with the occasional capital ship which is too large for the grid
+		float radius = (i % 50 == 0) ? random_float(2000.0f, 5000.0f) : random_float(5.0f, 300.0f);
+
+		add_ship(i, random_pos(20000.0f), radius, (int)(_rng() % NUM_TEAMS));
+	}
+
+	// Not built yet, every ship of a matching team is a candidate
+	check_queries(50);
+
+	obj_spatial_rebuild(0.1f);
+	check_queries(500);
+
+	// Ships may move up to their maximum speed after the rebuild and new ships may arrive
+	for (int i = 0; i < 360; ++i) {
+		vec3d dir = random_pos(1.0f);
+		vm_vec_normalize_safe(&dir);
+		vm_vec_scale_add2(&Objects[i].pos, &dir, 100.0f * 0.1f);
+	}
+	for (int i = 360; i < MAX_SHIPS; ++i) {
+		add_ship(i, random_pos(20000.0f), 50.0f, (int)(_rng() % NUM_TEAMS));
+	}
+	check_queries(500);
+}
+
+TEST_F(ObjectSpatialTest, find_nearest) {
+	for (int i = 0; i < 300; ++i) {
+		add_ship(i, random_pos(30000.0f), 20.0f, (int)(_rng() % NUM_TEAMS));
+	}
+
+	obj_spatial_rebuild(0.1f);
+
+	SCP_vector<int> result;
+	for (int i = 0; i < 100; ++i) {
+		auto pos = random_pos(30000.0f);
+		auto team_mask = 1 + (int)(_rng() % ((1 << NUM_TEAMS) - 1));
+		size_t count = 1 + _rng() % 10;
+
+		obj_spatial_find_nearest_ships(&pos, team_mask, count, result);
+
+		SCP_vector<std::pair<float, int>> expected;
+		for (int objnum = 0; objnum < 300; ++objnum) {
+			if (iff_matches_mask(Ships[objnum].team, team_mask)) {
+				expected.emplace_back(vm_vec_dist(&pos, &Objects[objnum].pos), objnum);
+			}
+		}
+		std::sort(expected.begin(), expected.end());
+
+		ASSERT_EQ(std::min(count, expected.size()), result.size());
+		for (size_t j = 0; j < result.size(); ++j) {
+			ASSERT_EQ(expected[j].second, result[j]);
+		}
+	}
+}
+
+TEST_F(ObjectSpatialTest, objects_match_list_walk) {
+	Weapon_info[1].weapon_hitpoints = 50;
+	Weapon_info[2].wi_flags.set(Weapon::Info_Flags::Cmeasure);
+
+	for (int i = 0; i < 1500; ++i) {
+		add_object(i);
+	}
+
+	// Not built yet, obj_used_list is walked
+	check_objects();
+
+	obj_spatial_rebuild(0.1f);
+	check_objects();
+
+	// Objects die and new ones are merged in during the frame, some of them in the slots of the dead ones
+	for (int i = 0; i < 1500; i += 3) {
+		delete_object(i);
+	}
+	for (int i = 0; i < 1500; i += 6) {
+		add_object(i);
+	}
+	for (int i = 1500; i < MAX_WEAPONS; ++i) {
+		add_object(i);
+	}
+	check_objects();
+
+	obj_spatial_rebuild(0.1f);
+	check_objects();
+}
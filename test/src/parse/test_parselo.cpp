@@ -1,7 +1,9 @@
 
 #include <gtest/gtest.h>
 
+#include <cmdline/cmdline.h>
 #include <parse/parselo.h>
+#include <utils/threading.h>
 
 #include "util/FSTestFixture.h"
 
@@ -52,6 +54,90 @@ TEST_F(ParseloTest, parse_pausing) {
 	required_string("#End");
 }
 
+TEST_F(ParseloTest, line_numbers) {
+	const char text[] = "#Start\n"
+	                    "; a comment\n"
+	                    "$Name: \"Alpha; 1\"\n"
+	                    "/* a comment\n"
+	                    "   spanning two lines */\n"
+	                    "$TOKEN: 5\n"
+	                    "\n"
+	                    "+Other: 6\n"
+	                    "#End\n";
+
+	read_file_text_from_default({ text, sizeof(text) - 1 });
+	reset_parse();
+
+	ASSERT_EQ(1, get_line_num());
+
+	required_string("#Start");
+	ASSERT_EQ(1, get_line_num());
+
+	ASSERT_TRUE(optional_string("$Name:"));
+	ASSERT_EQ(3, get_line_num());
+
+	// the semicolon in the quotes isn't a comment
+	advance_to_eoln(nullptr);
+	ASSERT_EQ(3, get_line_num());
+
+	required_string("$Token:");
+	ASSERT_EQ(6, get_line_num());
+
+	int value;
+	stuff_int(&value);
+	ASSERT_EQ(5, value);
+
+	ASSERT_FALSE(optional_string("$Token:"));
+	ASSERT_EQ(1, optional_string_either("$Token:", "+other:"));
+	ASSERT_EQ(8, get_line_num());
+
+	stuff_int(&value);
+	ASSERT_EQ(6, value);
+
+	required_string("#End");
+	ASSERT_EQ(9, get_line_num());
+}
+
+namespace {
+// What the callback of parse_modular_table() found, with the line numbers the tokens were on
+SCP_vector<SCP_string> parsed_tokens;
+
+void parse_test_table(const char* filename) {
+	read_file_text(filename, CF_TYPE_TABLES);
+	reset_parse();
+
+	required_string("#Start");
+
+	while (optional_string("$Token:")) {
+		SCP_string token;
+		stuff_string(token, F_NAME);
+
+		parsed_tokens.push_back(SCP_string(filename) + ":" + std::to_string(get_line_num()) + ":" + token);
+	}
+
+	required_string("#End");
+}
+}
+
+TEST_F(ParseloTest, modular_table_threads) {
+	parsed_tokens.clear();
+	ASSERT_EQ(3, parse_modular_table("*-tst.tbm", parse_test_table));
+
+	auto serial_tokens = parsed_tokens;
+	ASSERT_EQ(5, (int)serial_tokens.size());
+
+	threading::init(2);
+	Cmdline_parse_threads = 1;
+
+	parsed_tokens.clear();
+	ASSERT_EQ(3, parse_modular_table("*-tst.tbm", parse_test_table));
+
+	Cmdline_parse_threads = 0;
+	threading::shutdown();
+
+	ASSERT_EQ(serial_tokens, parsed_tokens);
+}
+
 TEST(ParseloUtilTest, drop_trailing_whitespace_cstr) {
 	char test_str[256];
 
@@ -0,0 +1,40 @@
+#include <gtest/gtest.h>
+
+#include <particle/particle.h>
+
+TEST(ParticleTest, handle_expiry) {
+	vec3d pos = vmd_zero_vector;
+	vec3d vel = vmd_x_vector;
+
+	auto short_lived = particle::create(&pos, &vel, 0.5f, 1.0f, particle::PARTICLE_DEBUG);
+	auto long_lived = particle::create(&pos, &vel, 10.0f, 1.0f, particle::PARTICLE_DEBUG);
+
+	ASSERT_TRUE(short_lived.isValid());
+	ASSERT_TRUE(long_lived.isValid());
+	ASSERT_FALSE(particle::ParticleHandle().isValid());
+
+	particle::move_all(0.25f);
+	particle::move_all(0.25f);
+
+	ASSERT_TRUE(short_lived.isValid());
+	ASSERT_FLOAT_EQ(0.5f, long_lived.pos().xyz.x);
+
+	particle::move_all(0.25f);
+
+	// The long lived particle was moved into the place of the removed one, its handle has to follow it
+	ASSERT_FALSE(short_lived.isValid());
+	ASSERT_TRUE(long_lived.isValid());
+	ASSERT_FLOAT_EQ(0.75f, long_lived.pos().xyz.x);
+	ASSERT_FLOAT_EQ(10.0f, long_lived.max_life());
+
+	// A new particle reuses the free slot but the old handle must not see it
+	auto reused = particle::create(&pos, &vel, 1.0f, 2.0f, particle::PARTICLE_DEBUG);
+	ASSERT_TRUE(reused.isValid());
+	ASSERT_FALSE(short_lived.isValid());
+	ASSERT_FLOAT_EQ(2.0f, reused.radius());
+
+	particle::kill_all();
+
+	ASSERT_FALSE(long_lived.isValid());
+	ASSERT_FALSE(reused.isValid());
+}
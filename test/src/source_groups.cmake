@@ -29,10 +29,18 @@ add_file_folder(menuui "menuui"
     menuui/test_intel_parse.cpp
 )
 
+add_file_folder(object "Object"
+    object/test_objectspatial.cpp
+)
+
 add_file_folder(graphics "Parse"
     parse/test_parselo.cpp
 )
 
+add_file_folder(particle "Particle"
+    particle/test_particle.cpp
+)
+
 add_file_folder(scripting "Scripting"
     scripting/ade_args.cpp
     scripting/ScriptingTestFixture.h
@@ -59,6 +67,9 @@ add_file_folder(scripting_api "Scripting\\\\Lua"
 add_file_folder(util "Util"
     util/FSTestFixture.cpp
     util/FSTestFixture.h
+    util/test_block_allocator.cpp
+    util/test_flat_hash_map.cpp
+    util/test_name_registry.cpp
     util/test_util.h
 )
 
@@ -14,6 +14,7 @@ test::FSTestFixture::FSTestFixture(uint64_t init_flags) : testing::Test(), _init
 	addCommandlineArg("-parse_cmdline_only");
 	addCommandlineArg("-standalone");
 	addCommandlineArg("-portable_mode");
+	addCommandlineArg("-novpcache");
 }
 void test::FSTestFixture::SetUp() {
 	auto currentTest = ::testing::UnitTest::GetInstance()->current_test_info();
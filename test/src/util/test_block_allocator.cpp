@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+
+#include <utils/block_allocator.h>
+
+#include <random>
+
+namespace {
+
+// The linear scans bmpman used before the allocator existed
+int scan_first(const SCP_vector<bool>& used, int count) {
+	int cnt = 0, start = 0;
+
+	for (int i = 0; i < (int)used.size(); ++i) {
+		if (!used[i]) {
+			if (cnt == 0) {
+				start = i;
+			}
+			++cnt;
+		} else {
+			cnt = 0;
+		}
+
+		if (cnt == count) {
+			return start;
+		}
+	}
+
+	return -1;
+}
+
+int scan_last(const SCP_vector<bool>& used) {
+	for (int i = (int)used.size() - 1; i >= 0; --i) {
+		if (!used[i]) {
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+}
+
+TEST(BlockAllocatorTest, allocate_release) {
+	block_allocator alloc(10);
+
+	ASSERT_EQ(10, alloc.largest_free_block());
+	ASSERT_EQ(0, alloc.allocate_first(3));
+	ASSERT_EQ(9, alloc.allocate_last());
+	ASSERT_EQ(3, alloc.allocate_first(1));
+	ASSERT_EQ(5, alloc.num_used());
+	ASSERT_EQ(5, alloc.largest_free_block());
+	ASSERT_EQ(-1, alloc.allocate_first(6));
+
+	alloc.release(0, 3);
+	ASSERT_EQ(2, alloc.count_free_blocks());
+	ASSERT_EQ(0, alloc.allocate_first(2));
+	ASSERT_EQ(4, alloc.allocate_first(3));
+	ASSERT_TRUE(alloc.is_used(6));
+	ASSERT_FALSE(alloc.is_used(7));
+}
+
+TEST(BlockAllocatorTest, matches_linear_scan) {
+	// Same size as bm_bitmaps so that the padding of the tree is exercised as well
+	const int size = 4750;
+
+	block_allocator alloc(size);
+	SCP_vector<bool> used(size, false);
+	SCP_vector<std::pair<int, int>> blocks;
+
+	std::mt19937 rng(7);
+
+	for (int iter = 0; iter < 20000; ++iter) {
+		auto op = rng() % 10;
+
+		if (op < 5) {
+			// Mostly single bitmaps with the occasional large animation
+			int count = (rng() % 8 == 0) ? 1 + (int)(rng() % 120) : 1;
+
+			auto expected = scan_first(used, count);
+			ASSERT_EQ(expected, alloc.allocate_first(count));
+
+			if (expected >= 0) {
+				for (int i = 0; i < count; ++i) {
+					used[expected + i] = true;
+				}
+				blocks.emplace_back(expected, count);
+			}
+		} else if (op < 6) {
+			auto expected = scan_last(used);
+			ASSERT_EQ(expected, alloc.allocate_last());
+
+			if (expected >= 0) {
+				used[expected] = true;
+				blocks.emplace_back(expected, 1);
+			}
+		} else if (!blocks.empty()) {
+			auto idx = rng() % blocks.size();
+			auto block = blocks[idx];
+
+			blocks[idx] = blocks.back();
+			blocks.pop_back();
+
+			alloc.release(block.first, block.second);
+			for (int i = 0; i < block.second; ++i) {
+				used[block.first + i] = false;
+			}
+		}
+	}
+
+	for (int i = 0; i < size; ++i) {
+		ASSERT_EQ(used[i], alloc.is_used(i));
+	}
+}
@@ -0,0 +1,183 @@
+#include <gtest/gtest.h>
+
+#include <object/objcollide.h>
+#include <utils/flat_hash_map.h>
+
+#include <random>
+
+namespace {
+
+// Mirrors the layout of the collider_pair entries in objcollide.cpp
+struct test_pair {
+	void* a = nullptr;
+	void* b = nullptr;
+	int signature_a = -1;
+	int signature_b = -1;
+	int next_check_time = -1;
+	bool initialized = false;
+};
+
+enum class pair_op {
+	Lookup, Evict
+};
+
+struct pair_event {
+	pair_op op;
+	uint key;
+};
+
+/**
+ * Builds a pair stream with the same shape as the one obj_collide_pair() produces during a large battle: a few hundred
+ * ships and a constantly replaced population of weapons, where every overlapping pair is looked up once per frame and
+ * pairs of deleted objects are evicted in batches.
+ */
+SCP_vector<pair_event> build_pair_stream(int frames) {
+	const int num_ships = 200;
+	const int num_weapons = 2500;
+	const int pairs_per_frame = 2000;
+
+	std::mt19937 rng(42);
+	SCP_vector<pair_event> stream;
+	SCP_vector<int> weapon_objnums;
+
+	for (int i = 0; i < num_weapons; ++i) {
+		weapon_objnums.push_back(num_ships + i);
+	}
+
+	for (int frame = 0; frame < frames; ++frame) {
+		// Replace a few percent of the weapons every frame
+		for (int i = 0; i < num_weapons / 30; ++i) {
+			auto idx = rng() % num_weapons;
+			weapon_objnums[idx] = num_ships + (int)(rng() % 3200);
+		}
+
+		for (int i = 0; i < pairs_per_frame; ++i) {
+			auto ship = (int)(rng() % num_ships);
+			auto weapon = weapon_objnums[rng() % num_weapons];
+
+			stream.push_back({ pair_op::Lookup, obj_collide_pair_key(ship, weapon) });
+		}
+
+		if (frame % 10 == 9) {
+			stream.push_back({ pair_op::Evict, 0 });
+		}
+	}
+
+	return stream;
+}
+
+bool is_stale(uint key, const test_pair& pair) {
+	// The stream reuses object slots, pretend that every slot with an odd weapon index is dead now
+	return !pair.initialized || ((key % MAX_OBJECTS) % 2 == 1);
+}
+
+}
+
+TEST(FlatHashMapTest, insert_find_erase) {
+	flat_hash_map<int> map;
+
+	ASSERT_TRUE(map.empty());
+	ASSERT_EQ(nullptr, map.find(5));
+
+	for (uint i = 0; i < 1000; ++i) {
+		map[i * 4096 + 7] = (int)i;
+	}
+	ASSERT_EQ((size_t)1000, map.size());
+
+	for (uint i = 0; i < 1000; ++i) {
+		auto val = map.find(i * 4096 + 7);
+		ASSERT_NE(nullptr, val);
+		ASSERT_EQ((int)i, *val);
+	}
+
+	for (uint i = 0; i < 1000; i += 2) {
+		ASSERT_TRUE(map.erase(i * 4096 + 7));
+	}
+	ASSERT_FALSE(map.erase(7));
+	ASSERT_EQ((size_t)500, map.size());
+
+	for (uint i = 0; i < 1000; ++i) {
+		auto val = map.find(i * 4096 + 7);
+		if (i % 2 == 0) {
+			ASSERT_EQ(nullptr, val);
+		} else {
+			ASSERT_NE(nullptr, val);
+			ASSERT_EQ((int)i, *val);
+		}
+	}
+
+	map.clear();
+	ASSERT_TRUE(map.empty());
+	ASSERT_EQ(nullptr, map.find(4096 + 7));
+}
+
+TEST(FlatHashMapTest, erase_if) {
+	flat_hash_map<int> map;
+	SCP_unordered_map<uint, int> reference;
+
+	std::mt19937 rng(1);
+	for (int i = 0; i < 5000; ++i) {
+		auto key = (uint)(rng() % 20000);
+		map[key] = i;
+		reference[key] = i;
+	}
+
+	auto removed = map.erase_if([](uint key, int&) { return key % 3 == 0; });
+
+	size_t expected_removed = 0;
+	for (auto iter = reference.begin(); iter != reference.end();) {
+		if (iter->first % 3 == 0) {
+			iter = reference.erase(iter);
+			++expected_removed;
+		} else {
+			++iter;
+		}
+	}
+
+	ASSERT_EQ(expected_removed, removed);
+	ASSERT_EQ(reference.size(), map.size());
+
+	size_t visited = 0;
+	map.for_each([&](uint key, int& value) {
+		ASSERT_EQ(reference.at(key), value);
+		++visited;
+	});
+	ASSERT_EQ(reference.size(), visited);
+}
+
+TEST(FlatHashMapTest, replay_collision_pairs) {
+	auto stream = build_pair_stream(30);
+
+	SCP_unordered_map<uint, test_pair> node_map;
+	flat_hash_map<test_pair> flat_map;
+
+	for (auto& evt : stream) {
+		if (evt.op == pair_op::Lookup) {
+			auto& node_pair = node_map[evt.key];
+			node_pair.initialized = true;
+			++node_pair.next_check_time;
+
+			auto& flat_pair = flat_map[evt.key];
+			flat_pair.initialized = true;
+			++flat_pair.next_check_time;
+		} else {
+			for (auto iter = node_map.begin(); iter != node_map.end();) {
+				if (is_stale(iter->first, iter->second)) {
+					iter = node_map.erase(iter);
+				} else {
+					++iter;
+				}
+			}
+
+			flat_map.erase_if(is_stale);
+		}
+	}
+
+	// Both containers must end up with the same contents
+	ASSERT_EQ(node_map.size(), flat_map.size());
+	flat_map.for_each([&](uint key, test_pair& pair) {
+		auto iter = node_map.find(key);
+		ASSERT_NE(node_map.end(), iter);
+		ASSERT_EQ(iter->second.next_check_time, pair.next_check_time);
+	});
+}
@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+
+#include <globalincs/globals.h>
+#include <utils/name_registry.h>
+
+#include <algorithm>
+#include <random>
+
+namespace {
+
+const int NUM_SHIPS = 2000;
+
+// A stand in for Ships[], the registry only ever sees indices so it doesn't care what the entries are
+struct test_ship {
+	char name[NAME_LENGTH];
+	bool in_mission;
+};
+
+class NameRegistryTest : public ::testing::Test {
+ protected:
+	SCP_vector<test_ship> _ships = SCP_vector<test_ship>(NUM_SHIPS);
+	name_registry _registry;
+	std::mt19937 _rng{ 5 };
+
+	void set_name(int index, const char* name) {
+		if (_ships[index].in_mission) {
+			_registry.remove(_ships[index].name, index);
+		}
+
+		strcpy_s(_ships[index].name, name);
+
+		if (_ships[index].in_mission) {
+			_registry.add(_ships[index].name, index);
+		}
+	}
+
+	void set_in_mission(int index, bool in_mission) {
+		if (_ships[index].in_mission == in_mission) {
+			return;
+		}
+
+		if (in_mission) {
+			_registry.add(_ships[index].name, index);
+		} else {
+			_registry.remove(_ships[index].name, index);
+		}
+		_ships[index].in_mission = in_mission;
+	}
+
+	// The way ship_name_lookup() used to do it
+	int linear_lookup(const char* name) const {
+		for (int i = 0; i < NUM_SHIPS; ++i) {
+			if (_ships[i].in_mission && !stricmp(name, _ships[i].name)) {
+				return i;
+			}
+		}
+
+		return -1;
+	}
+
+	int registry_lookup(const char* name) const {
+		return _registry.find(name, [this, name](int i) {
+			return _ships[i].in_mission && !stricmp(name, _ships[i].name);
+		});
+	}
+
+	// Wing style names, so plenty of them share long prefixes
+	SCP_string random_name() {
+		static const char* wings[] = { "Alpha", "Beta", "Gamma", "Delta", "Epsilon", "Zeta", "Eta", "Theta" };
+		char buf[NAME_LENGTH];
+
+		sprintf(buf, "GTF %s %d", wings[_rng() % 8], (int)(_rng() % 400));
+		return buf;
+	}
+};
+
+}
+
+TEST_F(NameRegistryTest, matches_linear_scan) {
+	for (int i = 0; i < NUM_SHIPS; ++i) {
+		set_name(i, random_name().c_str());
+		set_in_mission(i, _rng() % 4 != 0);
+	}
+
+	for (int iter = 0; iter < 20000; ++iter) {
+		auto index = (int)(_rng() % NUM_SHIPS);
+
+		switch (_rng() % 4) {
+			case 0:
+				set_name(index, random_name().c_str());
+				break;
+			case 1:
+				set_in_mission(index, !_ships[index].in_mission);
+				break;
+			default: {
+				// Duplicate names are allowed, the first one in the array has to be found. Look up names with a
+				// different case as well.
+				auto name = random_name();
+				if (_rng() % 2 == 0) {
+					std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+				}
+				ASSERT_EQ(linear_lookup(name.c_str()), registry_lookup(name.c_str()));
+				break;
+			}
+		}
+	}
+}
+
+TEST_F(NameRegistryTest, find_in_table) {
+	SCP_vector<SCP_string> table;
+	auto name_of = [&table](int i) { return table[i].c_str(); };
+
+	table.emplace_back("GTF Ulysses");
+	table.emplace_back("GTB Ursa");
+	ASSERT_EQ(1, _registry.find_in_table("gtb ursa", (int)table.size(), name_of));
+
+	// Appended entries are picked up
+	table.emplace_back("GTC Fenris");
+	ASSERT_EQ(2, _registry.find_in_table("GTC Fenris", (int)table.size(), name_of));
+
+	// Reordered entries make the index rebuild itself
+	std::reverse(table.begin(), table.end());
+	ASSERT_EQ(0, _registry.find_in_table("GTC Fenris", (int)table.size(), name_of));
+	ASSERT_EQ(2, _registry.find_in_table("GTF Ulysses", (int)table.size(), name_of));
+
+	// As do removed ones
+	table.pop_back();
+	ASSERT_EQ(-1, _registry.find_in_table("GTF Ulysses", (int)table.size(), name_of));
+	ASSERT_EQ(1, _registry.find_in_table("GTB Ursa", (int)table.size(), name_of,
+	                                     [&table](int i) { return i > 0; }));
+}